@@ -1,5 +1,8 @@
 #pragma once
 
+#include "game/songclock.h"
+#include "game/stemmixer.h"
+#include <atomic>
 #include <vector>
 #include <filesystem>
 #include <unordered_map>
@@ -20,28 +23,42 @@ public:
 		unsigned int handle = 0;
 		int instrument = 0;
 	};
-	std::vector<AudioStream> loadedStreams; // Loaded audio streams
+	std::vector<AudioStream> loadedStreams; // Loaded audio streams, in the mixer's order
+	StemMixer mixer; // Plays the loaded streams together
 
-	// Initialize the audio manager
-	bool Init();
+	// Initialize the audio manager. Low latency shrinks BASS's buffers to
+	// about bufferMS, at more risk of the output running dry
+	bool Init(bool lowLatency = false, int bufferMS = 40);
 
-	// Load and manage audio streams
-	void loadStreams(std::vector<std::pair<std::string, int>>& paths);
+	// Output latency BASS measured at Init, in seconds
+	double outputLatency = 0;
+	// Times the loaded streams ran dry since they were loaded
+	std::atomic<int> underruns = 0;
+
+	// Load and manage audio streams; with stemCache they're also decoded
+	// into the StemCache, to play from once ready
+	void loadStreams(std::vector<std::pair<std::string, int>>& paths, bool stemCache = false);
 	void unloadStreams();
 	void pauseStreams();
 	void playStreams();
 	void restartStreams();
 
-	// Audio stream information
-	double GetMusicTimePlayed(unsigned int handle);
-	double GetMusicTimeLength(unsigned int handle);
+	// Audio stream information, for the loaded streams as a whole
+	double GetMusicTimePlayed();
+	double GetMusicTimeLength();
+
+	// Smoothed play time of the loaded streams, for judging and drawing
+	SongClock songClock;
+	// Samples the mix into songClock when it's due; call once a frame
+	void UpdateSongClock();
 
 	// Audio stream control
 	void UpdateMusicStream(unsigned int handle);
     void unpauseStreams();
+	// Ramps a loaded stream to volume over a few milliseconds
 	void SetAudioStreamVolume(unsigned int handle, float volume);
-	void BeginPlayback(unsigned int handle);
-	void StopPlayback(unsigned int handle);
+	void BeginPlayback();
+	void StopPlayback();
 
 	// Load and play samples
 	void loadSample(const std::string& path, const std::string& name);
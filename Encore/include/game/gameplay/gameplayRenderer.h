@@ -9,9 +9,9 @@
 class gameplayRenderer {
     void RenderNotes(Player& player, Chart& curChart, double time, RenderTexture2D& notes_tex, float length);
     void RenderHud(Player& player, RenderTexture2D&, float);
-    void RenderExpertHighway(Player& player, Song song, double time, RenderTexture2D& highway_tex, RenderTexture2D& highwayStatus_tex, RenderTexture2D& smasher_tex);
-    void RenderEmhHighway(Player& player, Song song, double time, RenderTexture2D& highway_tex);
-    void DrawBeatlines(Player& player, Song song, float length, double musicTime);
+    void RenderExpertHighway(Player& player, SongSession& song, double time, RenderTexture2D& highway_tex, RenderTexture2D& highwayStatus_tex, RenderTexture2D& smasher_tex);
+    void RenderEmhHighway(Player& player, SongSession& song, double time, RenderTexture2D& highway_tex);
+    void DrawBeatlines(Player& player, SongSession& song, float length, double musicTime);
     void DrawOverdrive(Player& player, Chart& curChart, float length, double musicTime);
     void DrawSolo(Player& player,  Chart& curChart, float length, double musicTime);
     void RenderClassicNotes(Player& player, Chart& curChart, double time, RenderTexture2D &notes_tex, float length);
@@ -37,8 +37,6 @@ public:
     bool showHitwindow = false;
     int curBPM = 0;
     int curBeatLine = 0;
-    int curODPhrase = 0;
-    int curSolo = 0;
     int curNoteInt = 0;
     bool songOver = false;
 	bool extendedSustainActive = false;
@@ -59,7 +57,7 @@ public:
 	 */
 	std::vector<Camera3D> camera3pVector;
 
-    void RenderGameplay(Player& player, double time, Song song, RenderTexture2D&, RenderTexture2D&, RenderTexture2D&, RenderTexture2D&, RenderTexture2D&);
+    void RenderGameplay(Player& player, double time, SongSession& song, RenderTexture2D&, RenderTexture2D&, RenderTexture2D&, RenderTexture2D&, RenderTexture2D&);
 
     bool upStrum = false;
     bool downStrum = false;
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "game/songclock.h"
+#include "game/spscqueue.h"
+#include <atomic>
+#include <chrono>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Reads the keyboards and gamepads on a thread of their own, straight from
+// the devices, so presses are timed to when they happened rather than to
+// the frame that polled them. Events are stamped on steady_clock, which
+// SongClock::At turns into song time. Only Linux, through evdev, for now;
+// elsewhere, or when nothing can be opened, Start returns false and input
+// stays with GLFW's callbacks.
+class InputThread {
+public:
+    // laid out like GLFW's gamepad state, buttons and axes in the same order
+    struct GamepadState {
+        unsigned char buttons[15] = {};
+        float axes[6] = {};
+    };
+
+    struct Event {
+        enum Type {
+            Key,
+            Gamepad
+        };
+        Type type = Key;
+        // X11's keycode for the key, which is what GLFW reports as the
+        // scancode
+        int scancode = 0;
+        // GLFW_PRESS or GLFW_RELEASE; repeats are left out
+        int action = 0;
+        // for a gamepad, its whole state once the change was made
+        GamepadState gamepad;
+        SongClock::Clock::time_point time;
+    };
+
+    static InputThread& getInstance() {
+        static InputThread instance;
+        return instance;
+    }
+
+    ~InputThread() { Stop(); }
+
+    // throws away anything still queued from before
+    bool Start();
+    void Stop();
+    bool IsRunning() const { return running; }
+
+    // from one thread only; never blocks
+    bool Pop(Event& event) { return events.Pop(event); }
+    // events lost because the queue was full
+    int Dropped() const { return dropped; }
+    // whether the thread reads the gamepad GLFW gives this GUID, so GLFW's
+    // state for it should be ignored
+    bool OwnsGamepad(const char* guid) const { return running && guid && gamepadGuids.count(guid); }
+
+private:
+    InputThread() = default;
+
+    // how often the thread wakes to check whether it should stop, at most;
+    // events wake it straight away
+    static constexpr std::chrono::milliseconds pollInterval{ 1 };
+
+    struct Device {
+        int fd = -1;
+        bool gamepad = false;
+        GamepadState state;
+        // whether state has changed since it was last queued
+        bool changed = false;
+        // the range each axis reports over
+        int axisMin[6] = {};
+        int axisMax[6] = {};
+    };
+
+    std::thread thread;
+    std::atomic<bool> running = false;
+    SpscQueue<Event, 1024> events;
+    std::atomic<int> dropped = 0;
+    std::vector<Device> devices;
+    // set before the thread starts, and read only while it runs
+    std::set<std::string> gamepadGuids;
+
+    void run();
+    // applies one of a pad's events to its state
+    void updateGamepad(Device& device, int type, int code, int value);
+    // the pad's whole state, as it is now
+    void readGamepad(Device& device);
+};
@@ -41,8 +41,8 @@ private:
         ss << std::fixed << value;
         return ss.str();
     }
-    void renderPlayerResults(Player player, Song song);
-    void renderStars(Player player, float xPos, float yPos, float scale, bool left);
+    void renderPlayerResults(Player& player, const SongSession& song);
+    void renderStars(Player& player, float xPos, float yPos, float scale, bool left);
 public:
 
     void DrawTopOvershell(float TopOvershell);
@@ -55,7 +55,7 @@ public:
     }
     void DrawFPS(int posX, int posY);
     bool hehe = false;
-    Song ChosenSong;
+    SongSession ChosenSong;
     int ChosenSongInt;
     Screens currentScreen;
     bool songsLoaded{};
@@ -24,7 +24,8 @@ public:
     int persistentDiff = 0;
     bool firstReadyUp = true;
 
-    Song songToBeJudged;
+    // the song being played; owned by whoever started it
+    SongSession* songToBeJudged = nullptr;
 
     int notesHit = 0;
     int notesMissed = 0;
@@ -182,14 +183,14 @@ public:
 		perfectHit += perfect ? 1 : 0;
         mute = false;
 	}
-    void HitPlasticNote(Note note, int inst) {
+    void HitPlasticNote(bool perfect, int chordSize, int inst) {
         notesHit += 1;
         combo += 1;
         if (combo > maxCombo)
             maxCombo = combo;
-        float perfectMult = note.perfect ? 1.2f : 1.0f;
-        score += (note.chordSize * (int)((30.0f * (multiplier(inst)) * perfectMult)));
-        perfectHit += note.perfect ? 1 : 0;
+        float perfectMult = perfect ? 1.2f : 1.0f;
+        score += (chordSize * (int)((30.0f * (multiplier(inst)) * perfectMult)));
+        perfectHit += perfect ? 1 : 0;
         mute = false;
     }
 	void MissNote() {
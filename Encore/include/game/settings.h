@@ -83,6 +83,14 @@ private:
 			settings["controllerbinds"].AddMember("pause_direction", rapidjson::Value(), allocator);
         if (!settings.HasMember("songDirectories"))
             settings.AddMember("songDirectories", rapidjson::Value(), allocator);
+		if (!settings.HasMember("lowLatencyAudio"))
+			settings.AddMember("lowLatencyAudio", rapidjson::Value(), allocator);
+		if (!settings.HasMember("audioBuffer"))
+			settings.AddMember("audioBuffer", rapidjson::Value(), allocator);
+		if (!settings.HasMember("stemCache"))
+			settings.AddMember("stemCache", rapidjson::Value(), allocator);
+		if (!settings.HasMember("stemCacheSize"))
+			settings.AddMember("stemCacheSize", rapidjson::Value(), allocator);
 	}
     std::filesystem::path executablePath = GetApplicationDirectory();
     std::filesystem::path directory = executablePath.parent_path();
@@ -174,6 +182,22 @@ public:
     bool fullscreenDefault = true;
     bool fullscreen = fullscreenDefault;
     bool fullscreenPrev = fullscreen;
+	// smaller audio buffers, applied on the next start; audioBufferMS trades
+	// latency against the output running dry
+	bool defaultLowLatencyAudio = false;
+	bool lowLatencyAudio = defaultLowLatencyAudio;
+	bool prevLowLatencyAudio = lowLatencyAudio;
+	int defaultAudioBufferMS = 40;
+	int audioBufferMS = defaultAudioBufferMS;
+	int prevAudioBufferMS = audioBufferMS;
+	// keep songs' stems decoded on disk, up to stemCacheMB, so restarts and
+	// seeks don't go through the decoders
+	bool defaultStemCache = false;
+	bool stemCache = defaultStemCache;
+	bool prevStemCache = stemCache;
+	int defaultStemCacheMB = 2048;
+	int stemCacheMB = defaultStemCacheMB;
+	int prevStemCacheMB = stemCacheMB;
 
 	float defaultMainVolume = 0.5f;
 	float defaultPlayerVolume = 0.75f;
@@ -280,6 +304,10 @@ public:
 		settings.AddMember("inputOffset", rapidjson::Value(inputOffsetMS), allocator);
         settings.AddMember("fullscreen", rapidjson::Value(fullscreenDefault), allocator);
 		settings.AddMember("mirror", rapidjson::Value(defaultMirrorMode), allocator);
+		settings.AddMember("lowLatencyAudio", rapidjson::Value(defaultLowLatencyAudio), allocator);
+		settings.AddMember("audioBuffer", rapidjson::Value(defaultAudioBufferMS), allocator);
+		settings.AddMember("stemCache", rapidjson::Value(defaultStemCache), allocator);
+		settings.AddMember("stemCacheSize", rapidjson::Value(defaultStemCacheMB), allocator);
 		settings.AddMember("trackSpeed", rapidjson::Value(4), allocator);
         settings.AddMember("length", rapidjson::Value(1.0f), allocator);
 		rapidjson::Value arrayTrackSpeedOptions(rapidjson::kArrayType);
@@ -327,6 +355,10 @@ public:
 		bool trackSpeedError = false;
         bool MissHighwayError = false;
         bool fullscreenError = false;
+		bool lowLatencyAudioError = false;
+		bool audioBufferError = false;
+		bool stemCacheError = false;
+		bool stemCacheSizeError = false;
 
 		bool VolumeError = false;
 		bool MainVolumeError = false;
@@ -670,6 +702,34 @@ public:
                 } else {
                     fullscreenError = true;
                 }
+				if (settings.HasMember("lowLatencyAudio") && settings["lowLatencyAudio"].IsBool()) {
+					lowLatencyAudio = settings["lowLatencyAudio"].GetBool();
+					prevLowLatencyAudio = lowLatencyAudio;
+				}
+				else {
+					lowLatencyAudioError = true;
+				}
+				if (settings.HasMember("audioBuffer") && settings["audioBuffer"].IsInt()) {
+					audioBufferMS = settings["audioBuffer"].GetInt();
+					prevAudioBufferMS = audioBufferMS;
+				}
+				else {
+					audioBufferError = true;
+				}
+				if (settings.HasMember("stemCache") && settings["stemCache"].IsBool()) {
+					stemCache = settings["stemCache"].GetBool();
+					prevStemCache = stemCache;
+				}
+				else {
+					stemCacheError = true;
+				}
+				if (settings.HasMember("stemCacheSize") && settings["stemCacheSize"].IsInt()) {
+					stemCacheMB = settings["stemCacheSize"].GetInt();
+					prevStemCacheMB = stemCacheMB;
+				}
+				else {
+					stemCacheSizeError = true;
+				}
                 if (settings.HasMember("songDirectories") && settings["songDirectories"].IsArray()){
                         for (auto& songPath : settings["songDirectories"].GetArray()) {
 							if(songPath.GetString()!=defaultSongPaths[0])
@@ -948,7 +1008,27 @@ public:
             fullscreenVal.SetBool(fullscreenDefault);
             settings.AddMember("fullscreen", fullscreenVal, allocator);
         }
-		if ( MenuVolumeError || MissVolumeError || keybindsStrumDownError || keybindsStrumUpError || SFXVolumeError || BandVolumeError || PlayerVolumeError || VolumeError || MainVolumeError || fullscreenError || songDirectoryError || highwayLengthError || mirrorError || MissHighwayError || keybindsError || keybinds4KError || keybinds5KError || keybinds4KAltError || keybinds5KAltError|| keybindsOverdriveError || keybindsOverdriveAltError || keybindsPauseError || controllerError || controllerTypeError || controller4KError || controller5KError || controllerOverdriveError || controller4KDirectionError || controller5KDirectionError || controllerOverdriveDirectionError || controllerPauseError || controllerPauseDirectionError || avError || inputError|| trackSpeedError || trackSpeedOptionsError) {
+		if (lowLatencyAudioError) {
+			if (settings.HasMember("lowLatencyAudio"))
+				settings.EraseMember("lowLatencyAudio");
+			settings.AddMember("lowLatencyAudio", rapidjson::Value(defaultLowLatencyAudio), allocator);
+		}
+		if (audioBufferError) {
+			if (settings.HasMember("audioBuffer"))
+				settings.EraseMember("audioBuffer");
+			settings.AddMember("audioBuffer", rapidjson::Value(defaultAudioBufferMS), allocator);
+		}
+		if (stemCacheError) {
+			if (settings.HasMember("stemCache"))
+				settings.EraseMember("stemCache");
+			settings.AddMember("stemCache", rapidjson::Value(defaultStemCache), allocator);
+		}
+		if (stemCacheSizeError) {
+			if (settings.HasMember("stemCacheSize"))
+				settings.EraseMember("stemCacheSize");
+			settings.AddMember("stemCacheSize", rapidjson::Value(defaultStemCacheMB), allocator);
+		}
+		if ( MenuVolumeError || MissVolumeError || keybindsStrumDownError || keybindsStrumUpError || SFXVolumeError || BandVolumeError || PlayerVolumeError || VolumeError || MainVolumeError || fullscreenError || songDirectoryError || highwayLengthError || mirrorError || MissHighwayError || keybindsError || keybinds4KError || keybinds5KError || keybinds4KAltError || keybinds5KAltError|| keybindsOverdriveError || keybindsOverdriveAltError || keybindsPauseError || controllerError || controllerTypeError || controller4KError || controller5KError || controllerOverdriveError || controller4KDirectionError || controller5KDirectionError || controllerOverdriveDirectionError || controllerPauseError || controllerPauseDirectionError || avError || inputError|| trackSpeedError || trackSpeedOptionsError || lowLatencyAudioError || audioBufferError || stemCacheError || stemCacheSizeError) {
 			ensureValuesExist();
 			saveSettings(settingsFile);
 		}
@@ -1070,6 +1150,14 @@ public:
         missHighwayColorMember->value.SetBool(missHighwayDefault);
 		rapidjson::Value::MemberIterator mirrorMember = settings.FindMember("mirror");
 		mirrorMember->value.SetBool(mirrorMode);
+		rapidjson::Value::MemberIterator lowLatencyAudioMember = settings.FindMember("lowLatencyAudio");
+		lowLatencyAudioMember->value.SetBool(lowLatencyAudio);
+		rapidjson::Value::MemberIterator audioBufferMember = settings.FindMember("audioBuffer");
+		audioBufferMember->value.SetInt(audioBufferMS);
+		rapidjson::Value::MemberIterator stemCacheMember = settings.FindMember("stemCache");
+		stemCacheMember->value.SetBool(stemCache);
+		rapidjson::Value::MemberIterator stemCacheSizeMember = settings.FindMember("stemCacheSize");
+		stemCacheSizeMember->value.SetInt(stemCacheMB);
         rapidjson::Value::MemberIterator songDirMember = settings.FindMember("songDirectories");
 		songDirMember->value.Clear();
 		for (std::filesystem::path& path : songPaths)
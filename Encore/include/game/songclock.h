@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+
+// Where the song is, as a smooth line against steady_clock rather than the
+// audio position itself, which only moves each time BASS updates the output.
+// The audio position is sampled every so often and the line is steered
+// towards it by speeding up or slowing down slightly, so it never jumps
+// unless it ends up too far off, like after a stall. Readings are never
+// ahead of the audio, so it's steered towards the latest of the recent ones.
+// Times are in seconds of song, less the output latency, so they match what
+// is being heard. At can be called from any thread.
+class SongClock {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats {
+        int samples = 0;
+        // samples so far off the clock was set to them rather than steered
+        int snaps = 0;
+        // how far the audio position readings were from the clock
+        double sampleErrorRms = 0;
+        double sampleErrorMax = 0;
+        // how far each frame's step of the clock was from the real time
+        // that went by
+        int frames = 0;
+        double frameErrorRms = 0;
+        double frameErrorMax = 0;
+    };
+
+    // song time at t, or at the moment
+    double At(Clock::time_point t) const;
+    double Now() const { return At(Clock::now()); }
+
+    // puts the clock at position, for starts, seeks and pauses
+    void Set(double position, bool running);
+    bool Running() const;
+
+    // call once a frame; true when it's time for another Sample
+    bool Update(Clock::time_point t);
+    // a reading of the audio position, taken at t
+    void Sample(double position, Clock::time_point t);
+
+    void SetOutputLatency(double seconds);
+
+    Stats GetStats() const;
+    void ResetStats();
+
+private:
+    static constexpr Clock::duration sampleInterval = std::chrono::milliseconds(20);
+    static constexpr int windowSize = 16;
+    // off by more than this and the clock is set rather than steered
+    static constexpr double snapError = 0.05;
+    // how long steering takes to take out an error, and the most it can
+    // speed up or slow down
+    static constexpr double steerTime = 0.5;
+    static constexpr double maxSteer = 0.01;
+
+    mutable std::mutex mutex;
+    Clock::time_point anchorTime;
+    double anchorPosition = 0;
+    double rate = 1;
+    bool running = false;
+    double latency = 0;
+
+    // recent readings, as audio position less steady_clock seconds
+    double offsets[windowSize];
+    int offsetCount = 0;
+    int nextOffset = 0;
+    Clock::time_point lastSample;
+
+    Clock::time_point lastFrame;
+    double lastFrameTime = 0;
+    bool haveFrame = false;
+    Stats stats;
+    double sampleErrorSquares = 0;
+    double frameErrorSquares = 0;
+
+    double positionAt(Clock::time_point t) const;
+    void anchor(double position, Clock::time_point t, double newRate);
+};
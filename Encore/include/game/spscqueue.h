@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// A fixed size queue for handing things from one thread to another without
+// locking: exactly one thread pushes, and exactly one other thread pops.
+// Push fails rather than waiting when it's full.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    bool Push(const T& item) {
+        size_t back = tail.load(std::memory_order_relaxed);
+        if (back - head.load(std::memory_order_acquire) == Capacity)
+            return false;
+        items[back & (Capacity - 1)] = item;
+        tail.store(back + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool Pop(T& item) {
+        size_t front = head.load(std::memory_order_relaxed);
+        if (front == tail.load(std::memory_order_acquire))
+            return false;
+        item = items[front & (Capacity - 1)];
+        head.store(front + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool Empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+private:
+    // on separate cache lines, so the two threads don't fight over one
+    alignas(64) std::atomic<size_t> head = 0;
+    alignas(64) std::atomic<size_t> tail = 0;
+    T items[Capacity];
+};
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "song/mappedfile.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// A stem decoded to interleaved 16-bit samples and mapped from the cache.
+// Nothing but ready and failed can be read until ready is set.
+struct CachedStem {
+    std::atomic<bool> ready = false;
+    // it couldn't be decoded or cached, and won't become ready
+    std::atomic<bool> failed = false;
+    unsigned int freq = 0;
+    int channels = 0;
+    uint64_t frames = 0;
+    const int16_t* samples = nullptr;
+
+    std::string path;
+    // of the stem file's contents, which names the cache file
+    std::string hash;
+    MappedFile file;
+};
+
+// Decodes stems on worker threads into files of raw samples, named by a hash
+// of the stem file, so they can be mapped and played with sample-exact seeks
+// instead of seeking the compressed streams. The least recently used files
+// are removed to keep the directory under its size budget.
+class StemCache {
+public:
+    static StemCache& getInstance() {
+        static StemCache instance;
+        return instance;
+    }
+
+    ~StemCache() { Stop(); }
+
+    // evicts straight away if the budget shrank
+    void Configure(const std::filesystem::path& directory, uint64_t budgetBytes);
+    // the cached stem for path, which becomes ready in the background if it
+    // isn't already cached. Stems asked for again while still held are
+    // shared, and their files aren't evicted
+    std::shared_ptr<const CachedStem> Request(const std::string& path);
+    void Stop();
+
+private:
+    StemCache() = default;
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t freq;
+        uint32_t channels;
+        uint64_t frames;
+    };
+    static constexpr uint32_t version = 1;
+    static constexpr int maxWorkers = 4;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::shared_ptr<CachedStem>> jobs;
+    std::vector<std::thread> workers;
+    std::atomic<bool> stopping = false;
+    // nothing is cached until there's a budget
+    std::filesystem::path directory;
+    uint64_t budget = 0;
+    // stem path to the stem handed out for it
+    std::map<std::string, std::weak_ptr<CachedStem>> live;
+    // hashes of the files being decoded right now, and a signal for when
+    // one of them is done
+    std::set<std::string> decoding;
+    std::condition_variable decoded;
+    // makes each write's partial file name its own
+    std::atomic<uint64_t> parts = 0;
+
+    void work();
+    // maps the stem's cache file, decoding it first if it isn't there
+    bool fill(CachedStem& stem);
+    // decodes path into file through a partial file
+    bool write(const std::string& path, const std::filesystem::path& file, uint64_t budget);
+    bool decode(const std::string& path, const std::filesystem::path& to, uint64_t budget);
+    bool open(CachedStem& stem, const std::filesystem::path& from);
+    // removes the oldest files until the rest fit the budget, keeping keep
+    // and anything still held
+    void evict(const std::filesystem::path& keep);
+};
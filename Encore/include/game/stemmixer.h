@@ -0,0 +1,102 @@
+#pragma once
+
+#include "game/spscqueue.h"
+#include "game/stemcache.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Plays a song's stems as one BASS stream. Each stem is decoded to floats
+// on its own, and BASS's update thread asks the mixer for the sum, so every
+// stem moves in step with the others and with the one position. Gains are
+// set from the game thread through a queue and ramped in over a few
+// milliseconds, so muting a stem doesn't click. With the stem cache, each
+// stem moves over to its decoded copy once that's ready, and seeks in it are
+// exact and cost nothing. Stems needn't agree on format: the mix has as
+// many channels as the widest stem, narrower ones are spread across them,
+// and stems at other rates are resampled to the rate most of them share.
+class StemMixer {
+public:
+    StemMixer() = default;
+    StemMixer(const StemMixer&) = delete;
+    StemMixer& operator=(const StemMixer&) = delete;
+    ~StemMixer() { Unload(); }
+
+    // opens the stems and the output stream, stopped at the start. Stems
+    // that can't be opened are left out; the indexes of the ones kept are
+    // returned in order
+    std::vector<int> Load(const std::vector<std::string>& paths, bool useCache = false);
+    void Unload();
+
+    // the stream to play, pause and stop; 0 if nothing is loaded
+    unsigned int Output() const { return output; }
+    int StemCount() const { return (int)stems.size(); }
+    // a stem's decoding stream, which only the mixer should read from
+    unsigned int StemHandle(int stem) const { return stems[stem].decoder; }
+
+    // from the game thread; only changes are queued, so it's fine to call
+    // every frame
+    void SetGain(int stem, float gain);
+
+    // only while the output isn't playing
+    void Seek(double seconds);
+    // where playback is, in seconds from the start of the stems
+    double Position() const;
+    // the length of the longest stem
+    double Length() const;
+
+    // fills out with the next size bytes of the mix; the output stream
+    // calls this from BASS's update thread
+    unsigned int Mix(float* out, unsigned int size);
+
+private:
+    struct Stem {
+        unsigned int decoder = 0;
+        unsigned int freq = 0;
+        int channels = 0;
+        float gain = 0;
+        float target = 0;
+        float step = 0;
+        int rampLeft = 0;
+        bool ended = false;
+        // how far into the stem has been read, in its own frames
+        uint64_t frame = 0;
+        // for a stem at another rate, what's been read but not yet
+        // resampled, and where the next output frame falls in it
+        std::vector<float> held;
+        double heldPosition = 0;
+        // read from instead of the decoder once it's ready
+        std::shared_ptr<const CachedStem> cached;
+        bool fromCache = false;
+    };
+    struct GainChange {
+        int stem;
+        float gain;
+    };
+
+    static constexpr int blockFrames = 1024;
+    static constexpr double rampTime = 0.005;
+
+    std::vector<Stem> stems;
+    unsigned int output = 0;
+    unsigned int freq = 0;
+    int channels = 0;
+    int rampFrames = 1;
+    double start = 0;
+    double length = 0;
+    std::vector<float> scratch;
+    SpscQueue<GainChange, 256> gainChanges;
+    // the game thread's idea of each stem's gain, so it only queues changes
+    std::vector<float> postedGains;
+    // held while mixing, and while seeking, so the stems aren't moved
+    // under a mix
+    std::mutex mixMutex;
+
+    // the next frames of a stem into scratch, at the output's rate; fewer
+    // at its end
+    int read(Stem& stem, int frames);
+    // the next frames of a stem at its own rate
+    int readSource(Stem& stem, float* to, int frames);
+};
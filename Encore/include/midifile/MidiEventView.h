@@ -0,0 +1,97 @@
+//
+// Filename:      midifile/include/MidiEventView.h
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Read-only access to the events of a MidiFile track
+//                without a MidiEvent object per message.  Tracks read
+//                with MidiFile::readPacked() are stored as an array of
+//                PackedMidiEvent records; MidiTrackView gives them the
+//                same indexing interface as MidiEventList, and can also
+//                wrap a regular MidiEventList.
+//
+
+#ifndef _MIDIEVENTVIEW_H_INCLUDED
+#define _MIDIEVENTVIEW_H_INCLUDED
+
+#include "MidiEventList.h"
+#include <string>
+#include <vector>
+
+namespace smf {
+
+class PackedMidiEvent {
+	public:
+		int    tick;       // absolute tick time of the event
+		int    offset;     // meta/sysex: start of the message in the file
+		                   // buffer, or -1 if the bytes are stored in data
+		int    size;       // number of bytes in the message
+		uchar  data[3];    // channel messages, with running status filled in
+};
+
+
+class MidiEventView {
+	public:
+		                 MidiEventView      (void) = default;
+		                 MidiEventView      (int aTick, const uchar* bytes,
+		                                     int count);
+
+		uchar            operator[]         (int index) const;
+		int              getSize            (void) const;
+		int              size               (void) const;
+		const uchar*     data               (void) const;
+
+		int              getP0              (void) const;
+		int              getP1              (void) const;
+		int              getP2              (void) const;
+		int              getMetaType        (void) const;
+		std::string      getMetaContent     (void) const;
+
+		bool             isNoteOn           (void) const;
+		bool             isNoteOff          (void) const;
+		bool             isNote             (void) const;
+		bool             isMeta             (void) const;
+		bool             isMetaMessage      (void) const;
+		bool             isTempo            (void) const;
+		bool             isTrackName        (void) const;
+		bool             isTimeSignature    (void) const;
+		bool             isEndOfTrack       (void) const;
+
+		int              getTempoMicroseconds (void) const;
+		double           getTempoBPM        (void) const;
+		double           getTempoSPT        (int tpq) const;
+
+		int              tick = 0;
+
+	private:
+		const uchar*     m_data = NULL;
+		int              m_size = 0;
+};
+
+
+class MidiTrackView {
+	public:
+		                 MidiTrackView      (void) = default;
+		                 MidiTrackView      (const std::vector<PackedMidiEvent>* events,
+		                                     const uchar* buffer);
+		                 MidiTrackView      (const MidiEventList* list);
+
+		MidiEventView    operator[]         (int index) const;
+		MidiEventView    getEvent           (int index) const;
+		MidiEventView    back               (void) const;
+		int              getEventCount      (void) const;
+		int              getSize            (void) const;
+		int              size               (void) const;
+
+	private:
+		const std::vector<PackedMidiEvent>* m_packed = NULL;
+		const uchar*                        m_buffer = NULL;
+		const MidiEventList*                m_list   = NULL;
+};
+
+} // end of namespace smf
+
+#endif /* _MIDIEVENTVIEW_H_INCLUDED */
+
+
+
@@ -15,6 +15,7 @@
 #define _MIDIFILE_H_INCLUDED
 
 #include "MidiEventList.h"
+#include "MidiEventView.h"
 
 #include <vector>
 #include <string>
@@ -33,6 +34,18 @@ class _TickTime {
 	public:
 		int    tick;
 		double seconds;
+		// only used by the tempo-only time map, where each entry
+		// starts a stretch of constant tempo
+		double secondsPerTick = 0.0;
+};
+
+
+class PackedTrackChunk {
+	public:
+		int         offset = 0;    // start of the track's events in the file
+		int         size = 0;      // chunk size given in the MTrk header
+		std::string name;          // track name message at tick 0, if any
+		bool        decoded = false;
 };
 
 
@@ -61,6 +74,18 @@ class MidiFile {
 		bool           readSmf                     (const std::string& filename);
 		bool           readSmf                     (std::istream& instream);
 
+		// SMF input decoded into packed tracks, only readable through
+		// getTrackView() (the MidiEventLists are left empty):
+		bool           readPacked                  (const std::string& filename,
+		                                            bool decodeTracks = true);
+		bool           readPacked                  (std::vector<uchar> data,
+		                                            bool decodeTracks = true);
+		bool           isPacked                    (void) const;
+		bool           decodeTrack                 (int aTrack);
+		bool           isTrackDecoded              (int aTrack) const;
+		std::string    getTrackName                (int aTrack) const;
+		int            findTrack                   (const std::string& name) const;
+
 		bool           write                       (const std::string& filename);
 		bool           write                       (std::ostream& out);
 		bool           writeBase64                 (const std::string& out, int width = 0);
@@ -81,6 +106,7 @@ class MidiFile {
 		int              getNumTracks              (void) const;
 		int              size                      (void) const;
 		void             removeEmpties             (void);
+		MidiTrackView    getTrackView              (int aTrack) const;
 
 		// tick-related functions:
 		void             makeDeltaTicks            (void);
@@ -129,6 +155,10 @@ class MidiFile {
 		double           getTimeInSeconds          (int aTrack, int anIndex);
 		double           getTimeInSeconds          (int tickvalue);
 		double           getAbsoluteTickTime       (double starttime);
+		void             getTimesInSeconds         (const std::vector<int>& ticks,
+		                                            std::vector<double>& seconds);
+		void             setTempoTimeMap           (bool state = true);
+		bool             hasTempoTimeMap           (void) const;
 		int              getFileDurationInTicks    (void);
 		double           getFileDurationInQuarters (void);
 		double           getFileDurationInSeconds  (void);
@@ -285,6 +315,21 @@ class MidiFile {
 		// m_timemap ==
 		std::vector<_TickTime> m_timemap;
 
+		// m_tempotimemap == True if the time map only holds the tempo
+		// changes of the file instead of every event tick.
+		bool m_tempotimemap = false;
+
+		// m_packeddata == The whole file when read with readPacked().  Meta
+		// and sysex events in m_packedtracks point into it.
+		std::vector<uchar> m_packeddata;
+
+		// m_packedtracks == Events of each track when read with readPacked().
+		// Empty for tracks that have not been decoded yet.
+		std::vector<std::vector<PackedMidiEvent>> m_packedtracks;
+
+		// m_trackdirectory == Where each track chunk is in m_packeddata.
+		std::vector<PackedTrackChunk> m_trackdirectory;
+
 		// m_rwstatus == True if last read was successful, false if a problem.
 		bool m_rwstatus = true;
 
@@ -305,6 +350,18 @@ class MidiFile {
 		static int  ticksearch                      (const void* A, const void* B);
 		static int  secondsearch                    (const void* A, const void* B);
 		void        buildTimeMap                    (void);
+		void        buildTempoTimeMap               (void);
+		bool        readPackedDirectory             (void);
+		bool        decodePackedTrack               (int offset, int chunksize,
+		                                             std::vector<PackedMidiEvent>& list,
+		                                             int& endposition);
+		static bool readPackedEvent                 (const uchar* data, int size,
+		                                             int& position, uchar& runningCommand,
+		                                             PackedMidiEvent& event);
+		static bool readPackedVLV                   (const uchar* data, int size,
+		                                             int& position, int& value);
+		int         tempoSegmentAtTick              (int ticktime) const;
+		int         tempoSegmentAtSecond            (double seconds) const;
 		double      linearTickInterpolationAtSecond (double seconds);
 		double      linearSecondInterpolationAtTick (int ticktime);
 		std::string base64Encode                    (const std::string &input);
@@ -4,55 +4,161 @@
 #include "midifile/MidiFile.h"
 #include "song.h"
 #include "game/timingvalues.h"
+#include "phraseindex.h"
 #include <atomic>
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
+// A note as the parser builds it. Finished charts keep their notes in
+// ChartNotes, and what happens to them during a play in NoteStates.
 class Note 
 {
 public:
-	double time;
-	double len;
-	double beatsLen;
-	double heldTime=0.0;
-	double sustainThreshold = 0.2;
-    double HitOffset = 0.0;
-	int lane;
+	double time = 0.0;
+	double len = 0.0;
+	double beatsLen = 0.0;
+	int lane = 0;
 	bool lift = false;
-	bool hit = false;
-	bool held = false;
 	bool valid = false;
-	bool miss = false;
-	bool accounted = false;
-    bool countedForSolo = false;
-	bool countedForODPhrase = false;
-    bool perfect = false;
-	bool renderAsOD = false;
-    double hitTime = 0;
-    int tick;
+    int tick = 0;
+    // sustain length in ticks, 0 when the note isn't held
+    int tickLen = 0;
 
 	// CLASSIC
-    // 0-4 for grybo, helps with chords
-    int strumCount = 0;
     int chordSize = 0;
-    bool hitWithFAS = false;
-    int mask;
+    // one bit per fret, see Chart::PlasticFrets
+    int mask = 0;
     bool chord = false;
-    std::vector<int> pLanes;
 	bool pForceOn = false;
 	bool pForceOff = false;
     bool phopo = false;
-	bool extendedSustain = false;;
+	bool extendedSustain = false;
+	bool pTap = false;
+	bool pOpen = false;
+};
 
-	bool isGood(double eventTime, double inputOffset) const {
-		return (time - goodBackend + inputOffset < eventTime &&
-			time + goodFrontend + inputOffset > eventTime);
+enum NoteFlags : uint16_t {
+	NoteLift = 1 << 0,
+	NoteChord = 1 << 1,
+	NoteForceOn = 1 << 2,
+	NoteForceOff = 1 << 3,
+	NoteHopo = 1 << 4,
+	NoteExtendedSustain = 1 << 5,
+	NoteTap = 1 << 6,
+	NoteOpen = 1 << 7
+};
+
+// The notes of a finished chart, one array per field, so the render and
+// judging loops only pull in the fields they read.
+class ChartNotes
+{
+public:
+	std::vector<double> time;
+	std::vector<double> len;
+	std::vector<float> beatsLen;
+	std::vector<uint8_t> lane;
+	// fret bits of plastic notes and chords, 1 << lane for pad notes
+	std::vector<uint8_t> mask;
+	std::vector<uint8_t> chordSize;
+	std::vector<uint16_t> flags;
+
+	int size() const { return (int)time.size(); }
+	bool empty() const { return time.empty(); }
+
+	void clear() {
+		time.clear();
+		len.clear();
+		beatsLen.clear();
+		lane.clear();
+		mask.clear();
+		chordSize.clear();
+		flags.clear();
 	}
-	bool isPerfect(double eventTime, double inputOffset) {
-		return (time - perfectBackend + inputOffset < eventTime &&
-			time + perfectFrontend + inputOffset > eventTime);
+
+	void assign(const std::vector<Note>& parsed) {
+		clear();
+		size_t count = parsed.size();
+		time.reserve(count);
+		len.reserve(count);
+		beatsLen.reserve(count);
+		lane.reserve(count);
+		mask.reserve(count);
+		chordSize.reserve(count);
+		flags.reserve(count);
+		for (const Note& note : parsed) {
+			time.push_back(note.time);
+			len.push_back(note.len);
+			beatsLen.push_back((float)note.beatsLen);
+			lane.push_back((uint8_t)note.lane);
+			mask.push_back((uint8_t)(note.mask != 0 ? note.mask : 1 << note.lane));
+			chordSize.push_back((uint8_t)note.chordSize);
+			flags.push_back((note.lift ? NoteLift : 0) | (note.chord ? NoteChord : 0)
+							| (note.pForceOn ? NoteForceOn : 0) | (note.pForceOff ? NoteForceOff : 0)
+							| (note.phopo ? NoteHopo : 0) | (note.extendedSustain ? NoteExtendedSustain : 0)
+							| (note.pTap ? NoteTap : 0) | (note.pOpen ? NoteOpen : 0));
+		}
 	}
 
-	bool pTap = false;
-	bool pOpen = false;
+	bool is(int note, uint16_t flag) const {
+		return flags[note] & flag;
+	}
+
+	bool isGood(int note, double eventTime, double inputOffset) const {
+		return (time[note] - goodBackend + inputOffset < eventTime &&
+			time[note] + goodFrontend + inputOffset > eventTime);
+	}
+	bool isPerfect(int note, double eventTime, double inputOffset) const {
+		return (time[note] - perfectBackend + inputOffset < eventTime &&
+			time[note] + perfectFrontend + inputOffset > eventTime);
+	}
+};
+
+enum NoteStateFlags : uint16_t {
+	NoteHit = 1 << 0,
+	NoteHeld = 1 << 1,
+	NoteMiss = 1 << 2,
+	NoteAccounted = 1 << 3,
+	NotePerfect = 1 << 4,
+	NoteCountedForSolo = 1 << 5,
+	NoteCountedForODPhrase = 1 << 6,
+	NoteRenderAsOD = 1 << 7,
+	NoteHitWithFAS = 1 << 8
+};
+
+// Judging state of a chart's notes for the current play. Everything lives in
+// one block, so restarting a song is a single memset.
+class NoteStates
+{
+public:
+	void resize(int count) {
+		this->count = count;
+		block.assign((size_t)count * bytesPerNote, 0);
+	}
+	void reset() {
+		if (!block.empty())
+			memset(block.data(), 0, block.size());
+	}
+
+	bool is(int note, uint16_t flag) const { return flagWords()[note] & flag; }
+	void set(int note, uint16_t flag) { flagWords()[note] |= flag; }
+	void unset(int note, uint16_t flag) { flagWords()[note] &= ~flag; }
+	void set(int note, uint16_t flag, bool on) { on ? set(note, flag) : unset(note, flag); }
+
+	double& heldTime(int note) { return doubles()[note]; }
+	double& hitTime(int note) { return doubles()[count + note]; }
+	double& hitOffset(int note) { return doubles()[2 * count + note]; }
+	uint8_t& strumCount(int note) { return block[(size_t)count * (flagsOffset + sizeof(uint16_t)) + note]; }
+
+private:
+	// heldTime, hitTime, hitOffset, then the flag words and strum counts
+	static constexpr size_t flagsOffset = 3 * sizeof(double);
+	static constexpr size_t bytesPerNote = flagsOffset + sizeof(uint16_t) + sizeof(uint8_t);
+	int count = 0;
+	std::vector<uint8_t> block;
+
+	double* doubles() { return reinterpret_cast<double*>(block.data()); }
+	uint16_t* flagWords() { return reinterpret_cast<uint16_t*>(block.data() + (size_t)count * flagsOffset); }
+	const uint16_t* flagWords() const { return reinterpret_cast<const uint16_t*>(block.data() + (size_t)count * flagsOffset); }
 };
 
 enum ChartLoadingState {
@@ -121,195 +227,200 @@ private:
     static bool areNotesEqual(const Note& a, const Note& b) {
         return a.tick == b.tick;
     }
-public:
-	bool valid = false;
-    std::vector<int> PlasticFrets = {
-        0b000001, // green
-        0b000010, // red
-        0b000100, // yellow
-        0b001000, // blue
-        0b010000  // orange
-    };
-
-
-    bool plastic = false;
-    // plastic stuff :tm:
-    // note: clones dont do thresh. they do 12ths
-    int hopoThreshold = 170;
+    int odNote = 116;
 
-	std::vector<Note> notes;
-	std::vector <std::vector<int>> notes_perlane{ {},{},{},{},{} };
-	int baseScore = 0;
-	int findNoteIdx(double time, int lane) {
-        // if i is smaller than the amount of notes
-		for (int i = 0; i < notes.size();i++) {
-            // if a note exists at the time given, and is in the same lane, return that note's value
-			if (notes[i].time == time && notes[i].lane == lane)
-				return i;
+	// per-difficulty bookkeeping while a track's events are walked
+	struct NoteParseState {
+		std::vector<bool> notesOn{ false,false,false,false,false };
+		std::vector<int> noteOnTick{ 0,0,0,0,0 };
+		// index of the note each held lane will be closed into
+		std::vector<int> noteOnIdx{ -1,-1,-1,-1,-1 };
+		// newest note created in each lane. events come in tick order, so any
+		// earlier note at the same time and lane can only be this one
+		std::vector<int> laneNoteIdx{ -1,-1,-1,-1,-1 };
+	};
+	struct PhraseParseState {
+		bool odOn = false;
+		bool soloOn = false;
+		bool tapOn = false;
+		bool forceOn = false;
+		bool forceOff = false;
+	};
+
+	template <typename Phrase>
+	static void parsePhrase(std::vector<Phrase>& phrases, bool& phraseOn, bool noteOn, double time) {
+		if (noteOn && !phraseOn) {
+			Phrase newPhrase;
+			newPhrase.start = time;
+			phrases.push_back(newPhrase);
+			phraseOn = true;
+		}
+		else if (!noteOn && phraseOn) {
+			phrases.back().end = time;
+			phraseOn = false;
 		}
-		return -1;
 	}
 
-	int diff = -1;
-    std::vector<Note> notesPre;
-
-    int findNotePreIdx(double time, int lane) {
-        // if i is smaller than the amount of notes
-        for (int i = 0; i < notesPre.size();i++) {
-            // if a note exists at the time given, and is in the same lane, return that note's value
-            if (notesPre[i].time == time && notesPre[i].lane == lane)
-                return i;
-        }
-        return -1;
-    }
-
-    std::vector<int> findPNoteIdx(double time) {
-        std::vector<int> sameNotes;
-        // if i is smaller than the amount of notes
-        for (int i = 0; i < notesPre.size();i++) {
-            // if a note exists at the time given, and is in the same lane, return that note's value
-            if (notesPre[i].time == time)
-                sameNotes.push_back(i);
-        } if (sameNotes.empty()) {
-            sameNotes.push_back(-1);
-        }
-        return sameNotes;
-    }
-
-    std::vector<forceOnPhrase> forcedOnPhrases;
-	std::vector<tapPhrase> tapPhrases;
-    std::vector<forceOffPhrase> forcedOffPhrases;
-	std::vector<odPhrase> odPhrases;
-    std::vector<solo> Solos;
-    int resolution = 480;
-	void parseNotes(smf::MidiFile& midiFile, int trkidx, smf::MidiEventList events, int diff, int instrument) {
-		std::vector<bool> notesOn{ false,false,false,false,false};
-		bool odOn = false;
-        bool soloOn = false;
-		std::vector<double> noteOnTime{ 0.0, 0.0, 0.0, 0.0, 0.0};
-		std::vector<int> noteOnTick{ 0,0,0,0,0 };
-		std::vector<int> notePitches = diffNotes[diff];
-		int odNote = 116;
-
-		int curODPhrase = -1;
-        int curSolo = -1;
-		int curBPM = 0;
-        resolution = midiFile.getTicksPerQuarterNote();
-		for (int i = 0; i < events.getSize(); i++) {
-			if (events[i].isNoteOn()) {
-				double time = midiFile.getTimeInSeconds(trkidx, i);
-				int tick = midiFile.getAbsoluteTickTime(time);
-				if ((int)events[i][1] >= notePitches[0] && (int)events[i][1] <= notePitches[1]) {
-					int lane = (int)events[i][1] - notePitches[0];
-					if (!notesOn[lane]) {
-						noteOnTime[lane] = time;
-						noteOnTick[lane] = tick;
-						notesOn[lane] = true;
-						int noteIdx = findNoteIdx(time, lane);
-						if (noteIdx != -1) {
-							notes[noteIdx].valid = true;
-						}
-						else {
-							Note newNote;
-							newNote.time = time;
-							newNote.lane = lane;
-							newNote.valid = true;
-							notes.push_back(newNote);
-						}
-					}
-				}
-				else if ((int)events[i][1] >= notePitches[2] && (int)events[i][1] <= notePitches[3]) {
-					int lane = (int)events[i][1] - notePitches[2];
-					int noteIdx = findNoteIdx(time, lane);
+	// returns false if the pitch isn't one of this difficulty's notes or lifts
+	bool parseNoteEvent(NoteParseState& state, const smf::MidiEventView& event, int tick) {
+		const std::vector<int>& notePitches = diffNotes[diff];
+		int pitch = (int)event[1];
+		auto laneNoteAt = [&](int lane) {
+			int idx = state.laneNoteIdx[lane];
+			return (idx != -1 && parsedNotes[idx].tick == tick) ? idx : -1;
+		};
+		if (pitch >= notePitches[0] && pitch <= notePitches[1]) {
+			int lane = pitch - notePitches[0];
+			if (event.isNoteOn()) {
+				if (!state.notesOn[lane]) {
+					state.noteOnTick[lane] = tick;
+					state.notesOn[lane] = true;
+					int noteIdx = laneNoteAt(lane);
 					if (noteIdx != -1) {
-						notes[noteIdx].lift = true;
+						parsedNotes[noteIdx].valid = true;
 					}
 					else {
 						Note newNote;
-						newNote.time = time;
-						newNote.valid = false;
+						newNote.tick = tick;
 						newNote.lane = lane;
-						newNote.lift = true;
-						notes.push_back(newNote);
+						newNote.valid = true;
+						parsedNotes.push_back(newNote);
+						noteIdx = parsedNotes.size() - 1;
+						state.laneNoteIdx[lane] = noteIdx;
 					}
+					state.noteOnIdx[lane] = noteIdx;
 				}
-				else if ((int)events[i][1] == odNote) {
-					if (!odOn) {
-						odOn = true;
-						odPhrase newPhrase;
-						newPhrase.start = midiFile.getTimeInSeconds(trkidx, i);
-						odPhrases.push_back(newPhrase);
-						curODPhrase++;
-						
-					}
-					
-				} else if ((int)events[i][1] == soloNote) {
-                    if (!soloOn) {
-                        soloOn = true;
-                        solo newSolo;
-                        newSolo.start = midiFile.getTimeInSeconds(trkidx, i);
-                        Solos.push_back(newSolo);
-                        curSolo++;
-                    }
-                }
 			}
-			else if (events[i].isNoteOff()) {
-				double time = midiFile.getTimeInSeconds(trkidx, i);
-				int tick = midiFile.getAbsoluteTickTime(time);
-				if ((int)events[i][1] >= notePitches[0] && (int)events[i][1] <= notePitches[1]) {
-					int lane = (int)events[i][1] - notePitches[0];
-					if (notesOn[lane] == true) {
-						int noteIdx = findNoteIdx(noteOnTime[lane], lane);
-						if (noteIdx != -1) {
-							notes[noteIdx].beatsLen = (tick - noteOnTick[lane]) / (float)midiFile.getTicksPerQuarterNote();
-							if (notes[noteIdx].beatsLen > 0.25) {
-								notes[noteIdx].len = time - notes[noteIdx].time;
-							}
-							else {
-								notes[noteIdx].beatsLen = 0;
-								notes[noteIdx].len = 0;
-							}
-						}
-						noteOnTick[lane] = 0;
-						noteOnTime[lane] = 0;
-						notesOn[lane] = false;
+			else if (state.notesOn[lane]) {
+				int noteIdx = state.noteOnIdx[lane];
+				if (noteIdx != -1) {
+					parsedNotes[noteIdx].beatsLen = (tick - state.noteOnTick[lane]) / (float)resolution;
+					if (parsedNotes[noteIdx].beatsLen > 0.25) {
+						parsedNotes[noteIdx].tickLen = tick - parsedNotes[noteIdx].tick;
 					}
-				}
-				else if ((int)events[i][1] == odNote) {
-					if (odOn == true) {
-						odPhrases[curODPhrase].end = time;
-						odOn = false;
+					else {
+						parsedNotes[noteIdx].beatsLen = 0;
+						parsedNotes[noteIdx].tickLen = 0;
 					}
 				}
-                else if ((int)events[i][1] == soloNote) {
-                    if (soloOn == true) {
-                        Solos[curSolo].end = time;
-                        soloOn = false;
-                    }
-                }
+				state.noteOnTick[lane] = 0;
+				state.noteOnIdx[lane] = -1;
+				state.notesOn[lane] = false;
+			}
+			return true;
+		}
+		if (pitch >= notePitches[2] && pitch <= notePitches[3]) {
+			int lane = pitch - notePitches[2];
+			if (event.isNoteOn()) {
+				int noteIdx = laneNoteAt(lane);
+				if (noteIdx != -1) {
+					parsedNotes[noteIdx].lift = true;
+				}
+				else {
+					Note newNote;
+					newNote.tick = tick;
+					newNote.valid = false;
+					newNote.lane = lane;
+					newNote.lift = true;
+					parsedNotes.push_back(newNote);
+					state.laneNoteIdx[lane] = parsedNotes.size() - 1;
+				}
+			}
+			return true;
+		}
+		return false;
+	}
+
+	// returns false if the pitch isn't one of this difficulty's frets
+	bool parsePlasticNoteEvent(NoteParseState& state, const smf::MidiEventView& event, int tick) {
+		const std::vector<int>& notePitches = pDiffNotes[diff];
+		int pitch = (int)event[1];
+		if (pitch < notePitches[0] || pitch > notePitches[4])
+			return false;
+		int lane = pitch - notePitches[0];
+		if (event.isNoteOn()) {
+			if (!state.notesOn[lane]) {
+				// a note-off closes the first pre-note at its note-on time
+				if (state.noteOnIdx[lane] == -1 || notesPre[state.noteOnIdx[lane]].tick != tick)
+					state.noteOnIdx[lane] = notesPre.size();
+				Note newNote;
+				newNote.lane = lane;
+				newNote.tick = tick;
+				notesPre.push_back(newNote);
+				state.notesOn[lane] = true;
+				state.noteOnTick[lane] = tick;
 			}
 		}
+		else if (state.notesOn[lane]) {
+			int noteIdx = state.noteOnIdx[lane];
+			if (noteIdx != -1) {
+				notesPre[noteIdx].beatsLen = (tick - notesPre[noteIdx].tick) / (float)resolution;
+				if (notesPre[noteIdx].beatsLen > 0.25) {
+					notesPre[noteIdx].tickLen = tick - notesPre[noteIdx].tick;
+				}
+				else {
+					notesPre[noteIdx].beatsLen = 0;
+					notesPre[noteIdx].tickLen = 0;
+				}
+			}
+			state.noteOnTick[lane] = 0;
+			state.notesOn[lane] = false;
+		}
+		return true;
+	}
+
+	void parsePhraseEvent(PhraseParseState& state, const smf::MidiEventView& event, double time) {
+		int pitch = (int)event[1];
+		bool noteOn = event.isNoteOn();
+		if (pitch == odNote)
+			parsePhrase(odPhrases, state.odOn, noteOn, time);
+		else if (!plastic && pitch == soloNote)
+			parsePhrase(Solos, state.soloOn, noteOn, time);
+		else if (plastic && pitch == pSoloNote)
+			parsePhrase(Solos, state.soloOn, noteOn, time);
+		else if (plastic && pitch == pTapNote)
+			parsePhrase(tapPhrases, state.tapOn, noteOn, time);
+		else if (plastic && pitch == pForceOn)
+			parsePhrase(forcedOnPhrases, state.forceOn, noteOn, time);
+		else if (plastic && pitch == pForceOff)
+			parsePhrase(forcedOffPhrases, state.forceOff, noteOn, time);
+	}
+
+	// notes are parsed in ticks; fill in their seconds with one pass over the tempo map
+	static void resolveNoteTimes(std::vector<Note>& parsed, smf::MidiFile& midiFile) {
+		std::vector<int> ticks(parsed.size());
+		std::vector<double> seconds;
+		for (int i = 0; i < parsed.size(); i++)
+			ticks[i] = parsed[i].tick;
+		midiFile.getTimesInSeconds(ticks, seconds);
+		for (int i = 0; i < parsed.size(); i++) {
+			Note& note = parsed[i];
+			note.time = seconds[i];
+			note.len = note.tickLen > 0 ? midiFile.getTimeInSeconds(note.tick + note.tickLen) - note.time : 0.0;
+		}
+	}
+
+	void processNotes(int instrument) {
 		std::cout << "ENC: Processed base notes for " << instrument << " " << diff << std::endl;
 
-		curODPhrase = 0;
+		buildPhraseIndex();
 		if (odPhrases.size() > 0) {
 			LoadingState = OVERDRIVE;
-			for (Note &note : notes) {
-				if (note.time > odPhrases[curODPhrase].end && curODPhrase<odPhrases.size()-1)
-					curODPhrase++;
-				if (note.time >= odPhrases[curODPhrase].start && note.time < odPhrases[curODPhrase].end)
-					odPhrases[curODPhrase].noteCount++;
+			PhraseCursor odCursor = phrases.cursor(PhraseOverdrive);
+			for (Note &note : parsedNotes) {
+				int phrase = odCursor.at(note.time);
+				if (phrase != -1)
+					odPhrases[phrase].noteCount++;
 			}
 		}
 		std::cout << "ENC: Processed overdrive for " << instrument << " " << diff << std::endl;
-        curSolo = 0;
         if (Solos.size() > 0) {
         	LoadingState = SOLOS;
-            for (Note &note : notes) {
-                if (note.time > Solos[curSolo].end && curSolo<Solos.size()-1)
-                    curSolo++;
-                if (note.time >= Solos[curSolo].start && note.time <= Solos[curSolo].end)
-                    Solos[curSolo].noteCount++;
+            PhraseCursor soloCursor = phrases.cursor(PhraseSolo);
+            for (Note &note : parsedNotes) {
+                int phrase = soloCursor.at(note.time, true);
+                if (phrase != -1)
+                    Solos[phrase].noteCount++;
             }
         }
 		std::cout << "ENC: Processed solos for " << instrument << " " << diff << std::endl;
@@ -317,257 +428,112 @@ public:
 		int multCtr = 0;
 		int noteIdx = 0;
 		bool isBassOrVocal = (instrument == 1 || instrument == 3);
-		for (auto it = notes.begin(); it != notes.end();) {
-			LoadingState = BASE_SCORE;
-			Note& note = *it;
-			if (!note.valid) {
-				it = notes.erase(it);
-			}
-			else {
-				baseScore += (36 * mult);
-				baseScore += (note.beatsLen * 12) * mult;
-				if (noteIdx == 9) mult = 2;
-				else if (noteIdx == 19) mult = 3;
-				else if (noteIdx == 29) mult = 4;
-				else if (noteIdx == 39 && isBassOrVocal) mult = 5;
-				else if (noteIdx == 49 && isBassOrVocal) mult = 6;
-				noteIdx++;
-				++it;
-			}
+		LoadingState = BASE_SCORE;
+		parsedNotes.erase(std::remove_if(parsedNotes.begin(), parsedNotes.end(),
+								   [](const Note& note) { return !note.valid; }), parsedNotes.end());
+		for (Note& note : parsedNotes) {
+			baseScore += (36 * mult);
+			baseScore += (note.beatsLen * 12) * mult;
+			if (noteIdx == 9) mult = 2;
+			else if (noteIdx == 19) mult = 3;
+			else if (noteIdx == 29) mult = 4;
+			else if (noteIdx == 39 && isBassOrVocal) mult = 5;
+			else if (noteIdx == 49 && isBassOrVocal) mult = 6;
+			noteIdx++;
 		}
 		std::cout << "ENC: Processed base score for " << instrument << " " << diff << std::endl;
 		LoadingState = NOTE_SORTING;
-        std::sort(notes.begin(), notes.end(),
+        std::sort(parsedNotes.begin(), parsedNotes.end(),
                   compareNotes);
+		setNotes(parsedNotes);
 		std::cout << "ENC: Processed notes for " << instrument << " " << diff << std::endl;
 	}
-    void parsePlasticNotes(smf::MidiFile& midiFile, int trkidx, smf::MidiEventList events, int diff, int instrument) {
-        bool odOn = false;
-        bool soloOn = false;
-        bool forceOn = false;
-		bool tapOn = false;
-        bool forceOff = false;
-        std::vector<int> notePitches = pDiffNotes[diff];
-        std::vector<double> noteOnTime{ 0.0, 0.0, 0.0, 0.0, 0.0};
-        std::vector<int> noteOnTick{ 0,0,0,0,0 };
-        std::vector<bool> notesOn{ false,false,false,false,false};
-
-        midiFile.linkNotePairs();
-        int odNote = 116;
-        int curNote = -1;
-        int curFOn = -1;
-		int curTap = -1;
-        int curFOff = -1;
-        int curODPhrase = -1;
-        int curSolo = -1;
-        int curBPM = 0;
-        resolution = midiFile.getTicksPerQuarterNote();
-        if (instrument == 5 || instrument == 6) {
-            for (int i = 0; i < events.getSize(); i++) {
-                if (events[i].isNoteOn()) {
-                    if (events[i][1] >= notePitches[0] && events[i][1] <= notePitches[4]) {
-                        double time = midiFile.getTimeInSeconds(trkidx, i);
-                        int tick = midiFile.getAbsoluteTickTime(time);
-                        int pitch = events[i][1];
-                        int lane = pitch - notePitches[0];
-                        if (!notesOn[lane]) {
-                            Note newNote;
-                            newNote.lane = lane;
-                            newNote.tick = tick;
-                            newNote.time = time;
-                            notesPre.push_back(newNote);
-                            notesOn[lane] = true;
-                            noteOnTick[lane] = tick;
-                            noteOnTime[lane] = time;
-                            curNote++;
-                        }
-                    }
-					else if ((int)events[i][1] == pTapNote) {
-						if (!tapOn) {
-							tapPhrase newPhrase;
-							newPhrase.start = midiFile.getTimeInSeconds(trkidx, i);
-							tapPhrases.push_back(newPhrase);
-							tapOn = true;
-							curTap++;
-						}
-					}
-                    else if ((int)events[i][1] == pForceOn) {
-                        if (!forceOn) {
-                            forceOnPhrase newPhrase;
-                            newPhrase.start = midiFile.getTimeInSeconds(trkidx, i);
-                            forcedOnPhrases.push_back(newPhrase);
-                            forceOn = true;
-                            curFOn++;
-                        }
-                    }
-                    else if ((int)events[i][1] == pForceOff) {
-                        if (!forceOff) {
-                            forceOffPhrase newPhrase;
-                            newPhrase.start = midiFile.getTimeInSeconds(trkidx, i);
-                            forcedOffPhrases.push_back(newPhrase);
-                            forceOff = true;
-                            curFOff++;
-                        }
-                    }
-                    else if ((int)events[i][1] == odNote) {
-                        if (!odOn) {
-                            odOn = true;
-                            odPhrase newPhrase;
-                            newPhrase.start = midiFile.getTimeInSeconds(trkidx, i);
-                            odPhrases.push_back(newPhrase);
-                            curODPhrase++;
-
-                        }
-
-                    } else if ((int)events[i][1] == pSoloNote) {
-                        if (!soloOn) {
-                            soloOn = true;
-                            solo newSolo;
-                            newSolo.start = midiFile.getTimeInSeconds(trkidx, i);
-                            Solos.push_back(newSolo);
-                            curSolo++;
-                        }
-                    }
-                    } else if (events[i].isNoteOff()) {
-                        double time = midiFile.getTimeInSeconds(trkidx, i);
-                        int tick = midiFile.getAbsoluteTickTime(time);
-                        if ((int)events[i][1] >= notePitches[0] && (int)events[i][1] <= notePitches[4]) {
-                            int lane = (int)events[i][1] - notePitches[0];
-                            if (notesOn[lane]) {
-                                int noteIdx = findNotePreIdx(noteOnTime[lane], lane);
-                                if (noteIdx != -1) {
-                                    notesPre[noteIdx].beatsLen = (tick - notesPre[noteIdx].tick) / (float)midiFile.getTicksPerQuarterNote();
-                                    if (notesPre[noteIdx].beatsLen > 0.25) {
-                                        notesPre[noteIdx].len = time - notesPre[noteIdx].time;
-                                    }
-                                    else {
-                                        notesPre[noteIdx].beatsLen = 0;
-                                        notesPre[noteIdx].len = 0;
-                                    }
-                                }
-                                noteOnTick[lane] = 0;
-                                noteOnTime[lane] = 0;
-                                notesOn[lane] = false;
-                            }
-                        }
-						else if ((int)events[i][1] == pTapNote) {
-							if (tapOn) {
-								tapPhrases[curTap].end = time;
-								tapOn = false;
-							}
-						}
-                        else if ((int)events[i][1] == pForceOn) {
-                            if (forceOn) {
-                                forcedOnPhrases[curFOn].end = time;
-                                forceOn = false;
-                            }
-                        }
-                        else if ((int)events[i][1] == pForceOff) {
-                            if (forceOff) {
-                                forcedOffPhrases[curFOff].end = time;
-                                forceOff = false;
-                            }
-                        }
-                        else if ((int)events[i][1] == odNote) {
-                            if (odOn) {
-                                odPhrases[curODPhrase].end = time;
-                                odOn = false;
-                            }
-                        }
-                        else if ((int)events[i][1] == pSoloNote) {
-                            if (soloOn) {
-                                Solos[curSolo].end = time;
-                                soloOn = false;
-                            }
-                        }
-                    }
-                }
-        };
-		std::cout << "ENC: Loaded base notes for " << instrument << " " << diff << std::endl;
 
-            for (int i = 0; i < notesPre.size(); i++) {
-            	LoadingState = PLASTIC_CALC;
-                Note note = notesPre[i];
-                Note newNote;
-                newNote.chordSize = 1;
-                newNote.mask = PlasticFrets[note.lane];
-                for (Note noteMatching : notesPre) {
-                    if (noteMatching.tick == note.tick && noteMatching.lane != note.lane) {
-                        newNote.pLanes.push_back(noteMatching.lane);
-                        newNote.mask |= PlasticFrets[noteMatching.lane];
-                        newNote.chord = true;
-                        newNote.chordSize++;
-                    	if (noteMatching.beatsLen > note.beatsLen) {
-							newNote.beatsLen = noteMatching.beatsLen;
-                    	} else {
-                    		newNote.beatsLen = note.beatsLen;
-                    	}
-                    }
-                }
-                newNote.pLanes.push_back(note.lane);
-                newNote.tick = note.tick;
-                if (notes.size() > 0) {
-                    Note lastNote = notes[notes.size() - 1];
-                    if (lastNote.tick >= newNote.tick - (midiFile.getTicksPerQuarterNote()/2.82) && lastNote.pLanes[0] != newNote.pLanes[0] && !newNote.chord) {
-                        newNote.phopo = true;
-                    }
-                }
-                newNote.len = note.len;
-                newNote.time = note.time;
-                newNote.valid = true;
-                notes.push_back(newNote);
+	void processPlasticNotes(int instrument) {
+		std::cout << "ENC: Loaded base notes for " << instrument << " " << diff << std::endl;
 
-            }
-			LoadingState = NOTE_SORTING;
-            auto it = std::unique(notes.begin(), notes.end(), areNotesEqual);
-            notes.erase(it, notes.end());
-            std::sort(notes.begin(), notes.end(),
-                  compareNotes);
-            auto again = std::unique(notes.begin(), notes.end(), areNotesEqual);
-            notes.erase(again, notes.end());
+		// notesPre is already in tick order from the event list; the stable sort
+		// only guarantees each chord's members sit next to each other in the
+		// order they were charted
+		LoadingState = NOTE_SORTING;
+		std::stable_sort(notesPre.begin(), notesPre.end(),
+						 [](const Note& a, const Note& b) { return a.tick < b.tick; });
+		LoadingState = PLASTIC_CALC;
+		parsedNotes.reserve(notesPre.size());
+		int lastTick = 0;
+		int lastLane = -1;
+		for (int i = 0; i < notesPre.size();) {
+			const Note& note = notesPre[i];
+			int chordEnd = i + 1;
+			while (chordEnd < notesPre.size() && notesPre[chordEnd].tick == note.tick)
+				chordEnd++;
+
+			Note newNote;
+			newNote.chordSize = 1;
+			newNote.mask = PlasticFrets[note.lane];
+			newNote.beatsLen = note.beatsLen;
+			for (int j = i + 1; j < chordEnd; j++) {
+				const Note& noteMatching = notesPre[j];
+				if (noteMatching.lane == note.lane)
+					continue;
+				newNote.mask |= PlasticFrets[noteMatching.lane];
+				newNote.chord = true;
+				newNote.chordSize++;
+				if (noteMatching.beatsLen > newNote.beatsLen)
+					newNote.beatsLen = noteMatching.beatsLen;
+			}
+			newNote.lane = note.lane;
+			newNote.tick = note.tick;
+			if (lastLane != -1) {
+				if (lastTick >= newNote.tick - (resolution/2.82) && lastLane != newNote.lane && !newNote.chord) {
+					newNote.phopo = true;
+				}
+			}
+			newNote.len = note.len;
+			newNote.tickLen = note.tickLen;
+			newNote.time = note.time;
+			newNote.valid = true;
+			parsedNotes.push_back(std::move(newNote));
+
+			// a single after a chord compares against the chord's first fret
+			// that differs from its last one, same as before chords were bucketed
+			const Note& chordLast = notesPre[chordEnd - 1];
+			lastLane = chordLast.lane;
+			for (int j = i; j < chordEnd; j++) {
+				if (notesPre[j].lane != chordLast.lane) {
+					lastLane = notesPre[j].lane;
+					break;
+				}
+			}
+			lastTick = note.tick;
+			i = chordEnd;
+		}
 		std::cout << "ENC: Sorted notes for " << instrument << " " << diff << std::endl;
-		curTap = 0;
+		buildPhraseIndex();
 		LoadingState = NOTE_MODIFIERS;
 		if (tapPhrases.size() > 0) {
-			for (Note &note : notes) {
-				if (note.time > tapPhrases[curTap].end && curTap<tapPhrases.size()-1)
-					curTap++;
-
-				// std::cout << "fOn: " << forcedOnPhrases[curFOn].start << std::endl << "fOff: "
-				//           << forcedOnPhrases[curFOn].end << std::endl;
-
-				if (note.time >= tapPhrases[curTap].start && note.time < tapPhrases[curTap].end) {
+			PhraseCursor tapCursor = phrases.cursor(PhraseTap);
+			for (Note &note : parsedNotes) {
+				if (tapCursor.at(note.time) != -1) {
 					note.pTap = true;
 					note.phopo = false;
 				}
 			}
 		}
 		std::cout << "ENC: Processed taps for " << instrument << " " << diff << std::endl;
-        curFOff = 0;
         if (forcedOffPhrases.size() > 0) {
-            for (Note &note : notes) {
-                if (note.time > forcedOffPhrases[curFOff].end && curFOff<forcedOffPhrases.size()-1)
-                    curFOff++;
-
-                // std::cout << "fOn: " << forcedOnPhrases[curFOn].start << std::endl << "fOff: "
-                //           << forcedOnPhrases[curFOn].end << std::endl;
-
-                if (note.time >= forcedOffPhrases[curFOff].start && note.time < forcedOffPhrases[curFOff].end) {
+            PhraseCursor forceOffCursor = phrases.cursor(PhraseForceOff);
+            for (Note &note : parsedNotes) {
+                if (forceOffCursor.at(note.time) != -1) {
 					if (!note.pTap)
                     	note.phopo = false;
                 }
             }
         }
-            curFOn = 0;
             if (forcedOnPhrases.size() > 0) {
-                for (Note &note : notes) {
-                    if (note.time > forcedOnPhrases[curFOn].end && curFOn<forcedOnPhrases.size()-1)
-                        curFOn++;
-
-                    // std::cout << "fOn: " << forcedOnPhrases[curFOn].start << std::endl << "fOff: "
-                    //           << forcedOnPhrases[curFOn].end << std::endl;
-
-                    if (note.time >= forcedOnPhrases[curFOn].start && note.time < forcedOnPhrases[curFOn].end) {
+                PhraseCursor forceOnCursor = phrases.cursor(PhraseForceOn);
+                for (Note &note : parsedNotes) {
+                    if (forceOnCursor.at(note.time) != -1) {
 						if (!note.pTap)
                         	note.phopo = true;
                     }
@@ -576,33 +542,31 @@ public:
 
 		std::cout << "ENC: Processed hopos for " << instrument << " " << diff << std::endl;
 		LoadingState = OVERDRIVE;
-        curODPhrase = 0;
         if (odPhrases.size() > 0) {
-            for (Note &note : notes) {
-                if (note.time > odPhrases[curODPhrase].end && curODPhrase<odPhrases.size()-1)
-                    curODPhrase++;
-                if (note.time >= odPhrases[curODPhrase].start && note.time < odPhrases[curODPhrase].end)
-                    odPhrases[curODPhrase].noteCount++;
+            PhraseCursor odCursor = phrases.cursor(PhraseOverdrive);
+            for (Note &note : parsedNotes) {
+                int phrase = odCursor.at(note.time);
+                if (phrase != -1)
+                    odPhrases[phrase].noteCount++;
             }
         }
 		std::cout << "ENC: Processed overdrive for " << instrument << " " << diff << std::endl;
 		LoadingState = SOLOS;
-        curSolo = 0;
         if (Solos.size() > 0) {
-            for (Note &note : notes) {
-                if (note.time > Solos[curSolo].end && curSolo<Solos.size()-1)
-                    curSolo++;
-                if (note.time >= Solos[curSolo].start && note.time < Solos[curSolo].end)
-                    Solos[curSolo].noteCount++;
+            PhraseCursor soloCursor = phrases.cursor(PhraseSolo);
+            for (Note &note : parsedNotes) {
+                int phrase = soloCursor.at(note.time);
+                if (phrase != -1)
+                    Solos[phrase].noteCount++;
             }
         }
 		std::cout << "ENC: Processed solos for " << instrument << " " << diff << std::endl;
 		int esc = 0;
 		LoadingState = PLASTIC_CALC;
-		if (notes.size() > 0) {
-			if (esc < notes.size() - 1) {
-				if ((notes[esc].len + notes[esc].time > notes[esc+1].time) && notes[esc].len > 0) {
-					notes[esc].extendedSustain = true;
+		if (parsedNotes.size() > 0) {
+			if (esc < parsedNotes.size() - 1) {
+				if ((parsedNotes[esc].len + parsedNotes[esc].time > parsedNotes[esc+1].time) && parsedNotes[esc].len > 0) {
+					parsedNotes[esc].extendedSustain = true;
 				}
 			}
 		}
@@ -612,40 +576,171 @@ public:
         int noteIdx = 0;
         bool isBassOrVocal = (instrument == 5);
 		LoadingState = BASE_SCORE;
-        for (auto it = notes.begin(); it != notes.end();) {
-            Note& note = *it;
-            if (!note.valid) {
-                it = notes.erase(it);
-            }
-            else {
-                baseScore += ((36 * note.chordSize) * mult);
-                baseScore += (note.beatsLen * 12) * mult;
-                if (noteIdx == 9) mult = 2;
-                else if (noteIdx == 19) mult = 3;
-                else if (noteIdx == 29) mult = 4;
-                else if (noteIdx == 39 && isBassOrVocal) mult = 5;
-                else if (noteIdx == 49 && isBassOrVocal) mult = 6;
-                noteIdx++;
-                ++it;
-            }
+        parsedNotes.erase(std::remove_if(parsedNotes.begin(), parsedNotes.end(),
+                                   [](const Note& note) { return !note.valid; }), parsedNotes.end());
+        for (Note& note : parsedNotes) {
+            baseScore += ((36 * note.chordSize) * mult);
+            baseScore += (note.beatsLen * 12) * mult;
+            if (noteIdx == 9) mult = 2;
+            else if (noteIdx == 19) mult = 3;
+            else if (noteIdx == 29) mult = 4;
+            else if (noteIdx == 39 && isBassOrVocal) mult = 5;
+            else if (noteIdx == 49 && isBassOrVocal) mult = 6;
+            noteIdx++;
         }
 		std::cout << "ENC: Processed base score for " << instrument << " " << diff << std::endl;
+		setNotes(parsedNotes);
+		notesPre.clear();
 		std::cout << "ENC: Processed plastic chart for " << instrument << " " << diff << std::endl;
     }
+public:
+	bool valid = false;
+    std::vector<int> PlasticFrets = {
+        0b000001, // green
+        0b000010, // red
+        0b000100, // yellow
+        0b001000, // blue
+        0b010000  // orange
+    };
 
-	void resetNotes() {
-		for (Note& note : notes) {
-			note.accounted = false;
-			note.hit = false;
-			note.miss = false;
-			note.held = false;
-			note.heldTime = 0;
-			note.hitTime = 0;
-			note.perfect = false;
-			note.countedForODPhrase = false;
-            note.hitWithFAS = false;
-            note.strumCount = 0;
+
+    bool plastic = false;
+    // plastic stuff :tm:
+    // note: clones dont do thresh. they do 12ths
+    int hopoThreshold = 170;
+
+	ChartNotes notes;
+	NoteStates noteStates;
+	std::vector <std::vector<int>> notes_perlane{ {},{},{},{},{} };
+	int baseScore = 0;
+	int findNoteIdx(double time, int lane) {
+        // if i is smaller than the amount of notes
+		for (int i = 0; i < notes.size();i++) {
+            // if a note exists at the time given, and is in the same lane, return that note's value
+			if (notes.time[i] == time && notes.lane[i] == lane)
+				return i;
+		}
+		return -1;
+	}
+
+	// the finished notes, with fresh judging state
+	void setNotes(const std::vector<Note>& parsed) {
+		notes.assign(parsed);
+		noteStates.resize(notes.size());
+		parsedNotes.clear();
+	}
+
+	int diff = -1;
+	// notes while they're being parsed, before they go into notes
+	std::vector<Note> parsedNotes;
+    std::vector<Note> notesPre;
+
+    int findNotePreIdx(double time, int lane) {
+        // if i is smaller than the amount of notes
+        for (int i = 0; i < notesPre.size();i++) {
+            // if a note exists at the time given, and is in the same lane, return that note's value
+            if (notesPre[i].time == time && notesPre[i].lane == lane)
+                return i;
+        }
+        return -1;
+    }
+
+    std::vector<int> findPNoteIdx(double time) {
+        std::vector<int> sameNotes;
+        // if i is smaller than the amount of notes
+        for (int i = 0; i < notesPre.size();i++) {
+            // if a note exists at the time given, and is in the same lane, return that note's value
+            if (notesPre[i].time == time)
+                sameNotes.push_back(i);
+        } if (sameNotes.empty()) {
+            sameNotes.push_back(-1);
+        }
+        return sameNotes;
+    }
+
+    std::vector<forceOnPhrase> forcedOnPhrases;
+	std::vector<tapPhrase> tapPhrases;
+    std::vector<forceOffPhrase> forcedOffPhrases;
+	std::vector<odPhrase> odPhrases;
+    std::vector<solo> Solos;
+	// times of the phrases above, shared by the parser, the judge and the renderer
+	PhraseIndex phrases;
+	void buildPhraseIndex() {
+		phrases.build(odPhrases, Solos, tapPhrases, forcedOnPhrases, forcedOffPhrases);
+	}
+    int resolution = 480;
+	// Walks a track's events once and fills every chart in charts, each of
+	// which must have its diff set. Notes go to the chart whose pitch range
+	// they fall in; OD, solo, tap and force phrases are shared by all of them.
+	// The walk stays in event ticks, seconds come from the tempo map afterwards.
+	static void parseDifficulties(smf::MidiFile& midiFile, const smf::MidiTrackView& events,
+								  std::vector<Chart*>& charts, int instrument, bool plastic) {
+		if (charts.empty())
+			return;
+		// the full time map joins and re-splits the tracks, which would
+		// pull events out from under the walk
+		midiFile.setTempoTimeMap();
+		std::vector<NoteParseState> states(charts.size());
+		PhraseParseState phraseState;
+		Chart& phraseChart = *charts[0];
+		for (Chart* chart : charts) {
+			chart->clearParsedNotes();
+			chart->plastic = plastic;
+			chart->resolution = midiFile.getTicksPerQuarterNote();
+		}
+		// plastic charts only exist for classic guitar and bass
+		if (!plastic || instrument == 5 || instrument == 6) {
+			for (int i = 0; i < events.getSize(); i++) {
+				smf::MidiEventView event = events[i];
+				if (!event.isNoteOn() && !event.isNoteOff())
+					continue;
+				bool claimed = false;
+				for (int c = 0; c < charts.size() && !claimed; c++) {
+					claimed = plastic
+						? charts[c]->parsePlasticNoteEvent(states[c], event, event.tick)
+						: charts[c]->parseNoteEvent(states[c], event, event.tick);
+				}
+				if (!claimed)
+					phraseChart.parsePhraseEvent(phraseState, event, midiFile.getTimeInSeconds(event.tick));
+			}
+		}
+		for (Chart* chart : charts)
+			resolveNoteTimes(plastic ? chart->notesPre : chart->parsedNotes, midiFile);
+		// copy before any chart counts its notes into the phrases
+		for (Chart* chart : charts) {
+			if (chart != &phraseChart) {
+				chart->odPhrases = phraseChart.odPhrases;
+				chart->Solos = phraseChart.Solos;
+				chart->tapPhrases = phraseChart.tapPhrases;
+				chart->forcedOnPhrases = phraseChart.forcedOnPhrases;
+				chart->forcedOffPhrases = phraseChart.forcedOffPhrases;
+			}
+		}
+		for (Chart* chart : charts) {
+			if (plastic)
+				chart->processPlasticNotes(instrument);
+			else
+				chart->processNotes(instrument);
 		}
+	}
+
+	void clearParsedNotes() {
+		notes.clear();
+		noteStates.resize(0);
+		parsedNotes.clear();
+		notesPre.clear();
+		notes_perlane = { {},{},{},{},{} };
+		odPhrases.clear();
+		Solos.clear();
+		tapPhrases.clear();
+		forcedOnPhrases.clear();
+		forcedOffPhrases.clear();
+		phrases.clear();
+		baseScore = 0;
+	}
+
+	void resetNotes() {
+		noteStates.reset();
 		for (odPhrase& phrase : odPhrases) {
 			phrase.missed = false;
 			phrase.notesHit = 0;
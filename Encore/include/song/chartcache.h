@@ -0,0 +1,365 @@
+#pragma once
+#include "song.h"
+#include "chart.h"
+#include "mappedfile.h"
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Compiled charts, one file per MIDI content hash and part under chartCache/,
+// next to songCache.encr. A file holds everything LoadCharts would otherwise
+// parse out of the MIDI: the song's timing and beat lines, and for each valid
+// difficulty its final note arrays, lane indices, phrases and base score.
+//
+// Layout: EnccHeader, then header.sectionCount EnccSection entries, then the
+// section payloads, each 8-byte aligned and an array of count records.
+class ChartCache
+{
+public:
+	// bump when the parser output or any record below changes
+	static constexpr uint16_t revision = 2;
+
+	static std::filesystem::path PathFor(const std::string& midiHash, int part) {
+		return std::filesystem::path("chartCache") / (midiHash + "-" + std::to_string(part) + ".encc");
+	}
+
+	// Fills the song's timing and the valid charts of part from a compiled
+	// file. Returns false, leaving the charts untouched, if there is no file
+	// for this MIDI or it doesn't cover every valid chart.
+	static bool Load(SongSession& song, int part, const std::string& midiHash) {
+		MappedFile file;
+		if (!file.Open(PathFor(midiHash, part).string()))
+			return false;
+		const unsigned char* base = file.Data();
+		size_t size = file.Size();
+		if (size < sizeof(EnccHeader))
+			return false;
+		EnccHeader header;
+		memcpy(&header, base, sizeof(header));
+		if (memcmp(header.magic, "ENCC", 4) != 0 || header.version != CACHE_VERSION
+			|| header.revision != revision || header.part != part
+			|| midiHash.size() != 64 || memcmp(header.midiHash, midiHash.data(), 64) != 0)
+			return false;
+		size_t directoryEnd = sizeof(EnccHeader) + (size_t)header.sectionCount * sizeof(EnccSection);
+		if (directoryEnd > size)
+			return false;
+		const EnccSection* sections = reinterpret_cast<const EnccSection*>(base + sizeof(EnccHeader));
+		for (uint32_t i = 0; i < header.sectionCount; i++) {
+			if (sections[i].offset % 8 != 0 || sections[i].offset > size
+				|| sections[i].count > (size - sections[i].offset) / recordSize(sections[i].type))
+				return false;
+		}
+		Reader reader{ base, sections, header.sectionCount };
+
+		std::vector<Chart*> charts;
+		for (Chart& chart : song.parts[part].charts) {
+			if (!chart.valid)
+				continue;
+			const EnccSection* info = reader.find(SectionChartInfo, chart.diff);
+			if (info == nullptr || info->count != 1)
+				return false;
+			uint64_t noteCount = reader.count(SectionNoteTime, chart.diff);
+			for (uint32_t type = SectionNoteLen; type <= SectionNoteFlags; type++) {
+				if (reader.count((SectionType)type, chart.diff) != noteCount)
+					return false;
+			}
+			charts.push_back(&chart);
+		}
+
+		const EnccSection* timing = reader.find(SectionSongTiming, -1);
+		if (timing == nullptr || timing->count != 1)
+			return false;
+		const CompiledSongTiming* songTiming = reader.records<CompiledSongTiming>(timing);
+		song.music_start = songTiming->musicStart;
+		song.end = songTiming->end;
+		reader.copy(SectionBPMs, -1, song.bpms);
+		reader.copy(SectionTimeSigs, -1, song.timesigs);
+		song.beatLines.clear();
+		if (const EnccSection* beats = reader.find(SectionBeatLines, -1)) {
+			const CompiledBeatLine* lines = reader.records<CompiledBeatLine>(beats);
+			song.beatLines.reserve(beats->count);
+			for (uint64_t i = 0; i < beats->count; i++)
+				song.beatLines.push_back({ lines[i].time, lines[i].major != 0 });
+		}
+
+		for (Chart* chart : charts) {
+			int diff = chart->diff;
+			chart->clearParsedNotes();
+			const CompiledChartInfo* info = reader.records<CompiledChartInfo>(reader.find(SectionChartInfo, diff));
+			chart->plastic = info->plastic != 0;
+			chart->resolution = info->resolution;
+			chart->baseScore = info->baseScore;
+
+			ChartNotes& notes = chart->notes;
+			reader.copy(SectionNoteTime, diff, notes.time);
+			reader.copy(SectionNoteLen, diff, notes.len);
+			reader.copy(SectionNoteBeatsLen, diff, notes.beatsLen);
+			reader.copy(SectionNoteLane, diff, notes.lane);
+			reader.copy(SectionNoteMask, diff, notes.mask);
+			reader.copy(SectionNoteChordSize, diff, notes.chordSize);
+			reader.copy(SectionNoteFlags, diff, notes.flags);
+			chart->noteStates.resize(notes.size());
+			for (int lane = 0; lane < 5; lane++)
+				reader.copy(SectionNotesPerLane, diff * 8 + lane, chart->notes_perlane[lane]);
+			readPhrases(reader, SectionODPhrases, diff, chart->odPhrases);
+			readPhrases(reader, SectionSolos, diff, chart->Solos);
+			readPhrases(reader, SectionTapPhrases, diff, chart->tapPhrases);
+			readPhrases(reader, SectionForceOnPhrases, diff, chart->forcedOnPhrases);
+			readPhrases(reader, SectionForceOffPhrases, diff, chart->forcedOffPhrases);
+			chart->buildPhraseIndex();
+		}
+		return true;
+	}
+
+	// Compiles the song's timing and the valid charts of part. The file is
+	// written next to its final name and renamed over it, so a reader never
+	// sees half of one.
+	static bool Write(const SongSession& song, int part, const std::string& midiHash) {
+		if (midiHash.size() != 64)
+			return false;
+		Writer writer;
+		CompiledSongTiming songTiming{ song.music_start, song.end };
+		writer.add(SectionSongTiming, -1, &songTiming, 1);
+		writer.add(SectionBPMs, -1, song.bpms.data(), song.bpms.size());
+		writer.add(SectionTimeSigs, -1, song.timesigs.data(), song.timesigs.size());
+		std::vector<CompiledBeatLine> beatLines;
+		beatLines.reserve(song.beatLines.size());
+		for (const auto& line : song.beatLines)
+			beatLines.push_back({ line.first, line.second ? 1 : 0, 0 });
+		writer.add(SectionBeatLines, -1, beatLines.data(), beatLines.size());
+
+		for (const Chart& chart : song.parts[part].charts) {
+			if (!chart.valid)
+				continue;
+			int diff = chart.diff;
+			CompiledChartInfo info{ chart.baseScore, chart.resolution, chart.plastic ? 1 : 0, 0 };
+			writer.add(SectionChartInfo, diff, &info, 1);
+			const ChartNotes& notes = chart.notes;
+			writer.add(SectionNoteTime, diff, notes.time.data(), notes.time.size());
+			writer.add(SectionNoteLen, diff, notes.len.data(), notes.len.size());
+			writer.add(SectionNoteBeatsLen, diff, notes.beatsLen.data(), notes.beatsLen.size());
+			writer.add(SectionNoteLane, diff, notes.lane.data(), notes.lane.size());
+			writer.add(SectionNoteMask, diff, notes.mask.data(), notes.mask.size());
+			writer.add(SectionNoteChordSize, diff, notes.chordSize.data(), notes.chordSize.size());
+			writer.add(SectionNoteFlags, diff, notes.flags.data(), notes.flags.size());
+			for (int lane = 0; lane < 5; lane++)
+				writer.add(SectionNotesPerLane, diff * 8 + lane,
+						   chart.notes_perlane[lane].data(), chart.notes_perlane[lane].size());
+			writePhrases(writer, SectionODPhrases, diff, chart.odPhrases);
+			writePhrases(writer, SectionSolos, diff, chart.Solos);
+			writePhrases(writer, SectionTapPhrases, diff, chart.tapPhrases);
+			writePhrases(writer, SectionForceOnPhrases, diff, chart.forcedOnPhrases);
+			writePhrases(writer, SectionForceOffPhrases, diff, chart.forcedOffPhrases);
+		}
+
+		EnccHeader header{};
+		memcpy(header.magic, "ENCC", 4);
+		header.version = CACHE_VERSION;
+		header.revision = revision;
+		memcpy(header.midiHash, midiHash.data(), 64);
+		header.part = part;
+		header.sectionCount = (uint32_t)writer.sections.size();
+		uint64_t payloadStart = sizeof(EnccHeader) + writer.sections.size() * sizeof(EnccSection);
+		for (EnccSection& section : writer.sections)
+			section.offset += payloadStart;
+
+		std::filesystem::path path = PathFor(midiHash, part);
+		std::filesystem::path tempPath = path;
+		tempPath += ".tmp";
+		std::error_code error;
+		std::filesystem::create_directories(path.parent_path(), error);
+		{
+			std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+			out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			out.write(reinterpret_cast<const char*>(writer.sections.data()),
+					  writer.sections.size() * sizeof(EnccSection));
+			out.write(writer.payload.data(), writer.payload.size());
+			if (!out) {
+				std::cout << "ENC: Failed to write compiled chart " << tempPath.string() << std::endl;
+				std::filesystem::remove(tempPath, error);
+				return false;
+			}
+		}
+		std::filesystem::rename(tempPath, path, error);
+		if (error) {
+			std::cout << "ENC: Failed to write compiled chart " << path.string() << std::endl;
+			std::filesystem::remove(tempPath, error);
+			return false;
+		}
+		return true;
+	}
+
+private:
+	enum SectionType : uint32_t {
+		SectionSongTiming,
+		SectionBPMs,
+		SectionTimeSigs,
+		SectionBeatLines,
+		SectionChartInfo,
+		SectionNoteTime,
+		SectionNoteLen,
+		SectionNoteBeatsLen,
+		SectionNoteLane,
+		SectionNoteMask,
+		SectionNoteChordSize,
+		SectionNoteFlags,
+		SectionNotesPerLane,
+		SectionODPhrases,
+		SectionSolos,
+		SectionTapPhrases,
+		SectionForceOnPhrases,
+		SectionForceOffPhrases,
+		SectionTypeCount
+	};
+
+	struct EnccHeader {
+		char magic[4];
+		uint16_t version;
+		uint16_t revision;
+		char midiHash[64];
+		int32_t part;
+		uint32_t sectionCount;
+	};
+
+	struct EnccSection {
+		uint32_t type;
+		// difficulty, diff * 8 + lane for lane indices, -1 for song sections
+		int32_t key;
+		uint64_t offset;
+		uint64_t count;
+	};
+
+	struct CompiledSongTiming {
+		double musicStart;
+		double end;
+	};
+
+	struct CompiledBeatLine {
+		double time;
+		int32_t major;
+		int32_t pad;
+	};
+
+	struct CompiledChartInfo {
+		int32_t baseScore;
+		int32_t resolution;
+		int32_t plastic;
+		int32_t pad;
+	};
+
+	struct CompiledPhrase {
+		double start;
+		double end;
+		int32_t noteCount;
+		int32_t pad;
+	};
+
+	static_assert(std::is_trivially_copyable_v<BPM> && std::is_trivially_copyable_v<TimeSig>);
+	static_assert(sizeof(CompiledPhrase) % 8 == 0);
+
+	static size_t recordSize(uint32_t type) {
+		switch (type) {
+			case SectionSongTiming: return sizeof(CompiledSongTiming);
+			case SectionBPMs: return sizeof(BPM);
+			case SectionTimeSigs: return sizeof(TimeSig);
+			case SectionBeatLines: return sizeof(CompiledBeatLine);
+			case SectionChartInfo: return sizeof(CompiledChartInfo);
+			case SectionNoteTime: return sizeof(double);
+			case SectionNoteLen: return sizeof(double);
+			case SectionNoteBeatsLen: return sizeof(float);
+			case SectionNoteLane: return sizeof(uint8_t);
+			case SectionNoteMask: return sizeof(uint8_t);
+			case SectionNoteChordSize: return sizeof(uint8_t);
+			case SectionNoteFlags: return sizeof(uint16_t);
+			case SectionNotesPerLane: return sizeof(int);
+			default: return sizeof(CompiledPhrase);
+		}
+	}
+
+	struct Writer {
+		std::vector<EnccSection> sections;
+		std::vector<char> payload;
+
+		// offsets are relative to the payload until Write places it
+		template <typename Record>
+		void add(SectionType type, int key, const Record* records, size_t count) {
+			static_assert(std::is_trivially_copyable_v<Record>);
+			if (count == 0)
+				return;
+			payload.resize((payload.size() + 7) & ~(size_t)7);
+			sections.push_back({ type, key, payload.size(), count });
+			const char* bytes = reinterpret_cast<const char*>(records);
+			payload.insert(payload.end(), bytes, bytes + count * sizeof(Record));
+		}
+	};
+
+	struct Reader {
+		const unsigned char* base;
+		const EnccSection* sections;
+		uint32_t sectionCount;
+
+		const EnccSection* find(SectionType type, int key) const {
+			for (uint32_t i = 0; i < sectionCount; i++) {
+				if (sections[i].type == type && sections[i].key == key)
+					return &sections[i];
+			}
+			return nullptr;
+		}
+
+		uint64_t count(SectionType type, int key) const {
+			const EnccSection* section = find(type, key);
+			return section ? section->count : 0;
+		}
+
+		template <typename Record>
+		const Record* records(const EnccSection* section) const {
+			return reinterpret_cast<const Record*>(base + section->offset);
+		}
+
+		// missing sections are empty
+		template <typename Record>
+		void copy(SectionType type, int key, std::vector<Record>& out) const {
+			out.clear();
+			if (const EnccSection* section = find(type, key)) {
+				const Record* first = records<Record>(section);
+				out.assign(first, first + section->count);
+			}
+		}
+	};
+
+	template <typename Phrase>
+	static void writePhrases(Writer& writer, SectionType type, int diff, const std::vector<Phrase>& phrases) {
+		std::vector<CompiledPhrase> compiled;
+		compiled.reserve(phrases.size());
+		for (const Phrase& phrase : phrases) {
+			CompiledPhrase record{ phrase.start, phrase.end, 0, 0 };
+			if constexpr (requires { phrase.noteCount; })
+				record.noteCount = phrase.noteCount;
+			compiled.push_back(record);
+		}
+		writer.add(type, diff, compiled.data(), compiled.size());
+	}
+
+	template <typename Phrase>
+	static void readPhrases(const Reader& reader, SectionType type, int diff, std::vector<Phrase>& phrases) {
+		phrases.clear();
+		const EnccSection* section = reader.find(type, diff);
+		if (section == nullptr)
+			return;
+		const CompiledPhrase* compiled = reader.records<CompiledPhrase>(section);
+		phrases.reserve(section->count);
+		for (uint64_t i = 0; i < section->count; i++) {
+			Phrase phrase;
+			phrase.start = compiled[i].start;
+			phrase.end = compiled[i].end;
+			if constexpr (requires { phrase.noteCount; })
+				phrase.noteCount = compiled[i].noteCount;
+			phrases.push_back(phrase);
+		}
+	}
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <sys/stat.h>
+
+// Size, modification time and inode of a file or folder, from a single stat.
+// If any of them changed, the contents may have changed too. Windows has no
+// inodes, so there the stamp is just size and mtime.
+struct FileStamp {
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    uint64_t inode = 0;
+
+    // a zero stamp if the path can't be stat'ed
+    static FileStamp Of(const std::filesystem::path& path) {
+        FileStamp stamp;
+#ifdef _WIN32
+        struct _stat64 info;
+        if (_wstat64(path.c_str(), &info) != 0)
+            return stamp;
+        stamp.mtime = info.st_mtime;
+#elif defined(__APPLE__)
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0)
+            return stamp;
+        stamp.mtime = (int64_t)info.st_mtimespec.tv_sec * 1000000000 + info.st_mtimespec.tv_nsec;
+        stamp.inode = info.st_ino;
+#else
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0)
+            return stamp;
+        stamp.mtime = (int64_t)info.st_mtim.tv_sec * 1000000000 + info.st_mtim.tv_nsec;
+        stamp.inode = info.st_ino;
+#endif
+        stamp.size = info.st_size;
+        return stamp;
+    }
+
+    bool valid() const {
+        return mtime != 0 || size != 0 || inode != 0;
+    }
+
+    bool operator==(const FileStamp& other) const {
+        return size == other.size && mtime == other.mtime && inode == other.inode;
+    }
+    bool operator!=(const FileStamp& other) const {
+        return !(*this == other);
+    }
+};
@@ -0,0 +1,146 @@
+#pragma once
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+enum PhraseType {
+	PhraseOverdrive,
+	PhraseSolo,
+	PhraseTap,
+	PhraseForceOn,
+	PhraseForceOff,
+	PhraseTypeCount
+};
+
+class PhraseIndex;
+
+// Walks the phrases of one type for times that mostly move forward, like the
+// notes of a frame or the playback position. Each step forward is O(1); a
+// jump back, or far ahead, falls back to a binary search.
+class PhraseCursor
+{
+public:
+	PhraseCursor() = default;
+	PhraseCursor(const std::vector<double>* starts, const std::vector<double>* ends)
+		: starts(starts), ends(ends) {}
+
+	// the phrase with start <= t < end, or with includeEnd start <= t <= end;
+	// -1 if there is none
+	int at(double t, bool includeEnd = false) {
+		if (starts == nullptr || starts->empty())
+			return -1;
+		seek(t);
+		int idx = next;
+		if (!includeEnd && idx < (int)ends->size() && (*ends)[idx] == t)
+			idx++;
+		if (idx < (int)starts->size() && (*starts)[idx] <= t)
+			return idx;
+		return -1;
+	}
+
+private:
+	static constexpr int maxSteps = 4;
+	const std::vector<double>* starts = nullptr;
+	const std::vector<double>* ends = nullptr;
+	// first phrase with end >= lastTime
+	int next = 0;
+	double lastTime = 0.0;
+
+	void seek(double t) {
+		if (t < lastTime) {
+			next = (int)(std::lower_bound(ends->begin(), ends->end(), t) - ends->begin());
+		}
+		else {
+			int steps = 0;
+			while (next < (int)ends->size() && (*ends)[next] < t && steps < maxSteps) {
+				next++;
+				steps++;
+			}
+			if (steps == maxSteps && next < (int)ends->size() && (*ends)[next] < t)
+				next = (int)(std::lower_bound(ends->begin() + next, ends->end(), t) - ends->begin());
+		}
+		lastTime = t;
+	}
+};
+
+// Start and end times of every phrase of a chart, by type, for O(log n)
+// lookups by time. Indices match the chart's phrase vectors, which keep the
+// per-play state. The parser never opens a phrase of a type before closing
+// the last one, so within a type phrases are sorted and don't overlap, and
+// their ends are sorted too.
+class PhraseIndex
+{
+public:
+	template <typename OD, typename Solo, typename Tap, typename ForceOn, typename ForceOff>
+	void build(const std::vector<OD>& odPhrases, const std::vector<Solo>& solos,
+			   const std::vector<Tap>& tapPhrases, const std::vector<ForceOn>& forcedOnPhrases,
+			   const std::vector<ForceOff>& forcedOffPhrases) {
+		fill(PhraseOverdrive, odPhrases);
+		fill(PhraseSolo, solos);
+		fill(PhraseTap, tapPhrases);
+		fill(PhraseForceOn, forcedOnPhrases);
+		fill(PhraseForceOff, forcedOffPhrases);
+	}
+
+	void clear() {
+		for (int type = 0; type < PhraseTypeCount; type++) {
+			starts[type].clear();
+			ends[type].clear();
+		}
+	}
+
+	int count(PhraseType type) const {
+		return (int)starts[type].size();
+	}
+
+	// the phrase of type containing t, or -1. Phrases are [start, end),
+	// or [start, end] with includeEnd
+	int find(PhraseType type, double t, bool includeEnd = false) const {
+		const std::vector<double>& typeEnds = ends[type];
+		auto it = includeEnd ? std::lower_bound(typeEnds.begin(), typeEnds.end(), t)
+							 : std::upper_bound(typeEnds.begin(), typeEnds.end(), t);
+		int idx = (int)(it - typeEnds.begin());
+		if (idx < (int)starts[type].size() && starts[type][idx] <= t)
+			return idx;
+		return -1;
+	}
+
+	// the phrases of type overlapping [t0, t1), as an index range [first, last)
+	std::pair<int, int> overlapping(PhraseType type, double t0, double t1) const {
+		const std::vector<double>& typeStarts = starts[type];
+		const std::vector<double>& typeEnds = ends[type];
+		int first = (int)(std::upper_bound(typeEnds.begin(), typeEnds.end(), t0) - typeEnds.begin());
+		int last = (int)(std::lower_bound(typeStarts.begin(), typeStarts.end(), t1) - typeStarts.begin());
+		return { first, std::max(first, last) };
+	}
+
+	// a bit (1 << type) for every phrase type with a phrase containing t
+	int typesAt(double t) const {
+		int types = 0;
+		for (int type = 0; type < PhraseTypeCount; type++) {
+			if (find((PhraseType)type, t) != -1)
+				types |= 1 << type;
+		}
+		return types;
+	}
+
+	PhraseCursor cursor(PhraseType type) const {
+		return PhraseCursor(&starts[type], &ends[type]);
+	}
+
+private:
+	std::vector<double> starts[PhraseTypeCount];
+	std::vector<double> ends[PhraseTypeCount];
+
+	template <typename Phrase>
+	void fill(PhraseType type, const std::vector<Phrase>& phrases) {
+		starts[type].clear();
+		ends[type].clear();
+		starts[type].reserve(phrases.size());
+		ends[type].reserve(phrases.size());
+		for (const Phrase& phrase : phrases) {
+			starts[type].push_back(phrase.start);
+			ends[type].push_back(phrase.end);
+		}
+	}
+};
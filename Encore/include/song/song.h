@@ -3,13 +3,20 @@
 #include "raylib.h"
 #include "chart.h"
 #include "midifile/MidiFile.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include <iostream>
 #include <fstream>
-#include <unordered_map>
+#include <string_view>
+#include <utility>
 #include <filesystem>
 #include <cmath>
 #include "picosha2.h"
+#include "filestamp.h"
+#include "songstrings.h"
 enum PartIcon {
 	IconDrum,
 	IconBass,
@@ -43,7 +50,6 @@ enum Difficulty {
 
 struct SongPart 
 {
-	int diff = -1;
 	bool hasPart = false;
 	std::vector<Chart> charts;
 };
@@ -58,273 +64,175 @@ struct BPM {
 	double bpm;
 };
 
-class Song 
+// What a song's MIDI has in it, worked out when the song is scanned so that
+// picking a part and difficulty never has to read the MIDI. Only worked out
+// again when the MIDI's contents change.
+struct ChartInfo {
+	static constexpr int partCount = 7;
+	static constexpr int diffCount = 4;
+	// the notes each difficulty is charted on, Easy to Expert
+	static constexpr int diffNotes[diffCount][2] = { {60,64}, {72,76}, {84,88}, {96,100} };
+
+	// bit d is set if the part has notes on difficulty d
+	std::array<uint8_t, partCount> validDiffs{};
+	// notes on each difficulty of each part; chords count each note
+	std::array<std::array<uint16_t, diffCount>, partCount> noteCounts{};
+	double musicStart = 0.0;
+	double end = 0.0;
+	float minBpm = 0;
+	float maxBpm = 0;
+	// sha256 of the MIDI file, and the file as it was when it was hashed
+	std::array<uint8_t, 32> midiHash{};
+	FileStamp midiStamp;
+
+	bool HasPart(int part) const { return validDiffs[part] != 0; }
+	bool Valid(int part, int diff) const { return (validDiffs[part] >> diff & 1) != 0; }
+};
+
+// What the song list keeps for every song: everything read from info.json,
+// and nothing that needs the MIDI, the audio or the GPU. Kept small and cheap
+// to copy, as the list holds one for every song in the library. The text
+// lives in a SongStrings, which has to outlive the song.
+class SongMetadata
 {
 public:
-    std::unordered_map<std::string, PartIcon> stringToEnum = {
-
-            {"Drum",PartIcon::IconDrum},
-            {"Bass",PartIcon::IconBass},
-            {"Guitar",PartIcon::IconGuitar},
-            {"Vocals",PartIcon::IconVocals},
-            {"Keyboard",PartIcon::IconKeyboard},
-            {"None",PartIcon::IconNone},
-            {"",PartIcon::IconNone}
-
-    };
-
-    PartIcon iconFromString(const std::string& str)
-    {
-        auto it = stringToEnum.find(str);
-        if (it != stringToEnum.end())
-        {
-            return it->second;
-        }
-        else
-        {
-            throw std::runtime_error("Invalid enum string");
-        }
-    }
-
-    std::unordered_map<std::string, SongParts> midiNameToEnum = {
-            {"PART DRUMS",SongParts::PartDrums},
-            {"PART BASS",SongParts::PartBass},
-            {"PART GUITAR",SongParts::PartGuitar},
-            {"PART VOCALS",SongParts::PartVocals},
-            {"PLASTIC DRUMS",SongParts::PlasticDrums},
-            {"PLASTIC BASS",SongParts::PlasticBass},
-            {"PLASTIC GUITAR",SongParts::PlasticGuitar}
-    };
+	static constexpr int partCount = 7;
+
+	static constexpr std::pair<std::string_view, PartIcon> iconNames[] = {
+		{ "Drum", PartIcon::IconDrum },
+		{ "Bass", PartIcon::IconBass },
+		{ "Guitar", PartIcon::IconGuitar },
+		{ "Vocals", PartIcon::IconVocals },
+		{ "Keyboard", PartIcon::IconKeyboard },
+		{ "None", PartIcon::IconNone },
+		{ "", PartIcon::IconNone }
+	};
+
+	static PartIcon iconFromString(std::string_view str)
+	{
+		for (const auto& [name, icon] : iconNames) {
+			if (name == str)
+				return icon;
+		}
+		throw std::runtime_error("Invalid enum string");
+	}
 
-    SongParts partFromString(const std::string& str)
-    {
-        auto it = midiNameToEnum.find(str);
-        if (it != midiNameToEnum.end())
-        {
-            return it->second;
-        }
-        else
-        {
-            return SongParts::Invalid;
-        }
-    }
+	static constexpr std::pair<std::string_view, SongParts> midiPartNames[] = {
+		{ "PART DRUMS", SongParts::PartDrums },
+		{ "PART BASS", SongParts::PartBass },
+		{ "PART GUITAR", SongParts::PartGuitar },
+		{ "PART VOCALS", SongParts::PartVocals },
+		{ "PLASTIC DRUMS", SongParts::PlasticDrums },
+		{ "PLASTIC BASS", SongParts::PlasticBass },
+		{ "PLASTIC GUITAR", SongParts::PlasticGuitar }
+	};
+
+	static SongParts partFromString(std::string_view str)
+	{
+		for (const auto& [name, part] : midiPartNames) {
+			if (name == str)
+				return part;
+		}
+		return SongParts::Invalid;
+	}
 
-	bool midiParsed=false;
-	std::string title = "";
+	// the short and long keys of each part in the "diff" object, in part order
+	static constexpr std::pair<std::string_view, std::string_view> diffNames[partCount] = {
+		{ "ds", "drums" },
+		{ "ba", "bass" },
+		{ "gr", "guitar" },
+		{ "vl", "vocals" },
+		{ "pd", "plastic_drums" },
+		{ "pb", "plastic_bass" },
+		{ "pg", "plastic_guitar" }
+	};
+
+	std::string_view title = "";
 	float titleXOffset = 0;
 	float titleTextWidth = 0;
 	double titleScrollTime = 0.0;
-	std::string artist = "";
+	std::string_view artist = "";
 	float artistXOffset = 0;
 	float artistTextWidth = 0;
 	double artistScrollTime = 0.0;
-    Texture albumArtBlur;
-	Texture albumArt;
-	std::string album = "";
+	std::string_view album = "";
+	std::string_view genre = "";
 	int length = 0;
+	int releaseYear = 0;
 
-
-	std::vector<BPM> bpms{};
-	std::vector<TimeSig> timesigs{};
-
-	double music_start=0.0;
-	double end=0.0;
-	std::vector<PartIcon> partIcons{ PartIcon::IconNone,PartIcon::IconNone,PartIcon::IconNone,PartIcon::IconNone };
+	std::array<PartIcon, 4> partIcons{ PartIcon::IconNone,PartIcon::IconNone,PartIcon::IconNone,PartIcon::IconNone };
 	//Parts order will always be Drums, Bass, Guitar, Vocals, Plastic Drums, Plastic Bass, Plastic Guitar
-	std::vector<SongPart*> parts{ new SongPart,new SongPart,new SongPart,new SongPart ,new SongPart ,new SongPart ,new SongPart };
-
-	std::vector<std::pair<double, bool>> beatLines; //double time, bool downbeat
-
-	std::vector<std::pair<std::string, int>> stemsPath{};
-
-	std::filesystem::path midiPath = "";
+	// -1 for parts the song doesn't list a difficulty for
+	std::array<int8_t, partCount> partDiffs{ -1, -1, -1, -1, -1, -1, -1 };
+
+	std::string_view midiPath = "";
+
+	std::string_view songDir = "";
+	std::string_view albumArtPath = "";
+	std::string_view songInfoPath = "";
+	std::string_view loadingPhrase = "";
+	// one per line
+	std::string_view charters = "";
+	std::string_view jsonHash = "";
+	// info.json as it was when jsonHash was taken
+	FileStamp jsonStamp;
+	ChartInfo chartInfo;
+
+	std::string_view FirstCharter() const {
+		return charters.substr(0, charters.find('\n'));
+	}
 
-    std::string songDir = "";
-    std::string albumArtPath = "";
-    std::string songInfoPath = "";
-	int releaseYear = 0;
-	std::string loadingPhrase = "";
-	std::vector<std::string> charters{};
-	std::string jsonHash = "";
-    void LoadAudio(std::filesystem::path jsonPath) {
-        std::ifstream ifs(jsonPath);
-
-        if (!ifs.is_open()) {
-            std::cerr << "Failed to open JSON file." << std::endl;
-        }
-        if (!stemsPath.empty())
-            stemsPath.clear();
-        if (!charters.empty())
-            charters.clear();
-        std::string jsonString((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
-        ifs.close();
-        jsonHash = picosha2::hash256_hex_string(jsonString);
-        rapidjson::Document document;
-        document.Parse(jsonString.c_str());
-        songInfoPath = jsonPath.string();
-        songDir = jsonPath.parent_path().string();
-        if (document.IsObject())
-        {
-            for (auto& item : document.GetObject()) {
-                if (item.name=="stems" && item.value.IsObject())
-                {
-                    for (auto &path : item.value.GetObject())
-                    {
-                        std::string stem = std::string(path.name.GetString());
-                        if (path.value.IsString()) {
-                            if (std::filesystem::exists(jsonPath.parent_path() / path.value.GetString()))
-                            {
-                                if (stem == "drums")
-                                    stemsPath.push_back({ (jsonPath.parent_path() / path.value.GetString()).string(),0 });
-
-                                else if (stem == "bass")
-                                    stemsPath.push_back({ (jsonPath.parent_path() / path.value.GetString()).string(),1 });
-
-                                else if (stem == "lead")
-                                    stemsPath.push_back({ (jsonPath.parent_path() / path.value.GetString()).string(),2 });
-
-                                else if (stem == "vocals")
-                                    stemsPath.push_back({ (jsonPath.parent_path() / path.value.GetString()).string(),3 });
-
-                                else if (stem == "backing")
-                                    stemsPath.push_back({ (jsonPath.parent_path() / path.value.GetString()).string(),4 });
-                            }
-                        }
-                        else if (path.value.IsArray()) {
-                            for (auto& path : path.value.GetArray()) {
-                                if (std::filesystem::exists(jsonPath.parent_path() / path.GetString()))
-                                {
-                                    if (stem == "drums")
-                                        stemsPath.push_back({ (jsonPath.parent_path() / path.GetString()).string(),0 });
-
-                                    else if (stem == "bass")
-                                        stemsPath.push_back({ (jsonPath.parent_path() / path.GetString()).string(),1 });
-
-                                    else if (stem == "lead")
-                                        stemsPath.push_back({ (jsonPath.parent_path() / path.GetString()).string(),2 });
-
-                                    else if (stem == "vocals")
-                                        stemsPath.push_back({ (jsonPath.parent_path() / path.GetString()).string(),3 });
-
-                                    else if (stem == "backing")
-                                        stemsPath.push_back({ (jsonPath.parent_path() / path.GetString()).string(),4 });
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
-        ifs.close();
-    }
-    void LoadInfo(std::filesystem::path jsonPath) {
-        std::ifstream ifs(jsonPath);
+	// points every string at a copy in strings
+	void InternInto(SongStrings& strings) {
+		title = strings.Add(title);
+		artist = strings.Intern(artist);
+		album = strings.Intern(album);
+		genre = strings.Intern(genre);
+		midiPath = strings.Add(midiPath);
+		songDir = strings.Add(songDir);
+		albumArtPath = strings.Add(albumArtPath);
+		songInfoPath = strings.Add(songInfoPath);
+		loadingPhrase = strings.Add(loadingPhrase);
+		charters = strings.Intern(charters);
+		jsonHash = strings.Add(jsonHash);
+	}
 
-        if (!ifs.is_open()) {
-            std::cerr << "Failed to open JSON file." << std::endl;
-        }
-        if (!stemsPath.empty())
-            stemsPath.clear();
-        if (!charters.empty())
-            charters.clear();
-        std::string jsonString((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
-        ifs.close();
-        jsonHash = picosha2::hash256_hex_string(jsonString);
-        rapidjson::Document document;
-        document.Parse(jsonString.c_str());
-        songInfoPath = jsonPath.string();
-        songDir = jsonPath.parent_path().string();
-        for (auto& item : document.GetObject()) {
-            if (item.name == "title" && item.value.IsString())
-                title = item.value.GetString();
-            if (item.name == "artist" && item.value.IsString())
-                artist = item.value.GetString();
-            if (item.name == "album" && item.value.IsString())
-                album = item.value.GetString();
-            if (item.name == "length" && item.value.IsInt())
-                length = item.value.GetInt();
-            if (item.name == "release_year" && item.value.IsInt())
-                releaseYear = item.value.GetInt();
-            if (item.name == "loading_phrase" && item.value.IsString())
-                loadingPhrase = item.value.GetString();
-            if ((item.name == "sid" || item.name == "icon_drums") && item.value.IsString())
-                partIcons[0] = iconFromString(item.value.GetString());
-            if ((item.name == "sib" || item.name == "icon_bass") && item.value.IsString())
-                partIcons[1] = iconFromString(item.value.GetString());
-            if ((item.name == "sig" || item.name == "icon_guitar") && item.value.IsString())
-                partIcons[2] = iconFromString(item.value.GetString());
-            if ((item.name == "siv" || item.name == "icon_vocals") && item.value.IsString())
-                partIcons[3] = iconFromString(item.value.GetString());
-            if (item.name == "midi" && item.value.IsString())
-                midiPath = jsonPath.parent_path() / item.value.GetString();
-            if (item.name == "art" && item.value.IsString()) {
-                albumArtPath = (jsonPath.parent_path() / item.value.GetString()).string();
-            }
-            if (item.name == "diff" && item.value.IsObject()) {
-                for (auto &diff: item.value.GetObject()) {
-                    std::string part = std::string(diff.name.GetString());
-                    if (diff.value.IsInt()) {
-                        if (part == "ds" || part == "drums") {
-                            parts[0]->diff = diff.value.GetInt();
-                        } else if (part == "ba" || part == "bass") {
-                            parts[1]->diff = diff.value.GetInt();
-                        } else if (part == "gr" || part == "guitar") {
-                            parts[2]->diff = diff.value.GetInt();
-                        } else if (part == "vl" || part == "vocals") {
-                            parts[3]->diff = diff.value.GetInt();
-                        } else if (part == "pd" || part == "plastic_drums") {
-                            parts[4]->diff = diff.value.GetInt();
-                        } else if (part == "pb" || part == "plastic_bass") {
-                            parts[5]->diff = diff.value.GetInt();
-                        } else if (part == "pg" || part == "plastic_guitar") {
-                            parts[6]->diff = diff.value.GetInt();
-                        }
-                    }
-                }
-            }
-            if (item.name == "charters" && item.value.IsObject()) {
-                for(auto& charter:item.value.GetObject()){
-                    if (charter.value.IsString()) {
-                        charters.push_back(charter.value.GetString());
-                    }
-                }
-            }
-        }
-        ifs.close();
-    }
-	void LoadSong(std::filesystem::path jsonPath) 
+	void LoadSong(std::filesystem::path jsonPath, SongStrings& strings)
 	{
+		jsonStamp = FileStamp::Of(jsonPath);
 		std::ifstream ifs(jsonPath);
 
 		if (!ifs.is_open()) {
 			std::cerr << "Failed to open JSON file." << std::endl;
 		}
-        if (!stemsPath.empty())
-            stemsPath.clear();
-        if (!charters.empty())
-            charters.clear();
 		std::string jsonString((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
 		ifs.close();
-		jsonHash = picosha2::hash256_hex_string(jsonString);
+		jsonHash = strings.Add(picosha2::hash256_hex_string(jsonString));
 		rapidjson::Document document;
 		document.Parse(jsonString.c_str());
-        songInfoPath = jsonPath.string();
-        songDir = jsonPath.parent_path().string();
-		if (document.IsObject()) 
+		songInfoPath = strings.Add(jsonPath.string());
+		songDir = strings.Add(jsonPath.parent_path().string());
+		std::string charterLines;
+		auto text = [](const rapidjson::Value& value) {
+			return std::string_view(value.GetString(), value.GetStringLength());
+		};
+		if (document.IsObject())
 		{
 			for (auto& item : document.GetObject()) {
 				if (item.name == "title" && item.value.IsString())
-					title = item.value.GetString();
+					title = strings.Add(text(item.value));
 				if (item.name == "artist" && item.value.IsString())
-					artist = item.value.GetString();
+					artist = strings.Intern(text(item.value));
 				if (item.name == "album" && item.value.IsString())
-					album = item.value.GetString();
+					album = strings.Intern(text(item.value));
+				if (item.name == "genre" && item.value.IsString())
+					genre = strings.Intern(text(item.value));
 				if (item.name == "length" && item.value.IsInt())
 					length = item.value.GetInt();
 				if (item.name == "release_year" && item.value.IsInt())
 					releaseYear = item.value.GetInt();
 				if (item.name == "loading_phrase" && item.value.IsString())
-					loadingPhrase = item.value.GetString();
+					loadingPhrase = strings.Add(text(item.value));
 				if ((item.name=="sid" || item.name=="icon_drums") && item.value.IsString())
 					partIcons[0] = iconFromString(item.value.GetString());
 				if ((item.name == "sib" || item.name == "icon_bass") && item.value.IsString())
@@ -334,47 +242,168 @@ public:
 				if ((item.name == "siv" || item.name == "icon_vocals") && item.value.IsString())
 					partIcons[3] = iconFromString(item.value.GetString());
 				if (item.name == "midi" && item.value.IsString())
-					midiPath = jsonPath.parent_path() / item.value.GetString();
+					midiPath = strings.Add((jsonPath.parent_path() / item.value.GetString()).string());
 				if (item.name == "art" && item.value.IsString()) {
-					albumArtPath = (jsonPath.parent_path() / item.value.GetString()).string();
+					albumArtPath = strings.Add((jsonPath.parent_path() / item.value.GetString()).string());
 				}
 				if (item.name=="diff" && item.value.IsObject())
 				{
 					for (auto& diff:item.value.GetObject())
 					{
-						std::string part = std::string(diff.name.GetString());
-						if (diff.value.IsInt()) {
-							if (part == "ds" || part == "drums")
-							{
-								parts[0]->diff = diff.value.GetInt();
-							}
-							else if (part == "ba" || part == "bass")
-							{
-								parts[1]->diff = diff.value.GetInt();
-							}
-							else if (part == "gr" || part == "guitar")
-							{
-								parts[2]->diff = diff.value.GetInt();
-							}
-							else if (part == "vl" || part == "vocals")
-							{
-								parts[3]->diff = diff.value.GetInt();
-							}
-							else if (part == "pd" || part == "plastic_drums")
-							{
-								parts[4]->diff = diff.value.GetInt();
-							}
-							else if (part == "pb" || part == "plastic_bass")
-							{
-								parts[5]->diff = diff.value.GetInt();
-							}
-							else if (part == "pg" || part == "plastic_guitar")
-							{
-								parts[6]->diff = diff.value.GetInt();
-							}
+						std::string_view part(diff.name.GetString(), diff.name.GetStringLength());
+						if (!diff.value.IsInt())
+							continue;
+						for (int i = 0; i < partCount; i++) {
+							if (part == diffNames[i].first || part == diffNames[i].second)
+								partDiffs[i] = (int8_t)diff.value.GetInt();
+						}
+					}
+				}
+				if (item.name == "charters" && item.value.IsObject()) {
+					for(auto& charter:item.value.GetObject()){
+						if (charter.value.IsString()) {
+							if (!charterLines.empty())
+								charterLines += '\n';
+							charterLines += text(charter.value);
 						}
 					}
 				}
+			}
+		}
+		charters = strings.Intern(charterLines);
+	}
+
+	// reads the MIDI into chartInfo if it changed since chartInfo was worked
+	// out; true if chartInfo changed
+	bool LoadChartInfo() {
+		std::filesystem::path path(midiPath);
+		FileStamp stamp = FileStamp::Of(path);
+		if (stamp == chartInfo.midiStamp)
+			return false;
+		std::ifstream midiIn(path, std::ios::binary);
+		std::vector<smf::uchar> midiBytes((std::istreambuf_iterator<char>(midiIn)), std::istreambuf_iterator<char>());
+		midiIn.close();
+		std::array<uint8_t, 32> midiHash;
+		picosha2::hash256(midiBytes.begin(), midiBytes.end(), midiHash.begin(), midiHash.end());
+		chartInfo.midiStamp = stamp;
+		if (midiHash == chartInfo.midiHash)
+			return true;
+
+		ChartInfo info;
+		info.midiHash = midiHash;
+		info.midiStamp = stamp;
+		smf::MidiFile midiFile;
+		if (midiBytes.empty() || !midiFile.readPacked(std::move(midiBytes), false)) {
+			chartInfo = info;
+			return true;
+		}
+		midiFile.decodeTrack(0);
+		smf::MidiTrackView tempos = midiFile.getTrackView(0);
+		for (int i = 0; i < tempos.getSize(); i++) {
+			if (!tempos[i].isTempo())
+				continue;
+			float bpm = (float)tempos[i].getTempoBPM();
+			info.minBpm = info.minBpm == 0 ? bpm : std::min(info.minBpm, bpm);
+			info.maxBpm = std::max(info.maxBpm, bpm);
+		}
+		for (int track = 0; track < midiFile.getTrackCount(); track++) {
+			std::string trackName = midiFile.getTrackName(track);
+			SongParts part = partFromString(trackName);
+			if (trackName == "EVENTS") {
+				midiFile.decodeTrack(track);
+				smf::MidiTrackView events = midiFile.getTrackView(track);
+				for (int i = 0; i < events.getSize(); i++) {
+					smf::MidiEventView event = events[i];
+					if (!event.isMeta() || (int)event[1] != 1)
+						continue;
+					std::string text;
+					for (int k = 3; k < event.getSize(); k++)
+						text += event[k];
+					if (text == "[music_start]")
+						info.musicStart = midiFile.getTimeInSeconds(event.tick);
+					else if (text == "[end]")
+						info.end = midiFile.getTimeInSeconds(event.tick);
+				}
+			} else if (part != SongParts::Invalid && part != SongParts::PlasticDrums) {
+				midiFile.decodeTrack(track);
+				smf::MidiTrackView events = midiFile.getTrackView(track);
+				for (int i = 0; i < events.getSize(); i++) {
+					if (!events[i].isNoteOn() || events[i].isMeta())
+						continue;
+					int note = (int)events[i][1];
+					for (int diff = 0; diff < ChartInfo::diffCount; diff++) {
+						if (note < ChartInfo::diffNotes[diff][0] || note > ChartInfo::diffNotes[diff][1])
+							continue;
+						info.validDiffs[part] |= 1 << diff;
+						uint16_t& count = info.noteCounts[part][diff];
+						if (count < UINT16_MAX)
+							count++;
+					}
+				}
+			}
+		}
+		chartInfo = info;
+		return true;
+	}
+};
+
+// The song being played, or previewed in the menus: its metadata plus what
+// gets loaded for it on demand, the stems, the MIDI timing and charts, and
+// the album art. Made from the song list's metadata when it is needed, and
+// owned by whoever is playing it rather than the list.
+class SongSession : public SongMetadata
+{
+public:
+	SongSession() = default;
+	// copies the song's text, so the session outlives the list it came from.
+	// Every part gets a chart per difficulty, with no notes yet, marked valid
+	// where chartInfo says there are some
+	explicit SongSession(const SongMetadata& metadata)
+		: SongMetadata(metadata), strings(std::make_shared<SongStrings>()) {
+		InternInto(*strings);
+		music_start = chartInfo.musicStart;
+		end = chartInfo.end;
+		for (int part = 0; part < partCount; part++) {
+			parts[part].hasPart = chartInfo.HasPart(part);
+			parts[part].charts.resize(ChartInfo::diffCount);
+			for (int diff = 0; diff < ChartInfo::diffCount; diff++) {
+				parts[part].charts[diff].valid = chartInfo.Valid(part, diff);
+				parts[part].charts[diff].diff = diff;
+			}
+		}
+	}
+
+	std::shared_ptr<SongStrings> strings;
+
+	Texture albumArtBlur;
+	Texture albumArt;
+
+	std::vector<BPM> bpms{};
+	std::vector<TimeSig> timesigs{};
+
+	double music_start=0.0;
+	double end=0.0;
+	//Parts order will always be Drums, Bass, Guitar, Vocals, Plastic Drums, Plastic Bass, Plastic Guitar
+	std::array<SongPart, partCount> parts{};
+
+	std::vector<std::pair<double, bool>> beatLines; //double time, bool downbeat
+
+	std::vector<std::pair<std::string, int>> stemsPath{};
+
+	void LoadAudio(std::filesystem::path jsonPath) {
+		std::ifstream ifs(jsonPath);
+
+		if (!ifs.is_open()) {
+			std::cerr << "Failed to open JSON file." << std::endl;
+		}
+		stemsPath.clear();
+		std::string jsonString((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+		ifs.close();
+		rapidjson::Document document;
+		document.Parse(jsonString.c_str());
+		if (document.IsObject())
+		{
+			for (auto& item : document.GetObject()) {
 				if (item.name=="stems" && item.value.IsObject())
 				{
 					for (auto &path : item.value.GetObject())
@@ -422,35 +451,37 @@ public:
 						}
 					}
 				}
-				if (item.name == "charters" && item.value.IsObject()) {
-					for(auto& charter:item.value.GetObject()){
-						if (charter.value.IsString()) {
-							charters.push_back(charter.value.GetString());
-						}
-					}
-				}
 			}
 		}
-		ifs.close();
 	}
-	void parseBeatLines(smf::MidiFile& midiFile, int trkidx, smf::MidiEventList events) {
+	void parseBeatLines(smf::MidiFile& midiFile, const smf::MidiTrackView& events) {
+		std::vector<int> ticks;
+		std::vector<bool> major;
 		for (int i = 0; i < events.getSize(); i++) {
 			if (events[i].isNoteOn()) {
-				beatLines.push_back({ midiFile.getTimeInSeconds(trkidx, i) , (int)events[i][1] == 12 });
+				ticks.push_back(events[i].tick);
+				major.push_back((int)events[i][1] == 12);
 			}
 		}
+		std::vector<double> seconds;
+		midiFile.getTimesInSeconds(ticks, seconds);
+		beatLines.reserve(beatLines.size() + ticks.size());
+		for (int i = 0; i < ticks.size(); i++) {
+			beatLines.push_back({ seconds[i], major[i] });
+		}
 	}
-	void getTiming(smf::MidiFile& midiFile, int trkidx, smf::MidiEventList events) {
+	void getTiming(smf::MidiFile& midiFile, const smf::MidiTrackView& events) {
 		for (int i = 0; i < events.getSize(); i++) {
-			if (events[i].isTempo()) {
-				bpms.push_back({ midiFile.getTimeInSeconds(trkidx, i) , events[i].getTempoBPM() });
-				std::cout << "BPM @" << midiFile.getTimeInSeconds(trkidx, i) << ": " << events[i].getTempoBPM() << std::endl;
+			smf::MidiEventView event = events[i];
+			if (event.isTempo()) {
+				bpms.push_back({ midiFile.getTimeInSeconds(event.tick) , event.getTempoBPM() });
+				std::cout << "BPM @" << midiFile.getTimeInSeconds(event.tick) << ": " << event.getTempoBPM() << std::endl;
 			}
-			else if (events[i].isMeta() && events[i][1] == 0x58) {
-				int numer = (int)events[i][3];
-				int denom = pow(2,(int)events[i][4]);
-				timesigs.push_back({ midiFile.getTimeInSeconds(trkidx, i), numer,denom });
-				std::cout << "TIMESIG @" << midiFile.getTimeInSeconds(trkidx, i) << ": " << numer <<"/"<<denom<< std::endl;
+			else if (event.isMeta() && event[1] == 0x58) {
+				int numer = (int)event[3];
+				int denom = pow(2,(int)event[4]);
+				timesigs.push_back({ midiFile.getTimeInSeconds(event.tick), numer,denom });
+				std::cout << "TIMESIG @" << midiFile.getTimeInSeconds(event.tick) << ": " << numer <<"/"<<denom<< std::endl;
 			}
 		}
 		if (timesigs.size() == 0) {
@@ -458,15 +489,16 @@ public:
 		}
 	}
 
-	void getStartEnd(smf::MidiFile& midiFile, int trkidx, smf::MidiEventList events) {
+	void getStartEnd(smf::MidiFile& midiFile, const smf::MidiTrackView& events) {
 		for (int i = 0; i < events.getSize(); i++) {
-			if (events[i].isMeta() && (int)events[i][1] == 1) {
-				double time = midiFile.getTimeInSeconds(trkidx, i);
+			smf::MidiEventView event = events[i];
+			if (event.isMeta() && (int)event[1] == 1) {
+				double time = midiFile.getTimeInSeconds(event.tick);
 				std::string evt_string = "";
-				for (int k = 3; k < events[i].getSize(); k++) {
-					evt_string += events[i][k];
+				for (int k = 3; k < event.getSize(); k++) {
+					evt_string += event[k];
 				}
-				std::cout << evt_string << events[i].tick << std::endl;
+				std::cout << evt_string << event.tick << std::endl;
 				if (evt_string == "[music_start]")
 					music_start = time;
 
@@ -476,8 +508,9 @@ public:
 		}
 	}
 
-    void LoadAlbumArt(std::string artpath) {
-        Image albumImage = LoadImage(artpath.c_str());
+    // artpath has to end in a null, as every path in a song does
+    void LoadAlbumArt(std::string_view artpath) {
+        Image albumImage = LoadImage(artpath.data());
         if (albumImage.height > 512) {
             ImageResize(&albumImage, 512, 512);
         }
@@ -0,0 +1,735 @@
+#pragma once
+#include "song.h"
+#include "filestamp.h"
+#include "mappedfile.h"
+#include "songstrings.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// An integer stored as little-endian bytes, so the cache reads the same on
+// every platform and records need no alignment or padding.
+template <typename T>
+struct LittleEndian {
+	unsigned char bytes[sizeof(T)];
+
+	T get() const {
+		std::make_unsigned_t<T> value = 0;
+		for (int i = sizeof(T) - 1; i >= 0; i--)
+			value = (value << 8) | bytes[i];
+		return (T)value;
+	}
+
+	void set(T value) {
+		std::make_unsigned_t<T> bits = (std::make_unsigned_t<T>)value;
+		for (int i = 0; i < (int)sizeof(T); i++) {
+			bytes[i] = (unsigned char)(bits & 0xff);
+			bits >>= 8;
+		}
+	}
+};
+
+// The song cache: an immutable base segment, read in place through a memory
+// mapping, plus an append-only journal of what changed since it was written.
+//
+// Base layout: SongCacheHeader, header.songCount SongRecords,
+// header.folderCount FolderRecords, then header.stringsSize bytes of string
+// table. Strings are (offset, length) pairs into the table, which holds each
+// distinct string once, followed by a null. Opening only checks the header,
+// which carries its own FNV-1a hash, and the folders; each song record
+// carries the hash of its fields and strings, and is checked the first time
+// it is read, so opening doesn't grow with the library. The header also
+// holds the hash of the whole body as written, which names the base for
+// its journal.
+//
+// Journal layout: JournalHeader, naming the base it applies to by its hash,
+// then entries that add or replace a song, remove a song by its folder, or
+// restamp a library folder. Each entry carries its own strings and hash, so
+// a write cut short only loses the entries it didn't finish. Compact folds
+// the journal into a new base.
+class SongCache
+{
+public:
+	// opens the base at basePath with the journal at journalPath applied, if
+	// there is one for this base
+	bool Open(const std::string& basePath, const std::string& journalPath = "") {
+		Close();
+		if (!file.Open(basePath))
+			return false;
+		const unsigned char* base = file.Data();
+		size_t size = file.Size();
+		if (size < sizeof(SongCacheHeader))
+			return Fail();
+		SongCacheHeader header;
+		memcpy(&header, base, sizeof(header));
+		if (memcmp(header.magic, "ENCORE", 6) != 0 || header.version.get() != CACHE_VERSION
+			|| header.headerChecksum.get() != Checksum(base, offsetof(SongCacheHeader, headerChecksum)))
+			return Fail();
+		uint64_t songCount = header.songCount.get();
+		uint64_t folderCount = header.folderCount.get();
+		uint64_t stringsSize = header.stringsSize.get();
+		uint64_t bodySize = sizeof(SongCacheHeader) + songCount * sizeof(SongRecord)
+						  + folderCount * sizeof(FolderRecord) + stringsSize;
+		if (bodySize != size)
+			return Fail();
+		baseChecksum = header.baseChecksum.get();
+		const SongRecord* songRecords = reinterpret_cast<const SongRecord*>(base + sizeof(SongCacheHeader));
+		const FolderRecord* folderRecords = reinterpret_cast<const FolderRecord*>(songRecords + songCount);
+		const char* strings = reinterpret_cast<const char*>(folderRecords + folderCount);
+		songs.resize(songCount);
+		for (uint64_t i = 0; i < songCount; i++)
+			songs[i] = { &songRecords[i], strings, stringsSize };
+		// there are only ever a few folders, and every one is needed
+		for (uint64_t i = 0; i < folderCount; i++) {
+			FolderEntry folder{ &folderRecords[i], strings };
+			if (!InStrings(folder.record->path, strings, stringsSize)
+				|| folder.record->checksum.get() != RecordChecksum(*folder.record, strings))
+				return Fail();
+			folders.push_back(folder);
+		}
+		this->journalPath = journalPath;
+		if (!journalPath.empty())
+			ReadJournal();
+		return true;
+	}
+
+	void Close() {
+		file.Close();
+		copiedInto = nullptr;
+		copies.clear();
+		songs.clear();
+		folders.clear();
+		journal.clear();
+		journalSize = 0;
+	}
+
+	int SongCount() const { return (int)songs.size(); }
+	int FolderCount() const { return (int)folders.size(); }
+	size_t BaseSize() const { return file.Size(); }
+	size_t JournalSize() const { return journalSize; }
+
+	// whether a song's record is whole, checked the first time it's asked;
+	// nothing else about a song can be read unless it is
+	bool SongValid(int song) const {
+		const SongEntry& entry = songs[song];
+		if (entry.state == Unchecked) {
+			bool valid = InStrings(*entry.record, entry.strings, entry.stringsSize)
+						 && entry.record->checksum.get() == RecordChecksum(*entry.record, entry.strings);
+			entry.state = valid ? Valid : Invalid;
+		}
+		return entry.state == Valid;
+	}
+
+	std::string_view SongDir(int song) const { return String(songs[song], songs[song].record->songDir); }
+	std::string_view SongInfoPath(int song) const { return String(songs[song], songs[song].record->songInfoPath); }
+	FileStamp JsonStamp(int song) const { return ToStamp(songs[song].record->jsonStamp); }
+	std::string_view FolderPath(int folder) const { return String(folders[folder], folders[folder].record->path); }
+	FileStamp FolderStamp(int folder) const { return ToStamp(folders[folder].record->stamp); }
+
+	// fills in everything the song list knows about a song without its
+	// info.json. The song's text is left pointing into a copy of the
+	// string table it came from, made in strings the first time a song
+	// from that table is loaded, rather than copied string by string
+	void LoadSong(int index, SongMetadata& song, SongStrings& strings) const {
+		const SongEntry& entry = songs[index];
+		const SongRecord& record = *entry.record;
+		SongEntry copied = entry;
+		copied.strings = CopiedStrings(entry, strings);
+		song.title = String(copied, record.title);
+		song.artist = String(copied, record.artist);
+		song.album = String(copied, record.album);
+		song.songDir = String(copied, record.songDir);
+		song.albumArtPath = String(copied, record.albumArtPath);
+		song.songInfoPath = String(copied, record.songInfoPath);
+		song.midiPath = String(copied, record.midiPath);
+		song.genre = String(copied, record.genre);
+		song.charters = String(copied, record.charters);
+		song.length = record.length.get();
+		song.releaseYear = record.releaseYear.get();
+		for (int part = 0; part < partCount; part++)
+			song.partDiffs[part] = (int8_t)record.diffs[part];
+		static const char hex[] = "0123456789abcdef";
+		char jsonHash[64];
+		for (int i = 0; i < 32; i++) {
+			jsonHash[i * 2] = hex[record.jsonHash[i] >> 4];
+			jsonHash[i * 2 + 1] = hex[record.jsonHash[i] & 0xf];
+		}
+		song.jsonHash = strings.Add(std::string_view(jsonHash, sizeof(jsonHash)));
+		song.jsonStamp = ToStamp(record.jsonStamp);
+		ChartInfo& info = song.chartInfo;
+		for (int part = 0; part < partCount; part++) {
+			info.validDiffs[part] = record.validDiffs[part];
+			for (int diff = 0; diff < ChartInfo::diffCount; diff++)
+				info.noteCounts[part][diff] = record.noteCounts[part][diff].get();
+		}
+		info.musicStart = std::bit_cast<double>(record.musicStart.get());
+		info.end = std::bit_cast<double>(record.end.get());
+		info.minBpm = std::bit_cast<float>(record.minBpm.get());
+		info.maxBpm = std::bit_cast<float>(record.maxBpm.get());
+		memcpy(info.midiHash.data(), record.midiHash, sizeof(record.midiHash));
+		info.midiStamp = ToStamp(record.midiStamp);
+	}
+
+	// Appends changes to the journal, starting a new one if there is none for
+	// the open base. Folder stamps go last, so a library folder is only marked
+	// unchanged once the songs found in it are on disk.
+	bool Append(const std::vector<const SongMetadata*>& changedSongs, const std::vector<std::string>& removedSongDirs,
+				const std::vector<std::filesystem::path>& songsFolder, const std::vector<FileStamp>& folderStamps) {
+		if (!file.IsOpen() || journalPath.empty())
+			return false;
+		std::vector<unsigned char> bytes;
+		if (journalSize == 0) {
+			JournalHeader header;
+			memcpy(header.magic, "ENCJ", 4);
+			header.version.set(CACHE_VERSION);
+			header.pad.set(0);
+			header.baseChecksum.set(baseChecksum);
+			AppendBytes(bytes, &header, sizeof(header));
+		}
+		for (const SongMetadata* song : changedSongs) {
+			StringTable table;
+			SongRecord record = ToRecord(*song, table);
+			record.checksum.set(RecordChecksum(record, table.bytes.data()));
+			AppendEntry(bytes, JournalPutSong, &record, sizeof(record), table.bytes);
+		}
+		for (const std::string& songDir : removedSongDirs) {
+			std::vector<char> dir(songDir.begin(), songDir.end());
+			AppendEntry(bytes, JournalRemoveSong, nullptr, 0, dir);
+		}
+		for (size_t i = 0; i < songsFolder.size(); i++) {
+			StringTable table;
+			FolderRecord record;
+			record.path = table.add(songsFolder[i].string());
+			record.stamp = FromStamp(folderStamps[i]);
+			record.checksum.set(RecordChecksum(record, table.bytes.data()));
+			AppendEntry(bytes, JournalPutFolder, &record, sizeof(record), table.bytes);
+		}
+
+		std::error_code error;
+		if (journalSize > 0) {
+			// drop anything left after the last whole entry
+			std::filesystem::resize_file(journalPath, journalSize, error);
+			if (error)
+				return false;
+		}
+		std::ofstream out(journalPath, std::ios::binary | (journalSize == 0 ? std::ios::trunc : std::ios::app));
+		out.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+		out.flush();
+		if (!out)
+			return false;
+		journalSize += bytes.size();
+		return true;
+	}
+
+	// writes to a temporary file and renames it over path, so a failed write
+	// leaves the old cache in place
+	static bool Write(const std::string& path, const std::vector<SongMetadata>& songList,
+					  const std::vector<std::filesystem::path>& songsFolder,
+					  const std::vector<FileStamp>& folderStamps) {
+		std::vector<std::pair<std::string, FileStamp>> folderList;
+		for (size_t i = 0; i < songsFolder.size(); i++)
+			folderList.emplace_back(songsFolder[i].string(), folderStamps[i]);
+		return WriteBase(path, songList.size(), [&songList](size_t i, StringTable& table) {
+			return ToRecord(songList[i], table);
+		}, folderList);
+	}
+
+	// Writes the base and journal out as a new base and removes the journal.
+	// A crash before the journal is gone leaves it naming the old base, so it
+	// is ignored.
+	static bool Compact(const std::string& basePath, const std::string& journalPath) {
+		std::string tempPath = basePath + ".compact";
+		{
+			SongCache cache;
+			if (!cache.Open(basePath, journalPath))
+				return false;
+			for (int i = 0; i < cache.SongCount(); i++) {
+				if (!cache.SongValid(i))
+					return false;
+			}
+			std::vector<std::pair<std::string, FileStamp>> folderList;
+			for (int i = 0; i < cache.FolderCount(); i++)
+				folderList.emplace_back(std::string(cache.FolderPath(i)), cache.FolderStamp(i));
+			bool written = WriteBase(tempPath, cache.songs.size(), [&cache](size_t i, StringTable& table) {
+				return CopyRecord(cache.songs[i], table);
+			}, folderList);
+			if (!written)
+				return false;
+		}
+		std::error_code error;
+		std::filesystem::rename(tempPath, basePath, error);
+		if (error) {
+			std::filesystem::remove(tempPath, error);
+			return false;
+		}
+		std::filesystem::remove(journalPath, error);
+		return true;
+	}
+
+private:
+	static constexpr int partCount = 7;
+
+	struct StringRef {
+		LittleEndian<uint32_t> offset;
+		LittleEndian<uint32_t> length;
+	};
+
+	struct StampRecord {
+		LittleEndian<uint64_t> size;
+		LittleEndian<int64_t> mtime;
+		LittleEndian<uint64_t> inode;
+	};
+
+	struct SongCacheHeader {
+		char magic[6];
+		LittleEndian<uint16_t> version;
+		LittleEndian<uint32_t> songCount;
+		LittleEndian<uint32_t> folderCount;
+		LittleEndian<uint64_t> stringsSize;
+		// of everything after the header, as it was written
+		LittleEndian<uint64_t> baseChecksum;
+		// of the header up to here
+		LittleEndian<uint64_t> headerChecksum;
+	};
+
+	struct SongRecord {
+		StringRef title;
+		StringRef artist;
+		StringRef album;
+		StringRef songDir;
+		StringRef albumArtPath;
+		StringRef songInfoPath;
+		StringRef midiPath;
+		StringRef genre;
+		// one per line
+		StringRef charters;
+		LittleEndian<int32_t> length;
+		LittleEndian<int32_t> releaseYear;
+		// SongPart::diff for each part, -1 for none
+		uint8_t diffs[partCount];
+		uint8_t pad;
+		uint8_t jsonHash[32];
+		StampRecord jsonStamp;
+		// ChartInfo, so the MIDI isn't read until a chart is loaded
+		uint8_t validDiffs[partCount];
+		uint8_t pad2;
+		LittleEndian<uint16_t> noteCounts[partCount][ChartInfo::diffCount];
+		// doubles and floats by their bits
+		LittleEndian<uint64_t> musicStart;
+		LittleEndian<uint64_t> end;
+		LittleEndian<uint32_t> minBpm;
+		LittleEndian<uint32_t> maxBpm;
+		uint8_t midiHash[32];
+		StampRecord midiStamp;
+		// of the record up to here and then its strings, in order
+		LittleEndian<uint64_t> checksum;
+	};
+
+	struct FolderRecord {
+		StringRef path;
+		StampRecord stamp;
+		LittleEndian<uint64_t> checksum;
+	};
+
+	enum JournalEntryType : uint32_t {
+		// SongRecord, then its strings
+		JournalPutSong,
+		// the song folder
+		JournalRemoveSong,
+		// FolderRecord, then its strings
+		JournalPutFolder
+	};
+
+	struct JournalHeader {
+		char magic[4];
+		LittleEndian<uint16_t> version;
+		LittleEndian<uint16_t> pad;
+		LittleEndian<uint64_t> baseChecksum;
+	};
+
+	// followed by size bytes of payload and the hash of the header and payload
+	struct JournalEntryHeader {
+		LittleEndian<uint32_t> type;
+		LittleEndian<uint32_t> size;
+	};
+
+	static_assert(alignof(SongRecord) == 1 && alignof(FolderRecord) == 1 && alignof(SongCacheHeader) == 1);
+	static_assert(sizeof(SongCacheHeader) == 40 && sizeof(SongRecord) == 296 && sizeof(FolderRecord) == 40);
+	static_assert(sizeof(JournalHeader) == 16 && sizeof(JournalEntryHeader) == 8);
+
+	struct StringTable {
+		std::vector<char> bytes;
+		std::unordered_map<std::string, uint32_t> offsets;
+
+		StringRef add(std::string_view str) {
+			auto [it, inserted] = offsets.try_emplace(std::string(str), (uint32_t)bytes.size());
+			if (inserted) {
+				bytes.insert(bytes.end(), str.begin(), str.end());
+				bytes.push_back('\0');
+			}
+			StringRef ref;
+			ref.offset.set(it->second);
+			ref.length.set((uint32_t)str.size());
+			return ref;
+		}
+	};
+
+	enum RecordState : int8_t {
+		Unchecked,
+		Valid,
+		Invalid
+	};
+
+	// a record in the base or the journal, and the strings its offsets are into
+	struct SongEntry {
+		const SongRecord* record;
+		const char* strings;
+		uint64_t stringsSize;
+		mutable RecordState state = Unchecked;
+	};
+
+	struct FolderEntry {
+		const FolderRecord* record;
+		const char* strings;
+	};
+
+	MappedFile file;
+	uint64_t baseChecksum = 0;
+	std::vector<SongEntry> songs;
+	std::vector<FolderEntry> folders;
+	std::string journalPath;
+	std::vector<unsigned char> journal;
+	// bytes of the journal up to the end of its last whole entry
+	size_t journalSize = 0;
+	// the string tables LoadSong has copied so far, by where they are in
+	// the file, and what they were copied into
+	mutable SongStrings* copiedInto = nullptr;
+	mutable std::unordered_map<const char*, const char*> copies;
+
+	const char* CopiedStrings(const SongEntry& entry, SongStrings& strings) const {
+		if (copiedInto != &strings) {
+			copies.clear();
+			copiedInto = &strings;
+		}
+		auto [it, inserted] = copies.try_emplace(entry.strings, nullptr);
+		if (inserted)
+			it->second = strings.Add(std::string_view(entry.strings, entry.stringsSize)).data();
+		return it->second;
+	}
+
+	bool Fail() {
+		Close();
+		return false;
+	}
+
+	void ReadJournal() {
+		std::error_code error;
+		uintmax_t size = std::filesystem::file_size(journalPath, error);
+		if (error || size < sizeof(JournalHeader))
+			return;
+		journal.resize(size);
+		{
+			std::ifstream in(journalPath, std::ios::binary);
+			in.read(reinterpret_cast<char*>(journal.data()), size);
+			if (!in) {
+				journal.clear();
+				return;
+			}
+		}
+		JournalHeader header;
+		memcpy(&header, journal.data(), sizeof(header));
+		if (memcmp(header.magic, "ENCJ", 4) != 0 || header.version.get() != CACHE_VERSION
+			|| header.baseChecksum.get() != baseChecksum) {
+			journal.clear();
+			return;
+		}
+
+		// base songs by folder, only checking that the folder is in bounds;
+		// the rest of each record is still checked when it's read
+		std::unordered_map<std::string_view, int> songIndex;
+		for (int i = 0; i < songs.size(); i++) {
+			if (InStrings(songs[i].record->songDir, songs[i].strings, songs[i].stringsSize))
+				songIndex[SongDir(i)] = i;
+		}
+		std::unordered_map<std::string_view, int> folderIndex;
+		for (int i = 0; i < folders.size(); i++)
+			folderIndex[FolderPath(i)] = i;
+
+		size_t pos = sizeof(JournalHeader);
+		while (pos + sizeof(JournalEntryHeader) + sizeof(uint64_t) <= size) {
+			JournalEntryHeader entry;
+			memcpy(&entry, journal.data() + pos, sizeof(entry));
+			size_t payloadSize = entry.size.get();
+			if (payloadSize > size - pos - sizeof(entry) - sizeof(uint64_t))
+				break;
+			const unsigned char* payload = journal.data() + pos + sizeof(entry);
+			LittleEndian<uint64_t> checksum;
+			memcpy(&checksum, payload + payloadSize, sizeof(checksum));
+			if (checksum.get() != Checksum(journal.data() + pos, sizeof(entry) + payloadSize))
+				break;
+			if (!ApplyEntry(entry.type.get(), payload, payloadSize, songIndex, folderIndex))
+				break;
+			pos += sizeof(entry) + payloadSize + sizeof(uint64_t);
+		}
+		journalSize = pos;
+		songs.erase(std::remove_if(songs.begin(), songs.end(), [](const SongEntry& song) {
+			return song.record == nullptr;
+		}), songs.end());
+	}
+
+	bool ApplyEntry(uint32_t type, const unsigned char* payload, size_t payloadSize,
+					std::unordered_map<std::string_view, int>& songIndex,
+					std::unordered_map<std::string_view, int>& folderIndex) {
+		switch (type) {
+			case JournalPutSong: {
+				if (payloadSize < sizeof(SongRecord))
+					return false;
+				SongEntry song{ reinterpret_cast<const SongRecord*>(payload),
+								reinterpret_cast<const char*>(payload + sizeof(SongRecord)),
+								payloadSize - sizeof(SongRecord) };
+				if (!InStrings(*song.record, song.strings, song.stringsSize))
+					return false;
+				// the entry's own hash already covers it
+				song.state = Valid;
+				std::string_view dir = String(song, song.record->songDir);
+				auto it = songIndex.find(dir);
+				if (it != songIndex.end()) {
+					songs[it->second] = song;
+				} else {
+					songIndex[dir] = (int)songs.size();
+					songs.push_back(song);
+				}
+				return true;
+			}
+			case JournalRemoveSong: {
+				std::string_view dir(reinterpret_cast<const char*>(payload), payloadSize);
+				auto it = songIndex.find(dir);
+				if (it != songIndex.end()) {
+					songs[it->second].record = nullptr;
+					songIndex.erase(it);
+				}
+				return true;
+			}
+			case JournalPutFolder: {
+				if (payloadSize < sizeof(FolderRecord))
+					return false;
+				FolderEntry folder{ reinterpret_cast<const FolderRecord*>(payload),
+									reinterpret_cast<const char*>(payload + sizeof(FolderRecord)) };
+				if (!InStrings(folder.record->path, folder.strings, payloadSize - sizeof(FolderRecord)))
+					return false;
+				std::string_view path = String(folder, folder.record->path);
+				auto it = folderIndex.find(path);
+				if (it != folderIndex.end()) {
+					folders[it->second] = folder;
+				} else {
+					folderIndex[path] = (int)folders.size();
+					folders.push_back(folder);
+				}
+				return true;
+			}
+			default:
+				return false;
+		}
+	}
+
+	// in bounds, with the null after it there too
+	static bool InStrings(const StringRef& ref, const char* strings, uint64_t stringsSize) {
+		uint64_t end = (uint64_t)ref.offset.get() + ref.length.get();
+		return end < stringsSize && strings[end] == '\0';
+	}
+
+	static bool InStrings(const SongRecord& record, const char* strings, uint64_t stringsSize) {
+		for (const StringRef* ref : StringRefs(record)) {
+			if (!InStrings(*ref, strings, stringsSize))
+				return false;
+		}
+		return true;
+	}
+
+	static std::array<const StringRef*, 9> StringRefs(const SongRecord& record) {
+		return { &record.title, &record.artist, &record.album, &record.songDir, &record.albumArtPath,
+				 &record.songInfoPath, &record.midiPath, &record.genre, &record.charters };
+	}
+
+	static uint64_t RecordChecksum(const SongRecord& record, const char* strings) {
+		uint64_t hash = Checksum(reinterpret_cast<const unsigned char*>(&record), offsetof(SongRecord, checksum));
+		for (const StringRef* ref : StringRefs(record))
+			hash = Checksum(reinterpret_cast<const unsigned char*>(strings) + ref->offset.get(), ref->length.get(), hash);
+		return hash;
+	}
+
+	static uint64_t RecordChecksum(const FolderRecord& record, const char* strings) {
+		uint64_t hash = Checksum(reinterpret_cast<const unsigned char*>(&record), offsetof(FolderRecord, checksum));
+		return Checksum(reinterpret_cast<const unsigned char*>(strings) + record.path.offset.get(),
+						record.path.length.get(), hash);
+	}
+
+	template <typename Entry>
+	static std::string_view String(const Entry& entry, const StringRef& ref) {
+		return std::string_view(entry.strings + ref.offset.get(), ref.length.get());
+	}
+
+	static SongRecord ToRecord(const SongMetadata& song, StringTable& table) {
+		SongRecord record;
+		record.title = table.add(song.title);
+		record.artist = table.add(song.artist);
+		record.album = table.add(song.album);
+		record.songDir = table.add(song.songDir);
+		record.albumArtPath = table.add(song.albumArtPath);
+		record.songInfoPath = table.add(song.songInfoPath);
+		record.midiPath = table.add(song.midiPath);
+		record.genre = table.add(song.genre);
+		record.charters = table.add(song.charters);
+		record.length.set(song.length);
+		record.releaseYear.set(song.releaseYear);
+		for (int part = 0; part < partCount; part++)
+			record.diffs[part] = (uint8_t)song.partDiffs[part];
+		record.pad = 0;
+		memset(record.jsonHash, 0, sizeof(record.jsonHash));
+		for (int b = 0; b < 32 && song.jsonHash.size() == 64; b++)
+			record.jsonHash[b] = (uint8_t)(HexDigit(song.jsonHash[b * 2]) << 4 | HexDigit(song.jsonHash[b * 2 + 1]));
+		record.jsonStamp = FromStamp(song.jsonStamp);
+		const ChartInfo& info = song.chartInfo;
+		for (int part = 0; part < partCount; part++) {
+			record.validDiffs[part] = info.validDiffs[part];
+			for (int diff = 0; diff < ChartInfo::diffCount; diff++)
+				record.noteCounts[part][diff].set(info.noteCounts[part][diff]);
+		}
+		record.pad2 = 0;
+		record.musicStart.set(std::bit_cast<uint64_t>(info.musicStart));
+		record.end.set(std::bit_cast<uint64_t>(info.end));
+		record.minBpm.set(std::bit_cast<uint32_t>(info.minBpm));
+		record.maxBpm.set(std::bit_cast<uint32_t>(info.maxBpm));
+		memcpy(record.midiHash, info.midiHash.data(), sizeof(record.midiHash));
+		record.midiStamp = FromStamp(info.midiStamp);
+		return record;
+	}
+
+	// the record with its strings moved into table
+	static SongRecord CopyRecord(const SongEntry& entry, StringTable& table) {
+		SongRecord record = *entry.record;
+		for (const StringRef* ref : StringRefs(record))
+			*const_cast<StringRef*>(ref) = table.add(String(entry, *ref));
+		return record;
+	}
+
+	template <typename ToSongRecord>
+	static bool WriteBase(const std::string& path, size_t songCount, ToSongRecord toRecord,
+						  const std::vector<std::pair<std::string, FileStamp>>& folderList) {
+		StringTable table;
+		std::vector<SongRecord> songRecords;
+		songRecords.reserve(songCount);
+		for (size_t i = 0; i < songCount; i++)
+			songRecords.push_back(toRecord(i, table));
+		std::vector<FolderRecord> folderRecords(folderList.size());
+		for (size_t i = 0; i < folderList.size(); i++) {
+			folderRecords[i].path = table.add(folderList[i].first);
+			folderRecords[i].stamp = FromStamp(folderList[i].second);
+		}
+		// the table is only complete now
+		for (SongRecord& record : songRecords)
+			record.checksum.set(RecordChecksum(record, table.bytes.data()));
+		for (FolderRecord& record : folderRecords)
+			record.checksum.set(RecordChecksum(record, table.bytes.data()));
+
+		std::vector<unsigned char> body(sizeof(SongCacheHeader));
+		AppendBytes(body, songRecords.data(), songRecords.size() * sizeof(SongRecord));
+		AppendBytes(body, folderRecords.data(), folderRecords.size() * sizeof(FolderRecord));
+		AppendBytes(body, table.bytes.data(), table.bytes.size());
+
+		SongCacheHeader fileHeader;
+		memcpy(fileHeader.magic, "ENCORE", 6);
+		fileHeader.version.set(CACHE_VERSION);
+		fileHeader.songCount.set((uint32_t)songRecords.size());
+		fileHeader.folderCount.set((uint32_t)folderRecords.size());
+		fileHeader.stringsSize.set(table.bytes.size());
+		fileHeader.baseChecksum.set(Checksum(body.data() + sizeof(fileHeader), body.size() - sizeof(fileHeader)));
+		fileHeader.headerChecksum.set(Checksum(reinterpret_cast<const unsigned char*>(&fileHeader),
+											   offsetof(SongCacheHeader, headerChecksum)));
+		memcpy(body.data(), &fileHeader, sizeof(fileHeader));
+
+		std::string tempPath = path + ".tmp";
+		std::error_code error;
+		{
+			std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+			out.write(reinterpret_cast<const char*>(body.data()), body.size());
+			if (!out) {
+				std::filesystem::remove(tempPath, error);
+				return false;
+			}
+		}
+		std::filesystem::rename(tempPath, path, error);
+		if (error) {
+			std::filesystem::remove(tempPath, error);
+			return false;
+		}
+		return true;
+	}
+
+	static void AppendBytes(std::vector<unsigned char>& bytes, const void* data, size_t size) {
+		if (size == 0)
+			return;
+		const unsigned char* first = static_cast<const unsigned char*>(data);
+		bytes.insert(bytes.end(), first, first + size);
+	}
+
+	static void AppendEntry(std::vector<unsigned char>& bytes, JournalEntryType type,
+							const void* record, size_t recordSize, const std::vector<char>& strings) {
+		size_t start = bytes.size();
+		JournalEntryHeader entry;
+		entry.type.set(type);
+		entry.size.set((uint32_t)(recordSize + strings.size()));
+		AppendBytes(bytes, &entry, sizeof(entry));
+		AppendBytes(bytes, record, recordSize);
+		AppendBytes(bytes, strings.data(), strings.size());
+		LittleEndian<uint64_t> checksum;
+		checksum.set(Checksum(bytes.data() + start, bytes.size() - start));
+		AppendBytes(bytes, &checksum, sizeof(checksum));
+	}
+
+	static FileStamp ToStamp(const StampRecord& record) {
+		FileStamp stamp;
+		stamp.size = record.size.get();
+		stamp.mtime = record.mtime.get();
+		stamp.inode = record.inode.get();
+		return stamp;
+	}
+
+	static StampRecord FromStamp(const FileStamp& stamp) {
+		StampRecord record;
+		record.size.set(stamp.size);
+		record.mtime.set(stamp.mtime);
+		record.inode.set(stamp.inode);
+		return record;
+	}
+
+	static int HexDigit(char c) {
+		if (c >= '0' && c <= '9')
+			return c - '0';
+		if (c >= 'a' && c <= 'f')
+			return c - 'a' + 10;
+		if (c >= 'A' && c <= 'F')
+			return c - 'A' + 10;
+		return 0;
+	}
+
+	// FNV-1a, carrying on from hash to cover data that isn't all in one place
+	static uint64_t Checksum(const unsigned char* data, size_t size, uint64_t hash = 14695981039346656037ull) {
+		for (size_t i = 0; i < size; i++) {
+			hash ^= data[i];
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+};
@@ -1,10 +1,21 @@
 #pragma once
 #include "song.h"
+#include "songscanner.h"
+#include "songcache.h"
+#include "songwatcher.h"
+#include "sortkey.h"
+#include "songsearch.h"
 #include <vector>
+#include <array>
+#include <numeric>
 #include <filesystem>
 #include <thread>
 #include <algorithm>
 #include <set>
+#include <map>
+#include <memory>
+#include <future>
+#include <mutex>
 #include "picosha2.h"
 #include "raylib.h"
 
@@ -24,279 +35,459 @@ public:
         return instance;
     }
 
-    static bool sortArtist(const Song& a, const Song& b) {
-        return ((std::string)TextToLower(a.artist.c_str())) < ((std::string)TextToLower(b.artist.c_str()));
-    }
-    static bool sortTitle(const Song& a, const Song& b) {
-        return ((std::string)TextToLower(a.title.c_str())) < ((std::string)TextToLower(b.title.c_str()));
-    }
-    static bool sortLen(const Song& a, const Song& b) {
-        return a.length < b.length;
-    }
+    enum SortType {
+        SortTitle,
+        SortArtist,
+        SortLength,
+        SortAlbum,
+        SortYear,
+        SortGenre,
+        SortCharter,
+        SortTypeCount
+    };
+
+    struct SortKeys {
+        std::string title;
+        std::string artist;
+        std::string album;
+        std::string genre;
+        std::string charter;
+    };
     std::vector<ListMenuEntry> listMenuEntries;
-    std::vector<Song> songs;
+    std::vector<SongMetadata> songs;
+    // the text of every song in songs
+    std::shared_ptr<SongStrings> strings = std::make_shared<SongStrings>();
     int songCount = 0;
     int directoryCount  = 0;
     int badSongCount = 0;
-    //0 - title
-    //1 - artist
-    //2 - length
-    void sortList(int sortType) {
-        switch (sortType) {
-            case (0):
-                std::sort(songs.begin(), songs.end(), sortTitle);
-                break;
-            case (1):
-                std::sort(songs.begin(), songs.end(), sortArtist);
-                break;
-            case (2):
-                std::sort(songs.begin(), songs.end(), sortLen);
-                break;
+    // songs stay in the order they were loaded, so an index into songs
+    // stays valid when the sort changes; these say what order to show them in
+    std::vector<SortKeys> sortKeys;
+    std::array<std::vector<int>, SortTypeCount> sortOrders;
+    std::shared_ptr<SongSearch> search = std::make_shared<SongSearch>();
+    std::string searchQuery;
+    // the entries in listMenuEntries that aren't hidden, one per row
+    std::vector<int> visibleEntries;
+
+    // works out every sort order up front, whenever songs change
+    void buildSortOrders() {
+        sortKeys.clear();
+        sortKeys.reserve(songs.size());
+        for (const SongMetadata& song : songs) {
+            sortKeys.push_back({
+                SortKey::Of(song.title, true),
+                SortKey::Of(song.artist, true),
+                SortKey::Of(song.album, true),
+                SortKey::Of(song.genre, false),
+                SortKey::Of(song.FirstCharter(), false)
+            });
         }
-        listMenuEntries = GenerateSongEntriesWithHeaders(songs, sortType);
+        std::vector<int>& byTitle = sortOrders[SortTitle];
+        byTitle.resize(songs.size());
+        std::iota(byTitle.begin(), byTitle.end(), 0);
+        std::sort(byTitle.begin(), byTitle.end(), [this](int a, int b) {
+            if (sortKeys[a].title != sortKeys[b].title)
+                return sortKeys[a].title < sortKeys[b].title;
+            return sortKeys[a].artist < sortKeys[b].artist;
+        });
+        // the rest start from title order, so songs that tie stay in it
+        auto sortBy = [&](int sortType, auto less) {
+            sortOrders[sortType] = byTitle;
+            std::stable_sort(sortOrders[sortType].begin(), sortOrders[sortType].end(), less);
+        };
+        sortBy(SortArtist, [this](int a, int b) { return sortKeys[a].artist < sortKeys[b].artist; });
+        sortBy(SortLength, [this](int a, int b) { return songs[a].length < songs[b].length; });
+        sortBy(SortAlbum, [this](int a, int b) { return sortKeys[a].album < sortKeys[b].album; });
+        sortBy(SortYear, [this](int a, int b) { return songs[a].releaseYear < songs[b].releaseYear; });
+        sortBy(SortGenre, [this](int a, int b) { return sortKeys[a].genre < sortKeys[b].genre; });
+        sortBy(SortCharter, [this](int a, int b) { return sortKeys[a].charter < sortKeys[b].charter; });
     }
-    void sortList(int sortType,int& selectedSong) {
-        Song curSong = songs[selectedSong];
-        selectedSong = 0;
-        switch (sortType) {
-        case (0):
-            std::sort(songs.begin(), songs.end(), sortTitle);
-            break;
-        case (1):
-            std::sort(songs.begin(), songs.end(), sortArtist);
-            break;
-        case (2):
-            std::sort(songs.begin(), songs.end(), sortLen);
-            break;
+
+    void sortList(int sortType) {
+        listMenuEntries = GenerateSongEntriesWithHeaders(sortType);
+        Search(searchQuery);
+    }
+
+    // hides the songs that don't match query, and the headers left without
+    // any songs; returns the best match, or -1 if there is none
+    int Search(const std::string& query) {
+        searchQuery = query;
+        bool showAll = query.find_first_not_of(' ') == std::string::npos;
+        std::vector<int> ranked;
+        std::vector<bool> matches(songs.size(), showAll);
+        if (!showAll) {
+            ranked = search->Query(query);
+            for (int song : ranked)
+                matches[song] = true;
         }
-        for (int i = 0; i < songs.size();i++) {
-            if (songs[i].artist == curSong.artist && songs[i].title == curSong.title) {
-                selectedSong = i;
+        visibleEntries.clear();
+        int header = -1;
+        for (int i = 0; i < listMenuEntries.size(); i++) {
+            ListMenuEntry& entry = listMenuEntries[i];
+            if (entry.isHeader) {
+                entry.hiddenEntry = true;
+                header = i;
+                continue;
             }
+            entry.hiddenEntry = !matches[entry.songListID];
+            if (entry.hiddenEntry)
+                continue;
+            if (header >= 0 && listMenuEntries[header].hiddenEntry) {
+                listMenuEntries[header].hiddenEntry = false;
+                visibleEntries.push_back(header);
+            }
+            visibleEntries.push_back(i);
         }
-        listMenuEntries = GenerateSongEntriesWithHeaders(songs, sortType);
+        return ranked.empty() ? -1 : ranked[0];
     }
 
-    void WriteCache(std::vector<Song> songs) {
-        std::filesystem::remove("songCache.encr");
-
-        std::ofstream SongCache("songCache.encr", std::ios::binary);
+    // the row in visibleEntries that shows song
+    int EntryIndex(int song) const {
+        for (int i = 0; i < visibleEntries.size(); i++) {
+            const ListMenuEntry& entry = listMenuEntries[visibleEntries[i]];
+            if (!entry.isHeader && entry.songListID == song)
+                return i;
+        }
+        return 0;
+    }
 
-        const char header[7] = "ENCORE";
-        SongCache.write(header, 6);
-        uint16_t version = CACHE_VERSION;
-        SongCache.write(reinterpret_cast<const char*>(&version), 2);
+    // the header of the group that the row is in
+    std::string HeaderAt(int row) const {
+        if (row >= 0 && row < visibleEntries.size() && listMenuEntries[visibleEntries[row]].isHeader)
+            row--;
+        for (int i = std::min(row, (int)visibleEntries.size() - 1); i >= 0; i--) {
+            if (listMenuEntries[visibleEntries[i]].isHeader)
+                return listMenuEntries[visibleEntries[i]].headerChar;
+        }
+        return "";
+    }
 
-        size_t SongCount = songs.size();
-        SongCache.write(reinterpret_cast<const char*>(&SongCount), sizeof(SongCount));
+    static std::vector<FileStamp> StampFolders(const std::vector<std::filesystem::path>& songsFolder) {
+        std::vector<FileStamp> stamps;
+        for (const auto& folder : songsFolder)
+            stamps.push_back(FileStamp::Of(folder));
+        return stamps;
+    }
 
+    static constexpr const char* cachePath = "songCache.encr";
+    static constexpr const char* journalPath = "songCache.encj";
+    // the list being loaded in the background, until it's taken
+    static std::future<SongList> loading;
+    // compaction of the journal into a new cache, which runs in the background
+    // and is waited for before the cache is touched again
+    static inline std::future<bool> compaction;
+    // the song watcher journals changes from its own thread
+    static inline std::recursive_mutex cacheMutex;
+
+    static void WaitForCompaction() {
+        if (compaction.valid() && !compaction.get())
+            TraceLog(LOG_WARNING, "Failed to compact song cache");
+    }
 
-        for (const auto& song : songs) {
-            TraceLog(LOG_INFO, TextFormat("%s - %s", song.title.c_str(), song.artist.c_str()));
-            size_t nameLen = song.title.size();
-            size_t songDirectoryLen = song.songDir.size();
-            size_t albumArtPathLen = song.albumArtPath.size();
-            size_t jsonPathLen = song.songInfoPath.size();
-            size_t artistLen = song.artist.size();
-            size_t lengthLen = std::to_string(song.length).size();
+    // compact once the journal is an eighth the size of the cache
+    static bool ShouldCompact(const SongCache& cache) {
+        return cache.JournalSize() > std::max<size_t>(64 * 1024, cache.BaseSize() / 8);
+    }
 
-            SongCache.write(reinterpret_cast<const char*>(&nameLen), sizeof(nameLen));
-            SongCache.write(song.title.c_str(), nameLen);
+    // folderStamps are the song folders as they were before they were scanned
+    void WriteCache(const std::vector<SongMetadata>& songs, const std::vector<std::filesystem::path>& songsFolder,
+                    const std::vector<FileStamp>& folderStamps) {
+        std::lock_guard<std::recursive_mutex> lock(cacheMutex);
+        WaitForCompaction();
+        // the old cache goes first, so a write that fails leaves no cache
+        // rather than a stale one that gets rescanned over and over
+        std::error_code error;
+        std::filesystem::remove(cachePath, error);
+        std::filesystem::remove(journalPath, error);
+        if (!SongCache::Write(cachePath, songs, songsFolder, folderStamps)) {
+            TraceLog(LOG_WARNING, "Failed to write song cache");
+            return;
+        }
+        TraceLog(LOG_INFO, "Wrote %01i songs to song cache", (int)songs.size());
+    }
 
-            SongCache.write(reinterpret_cast<const char*>(&songDirectoryLen), sizeof(songDirectoryLen));
-            SongCache.write(song.songDir.c_str(), songDirectoryLen);
-            TraceLog(LOG_INFO, TextFormat("Directory - %s", song.songDir.c_str()));
-            SongCache.write(reinterpret_cast<const char*>(&albumArtPathLen), sizeof(albumArtPathLen));
-            SongCache.write(song.albumArtPath.c_str(), albumArtPathLen);
-            TraceLog(LOG_INFO, TextFormat("Album Art Path - %s", song.albumArtPath.c_str()));
+    // appends songs and folders that changed while the game is running to the
+    // journal; if the cache can't be opened, the next LoadCache rescans anyway
+    static void JournalChanges(const std::vector<const SongMetadata*>& changedSongs, const std::vector<std::string>& removedSongs,
+                               const std::vector<std::filesystem::path>& folders,
+                               const std::vector<FileStamp>& folderStamps) {
+        std::lock_guard<std::recursive_mutex> lock(cacheMutex);
+        WaitForCompaction();
+        SongCache cache;
+        if (!cache.Open(cachePath, journalPath))
+            return;
+        if (!cache.Append(changedSongs, removedSongs, folders, folderStamps))
+            TraceLog(LOG_WARNING, "Failed to journal song changes");
+        bool compact = ShouldCompact(cache);
+        cache.Close();
+        if (compact)
+            compaction = std::async(std::launch::async, SongCache::Compact, std::string(cachePath), std::string(journalPath));
+    }
 
-            SongCache.write(reinterpret_cast<const char*>(&artistLen), sizeof(artistLen));
-            SongCache.write(song.artist.c_str(), artistLen);
+    // merges songs loaded by the song watcher into the list. Songs move
+    // when others are removed, so the new index of every song that was in
+    // the list is returned, by its old index, or -1 if it was removed
+    std::vector<int> ApplyUpdate(SongListUpdate& update, int sortType) {
+        // which old index each song came from, kept in step with songs
+        std::vector<int> from(songs.size());
+        for (int i = 0; i < songs.size(); i++)
+            from[i] = i;
+        int oldCount = songs.size();
+        // songs aren't kept in order, so a removed song is swapped with the
+        // last one, which only moves that one in the search index
+        for (const std::string& songDir : update.removedSongDirs) {
+            for (int i = 0; i < songs.size(); i++) {
+                if (songs[i].songDir != songDir)
+                    continue;
+                search->RemoveSwap(i);
+                songs[i] = std::move(songs.back());
+                songs.pop_back();
+                from[i] = from.back();
+                from.pop_back();
+                break;
+            }
+        }
+        for (SongMetadata& song : update.changedSongs) {
+            auto it = std::find_if(songs.begin(), songs.end(), [&song](const SongMetadata& other) {
+                return other.songDir == song.songDir;
+            });
+            if (it == songs.end()) {
+                it = songs.insert(songs.end(), SongMetadata());
+                from.push_back(-1);
+            }
+            *it = song;
+            it->InternInto(*strings);
+            search->Set(it - songs.begin(), *it);
+        }
+        songCount = songs.size();
+        buildSortOrders();
+        sortList(sortType);
+        std::vector<int> moved(oldCount, -1);
+        for (int i = 0; i < songs.size(); i++) {
+            if (from[i] >= 0)
+                moved[from[i]] = i;
+        }
+        return moved;
+    }
 
-            SongCache.write(reinterpret_cast<const char*>(&jsonPathLen), sizeof(jsonPathLen));
-            SongCache.write(song.songInfoPath.c_str(), jsonPathLen);
-            TraceLog(LOG_INFO, TextFormat("Song Info Path - %s", song.songInfoPath.c_str()));
-            SongCache.write(song.jsonHash.c_str(), 64);
 
-            SongCache.write(reinterpret_cast<const char*>(&lengthLen), sizeof(lengthLen));
-            SongCache.write(std::to_string(song.length).c_str(), lengthLen);
-            TraceLog(LOG_INFO, std::to_string(song.length).c_str());
-        }
+    // the stamp a library folder is cached with. One holding folders without
+    // an info.json is cached unstamped, so it's listed again on every load:
+    // an info.json turning up later doesn't touch the library folder's own
+    // stamp, so it would never be noticed otherwise. That only costs a stat
+    // of each such folder, since the songs already loaded are skipped
+    static FileStamp CachedFolderStamp(const FileStamp& stamp, int badSongCount) {
+        return badSongCount > 0 ? FileStamp() : stamp;
+    }
 
-        SongCache.close();
+    // loads the song list on a thread of its own, so the menu keeps drawing;
+    // from the cache, or by rescanning every song folder. Nothing happens if
+    // a load is already running. Loading runs off the render thread, so
+    // nothing it logs can go through TextFormat
+    void StartLoading(const std::vector<std::filesystem::path>& songsFolder, bool rescan) {
+        if (loading.valid())
+            return;
+        loading = std::async(std::launch::async, [this, songsFolder, rescan] {
+            return rescan ? ScanSongs(songsFolder) : LoadCache(songsFolder);
+        });
     }
 
+    bool Loading() const { return loading.valid(); }
 
-    void ScanSongs(const std::vector<std::filesystem::path>& songsFolder)
+    // replaces this list with the one loaded in the background, once it's
+    // done; false while it's still loading, or if nothing was
+    bool TakeLoaded() {
+        if (!loading.valid() || loading.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return false;
+        *this = loading.get();
+        return true;
+    }
+
+    // rescans every song folder and rewrites the cache from it; the list
+    // scanned is returned ready to show, for when the cache can't be read
+    SongList ScanSongs(const std::vector<std::filesystem::path>& songsFolder)
     {
         SongList list;
-        for (const auto & i : songsFolder) {
-            if (std::filesystem::is_directory(i)) {
-                for (const auto &entry: std::filesystem::directory_iterator(i)) {
-                    if (std::filesystem::is_directory(entry)) {
-                        list.directoryCount++;
-                        if (std::filesystem::exists(entry.path() / "info.json")) {
-                            Song song;
-                            song.LoadSong(entry.path() / "info.json");
-                            list.songs.push_back(song);
-                            list.songCount++;
-                        } else {
-                            list.badSongCount++;
-                        }
-                    }
-                }
-            }
-        }
+        std::vector<FileStamp> folderStamps = StampFolders(songsFolder);
+        SongScanner::Result scan = SongScanner::Scan(songsFolder, *list.strings);
+        list.songs = std::move(scan.songs);
+        list.songCount = list.songs.size();
+        list.directoryCount = scan.directoryCount;
+        list.badSongCount = scan.badSongCount;
+        for (int i = 0; i < songsFolder.size(); i++)
+            folderStamps[i] = CachedFolderStamp(folderStamps[i], scan.badSongCounts[i]);
+        TraceLog(LOG_INFO, "Scanned %01i songs in %01i folders", list.songCount, list.directoryCount);
         TraceLog(LOG_INFO, "Rewriting song cache");
-        WriteCache(list.songs);
+        WriteCache(list.songs, songsFolder, folderStamps);
+        list.buildSortOrders();
+        list.search->Build(list.songs);
+        list.sortList(SortTitle);
+        return list;
+    }
+
+    std::string Header(int song, int sortType) const {
+        switch (sortType) {
+            case SortTitle:
+                return SortKey::Initial(sortKeys[song].title);
+            case SortArtist:
+                return std::string(songs[song].artist);
+            case SortLength:
+                return std::to_string(songs[song].length);
+            case SortAlbum:
+                return std::string(songs[song].album);
+            case SortYear:
+                return std::to_string(songs[song].releaseYear);
+            case SortGenre:
+                return std::string(songs[song].genre);
+            case SortCharter:
+                return std::string(songs[song].FirstCharter());
+        }
+        return "";
     }
 
-    std::vector<ListMenuEntry> GenerateSongEntriesWithHeaders(const std::vector<Song>& songs, int sortType) {
+    std::vector<ListMenuEntry> GenerateSongEntriesWithHeaders(int sortType) {
         std::vector<ListMenuEntry> songEntries;
+        if (sortType < 0 || sortType >= SortTypeCount || sortOrders[sortType].size() != songs.size())
+            return songEntries;
+        songEntries.reserve(songs.size() + songs.size() / 4);
         std::string currentHeader = "";
-
-        for (int i = 0; i < songs.size(); i++) {
-            Song song = songs[i];
-            switch (sortType) {
-                case 0: {
-                    if (toupper(song.title[0]) != currentHeader[0]) {
-                        currentHeader = toupper(song.title[0]);
-                        songEntries.push_back({true, 0, currentHeader, false});
-                    }
-                    break;
-                }
-                case 1: {
-                    if (song.artist != currentHeader) {
-                        currentHeader = song.artist;
-                        songEntries.push_back({true, 0, currentHeader, false});
-                    }
-                    break;
-                }
-                case 2: {
-                    if (std::to_string(song.length) != currentHeader) {
-                        currentHeader = std::to_string(song.length);
-                        songEntries.push_back({true, 0, currentHeader, false});
-                    }
-                    break;
-                }
+        for (int song : sortOrders[sortType]) {
+            std::string header = Header(song, sortType);
+            if (songEntries.empty() || header != currentHeader) {
+                songEntries.push_back({true, 0, header, false});
+                currentHeader = std::move(header);
             }
-            songEntries.push_back({false, i, "", false});
+            songEntries.push_back({false, song, "", false});
         }
-
         return songEntries;
     }
 
     SongList LoadCache(const std::vector<std::filesystem::path>& songsFolder) {
         SongList list;
-        std::ifstream SongCacheIn("songCache.encr", std::ios::binary);
-        if (!SongCacheIn) {
+        std::vector<FileStamp> folderStamps = StampFolders(songsFolder);
+        std::lock_guard<std::recursive_mutex> lock(cacheMutex);
+        WaitForCompaction();
+        if (!std::filesystem::exists(cachePath)) {
             TraceLog(LOG_WARNING, "Failed to load song cache!");
             return list;
         }
-
-        // Read header
-        char header[6];
-        SongCacheIn.read(header, 6);
-        if (std::string(header, 6) != "ENCORE") {
-            TraceLog(LOG_WARNING, "Invalid song cache format, rescanning");
-            SongCacheIn.close();
-            ScanSongs(songsFolder);
-            return LoadCache(songsFolder);
-        }
-
-        uint16_t version;
-        SongCacheIn.read(reinterpret_cast<char*>(&version), 2);
-        if (version != CACHE_VERSION) {
-            TraceLog(LOG_WARNING, TextFormat("Cache version %01i, but current version is %01i",version, CACHE_VERSION));
-            SongCacheIn.close();
-            ScanSongs(songsFolder);
-            return LoadCache(songsFolder);
+        SongCache cache;
+        if (!cache.Open(cachePath, journalPath)) {
+            TraceLog(LOG_WARNING, "Invalid or outdated song cache, rescanning");
+            SongList scanned = ScanSongs(songsFolder);
+            // only the one try; if the new cache can't be read either, the
+            // songs just scanned are as good
+            if (!cache.Open(cachePath, journalPath)) {
+                TraceLog(LOG_WARNING, "Failed to reopen song cache after rescanning");
+                return scanned;
+            }
         }
 
-        size_t size;
-        SongCacheIn.read(reinterpret_cast<char*>(&size), sizeof(size));
-        list.songs.resize(size);
+        size_t size = cache.SongCount();
+        list.songs.reserve(size);
         TraceLog(LOG_INFO, "Loading song cache");
 
-        std::set<std::string> loadedSongs;  // To track loaded songs and avoid duplicates
-        int idx = 0;
-        for (auto& ___ : list.songs) {
-            size_t nameLen = 0, albumArtPathLen = 0, directoryLen = 0, jsonPathLen = 0, artistLen = 0, lengthLen = 0;
-            std::string LengthString;
-            Song& song = list.songs[idx];
-            SongCacheIn.read(reinterpret_cast<char*>(&nameLen), 8);
-            song.title.resize(nameLen);
-            SongCacheIn.read(&song.title[0], nameLen);
-
-            SongCacheIn.read(reinterpret_cast<char*>(&directoryLen), 8);
-            song.songDir.resize(directoryLen);
-            SongCacheIn.read(&song.songDir[0], directoryLen);
-            
-
-            TraceLog(LOG_INFO, TextFormat("Directory - %s", song.songDir.c_str()));
-
-            SongCacheIn.read(reinterpret_cast<char*>(&albumArtPathLen), 8);
-            song.albumArtPath.resize(albumArtPathLen);
-            SongCacheIn.read(&song.albumArtPath[0], albumArtPathLen);
-
-            SongCacheIn.read(reinterpret_cast<char*>(&artistLen), 8);
-            song.artist.resize(artistLen);
-            SongCacheIn.read(&song.artist[0], artistLen);
-
-            SongCacheIn.read(reinterpret_cast<char*>(&jsonPathLen), 8);
-            song.songInfoPath.resize(jsonPathLen);
-            SongCacheIn.read(&song.songInfoPath[0], jsonPathLen);
-            song.jsonHash.resize(64);
-            SongCacheIn.read(&song.jsonHash[0], 64);
-
-            std::ifstream jsonFile(song.songInfoPath);
-            std::string jsonHashNew = "";
-            if (jsonFile) {
+        std::set<std::string_view> loadedSongs;  // To track loaded songs and avoid duplicates
+        // what goes in the journal
+        std::vector<int> changedSongs;
+        std::vector<std::string> removedSongs;
+        for (int i = 0; i < size; i++) {
+            // records are only checked as they're read; one that's been
+            // damaged means the cache can't be trusted
+            if (!cache.SongValid(i)) {
+                TraceLog(LOG_WARNING, "Damaged song cache, rescanning");
+                cache.Close();
+                return ScanSongs(songsFolder);
+            }
+            // only rehash info.json if its stamp changed, and only reload it
+            // if the contents did
+            std::filesystem::path jsonPath = cache.SongInfoPath(i);
+            FileStamp jsonStamp = FileStamp::Of(jsonPath);
+            if (!jsonStamp.valid()) {
+                removedSongs.emplace_back(cache.SongDir(i));
+                continue;
+            }
+            SongMetadata& song = list.songs.emplace_back();
+            cache.LoadSong(i, song, *list.strings);
+            if (jsonStamp != song.jsonStamp) {
+                changedSongs.push_back(list.songs.size() - 1);
+                std::ifstream jsonFile(jsonPath);
                 std::string jsonString((std::istreambuf_iterator<char>(jsonFile)), std::istreambuf_iterator<char>());
                 jsonFile.close();
-                jsonHashNew = picosha2::hash256_hex_string(jsonString);
+                if (picosha2::hash256_hex_string(jsonString) == song.jsonHash) {
+                    song.jsonStamp = jsonStamp;
+                } else {
+                    SongMetadata reloaded;
+                    reloaded.LoadSong(jsonPath, *list.strings);
+                    reloaded.chartInfo = song.chartInfo;
+                    song = std::move(reloaded);
+                }
             }
-            
-            
-            SongCacheIn.read(reinterpret_cast<char*>(&lengthLen), 8);
-            LengthString.resize(lengthLen);
-            SongCacheIn.read(&LengthString[0], lengthLen);
-
-            song.length = std::stoi(LengthString);
-            if (!std::filesystem::exists(song.songDir))
-                continue;
-            if (song.jsonHash != jsonHashNew)
-                continue;
+            // the MIDI can change without info.json changing
+            bool changed = !changedSongs.empty() && changedSongs.back() == list.songs.size() - 1;
+            if (song.LoadChartInfo() && !changed)
+                changedSongs.push_back(list.songs.size() - 1);
             loadedSongs.insert(song.songDir);
-            idx++;
         }
-        list.songs.resize(idx);
-        SongCacheIn.close();
+
+        std::map<std::string, FileStamp, std::less<>> cachedFolderStamps;
+        for (int i = 0; i < cache.FolderCount(); i++)
+            cachedFolderStamps.emplace(cache.FolderPath(i), cache.FolderStamp(i));
         int loadedFromCache = list.songs.size();
-        // Load additional songs from directories if needed
-        for (const auto& folder : songsFolder) {
-            for (const auto& entry : std::filesystem::directory_iterator(folder)) {
-                if (std::filesystem::is_directory(entry)) {
-                    if (std::filesystem::exists(entry.path() / "info.json")) {
-                        if (loadedSongs.find(entry.path().string()) == loadedSongs.end()) {
-                            Song song;
-                            song.LoadSong(entry.path() / "info.json");
-                            list.songs.push_back(song);
-                            list.songCount++;
-                        }
-                        else {
-                            list.badSongCount++;
-                        }
-                    }
-                }
+        // Load additional songs from directories if needed, skipping the
+        // song folders that haven't changed since the cache was written
+        std::vector<std::filesystem::path> changedFolders;
+        std::vector<int> changedFolderIndexes;
+        for (int i = 0; i < songsFolder.size(); i++) {
+            auto cached = cachedFolderStamps.find(songsFolder[i].string());
+            if (cached == cachedFolderStamps.end() || cached->second != folderStamps[i]) {
+                changedFolders.push_back(songsFolder[i]);
+                changedFolderIndexes.push_back(i);
             }
         }
-        if (size!=loadedFromCache || list.songs.size() > loadedFromCache) {
-            TraceLog(LOG_INFO, "Updating song cache");
-            WriteCache(list.songs);
+        SongScanner::Result scan = SongScanner::Scan(changedFolders, *list.strings, loadedSongs);
+        // only the folders whose cached stamp is different now go in the
+        // journal, so one that's listed on every load doesn't grow it
+        std::vector<std::filesystem::path> restampedFolders;
+        std::vector<FileStamp> restamps;
+        for (int j = 0; j < changedFolders.size(); j++) {
+            int i = changedFolderIndexes[j];
+            folderStamps[i] = CachedFolderStamp(folderStamps[i], scan.badSongCounts[j]);
+            auto cached = cachedFolderStamps.find(songsFolder[i].string());
+            if (cached == cachedFolderStamps.end() || cached->second != folderStamps[i]) {
+                restampedFolders.push_back(songsFolder[i]);
+                restamps.push_back(folderStamps[i]);
+            }
+        }
+        list.directoryCount = scan.directoryCount;
+        list.badSongCount = scan.badSongCount;
+        list.songCount += scan.songs.size();
+        list.songs.insert(list.songs.end(), scan.songs.begin(), scan.songs.end());
+        for (int i = loadedFromCache; i < list.songs.size(); i++)
+            changedSongs.push_back(i);
+
+        if (!changedSongs.empty() || !removedSongs.empty() || !restampedFolders.empty()) {
+            TraceLog(LOG_INFO, "Updating song cache: %01i changed, %01i removed", (int)changedSongs.size(),
+                     (int)removedSongs.size());
+            std::vector<const SongMetadata*> journalSongs;
+            for (int i : changedSongs)
+                journalSongs.push_back(&list.songs[i]);
+            if (!cache.Append(journalSongs, removedSongs, restampedFolders, restamps)) {
+                cache.Close();
+                WriteCache(list.songs, songsFolder, folderStamps);
+            }
         }
-        list.sortList(0);
+        bool compact = ShouldCompact(cache);
+        cache.Close();
+        if (compact)
+            compaction = std::async(std::launch::async, SongCache::Compact, std::string(cachePath), std::string(journalPath));
+        list.buildSortOrders();
+        list.search->Build(list.songs);
+        list.sortList(SortTitle);
         return list;
     }
 };
 
+// defined out here since SongList has to be complete first
+inline std::future<SongList> SongList::loading;
+
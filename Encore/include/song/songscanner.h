@@ -0,0 +1,152 @@
+#pragma once
+#include "song.h"
+#include <vector>
+#include <deque>
+#include <set>
+#include <string>
+#include <string_view>
+#include <filesystem>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+
+// how far the running scan has got, for the menu to show while songs load
+// in the background; song folders listed so far, and how many of those are
+// loaded
+inline std::atomic<int> ScanFoldersFound = 0;
+inline std::atomic<int> ScanFoldersDone = 0;
+
+// Loads info.json from every song folder in the given library folders, and
+// works out the ChartInfo of each song's MIDI. The calling thread lists the
+// folders and hands them to a pool of workers, which read, hash and parse the
+// files concurrently. Most of that time is spent waiting on the disk, so
+// there are more workers than cores to keep several reads in flight. Songs
+// come back in listing order, however the workers happened to finish.
+class SongScanner
+{
+public:
+    struct Result {
+        std::vector<SongMetadata> songs;
+        int directoryCount = 0;
+        int badSongCount = 0;
+        // folders without an info.json in each of the library folders
+        std::vector<int> badSongCounts;
+    };
+
+    // the songs' text goes in strings; skipDirs are song folders that are
+    // already loaded
+    static Result Scan(const std::vector<std::filesystem::path>& songsFolder, SongStrings& strings,
+                       const std::set<std::string_view>& skipDirs = {}) {
+        ScanFoldersFound = 0;
+        ScanFoldersDone = 0;
+        SongScanner scanner(strings);
+        std::vector<std::thread> workers;
+        std::vector<WorkerResult> workerResults(WorkerCount(), { {}, std::vector<int>(songsFolder.size()) });
+        for (WorkerResult& workerResult : workerResults)
+            workers.emplace_back(&SongScanner::work, &scanner, std::ref(workerResult));
+
+        Result result;
+        result.badSongCounts.assign(songsFolder.size(), 0);
+        int order = 0;
+        for (int folder = 0; folder < songsFolder.size(); folder++) {
+            if (!std::filesystem::is_directory(songsFolder[folder]))
+                continue;
+            for (const auto& entry : std::filesystem::directory_iterator(songsFolder[folder])) {
+                if (!entry.is_directory())
+                    continue;
+                result.directoryCount++;
+                if (skipDirs.find(entry.path().string()) != skipDirs.end())
+                    continue;
+                scanner.push({ order++, folder, entry.path() });
+            }
+        }
+        scanner.finish();
+        for (std::thread& worker : workers)
+            worker.join();
+
+        std::vector<std::pair<int, SongMetadata>> found;
+        for (WorkerResult& workerResult : workerResults) {
+            for (int folder = 0; folder < songsFolder.size(); folder++) {
+                result.badSongCounts[folder] += workerResult.badSongCounts[folder];
+                result.badSongCount += workerResult.badSongCounts[folder];
+            }
+            for (auto& song : workerResult.songs)
+                found.push_back(std::move(song));
+        }
+        std::sort(found.begin(), found.end(), [](const auto& a, const auto& b) {
+            return a.first < b.first;
+        });
+        result.songs.reserve(found.size());
+        for (auto& song : found)
+            result.songs.push_back(std::move(song.second));
+        return result;
+    }
+
+private:
+    struct Job {
+        int order;
+        // which library folder it's in
+        int folder;
+        std::filesystem::path dir;
+    };
+    struct WorkerResult {
+        std::vector<std::pair<int, SongMetadata>> songs;
+        std::vector<int> badSongCounts;
+    };
+
+    SongStrings& strings;
+    std::mutex mutex;
+    std::condition_variable jobReady;
+    std::deque<Job> jobs;
+    bool listed = false;
+
+    explicit SongScanner(SongStrings& strings) : strings(strings) {}
+
+    static int WorkerCount() {
+        int cores = std::max(1, (int)std::thread::hardware_concurrency());
+        return std::clamp(cores * 2, 4, 32);
+    }
+
+    void push(Job job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(std::move(job));
+        }
+        ScanFoldersFound++;
+        jobReady.notify_one();
+    }
+
+    void finish() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            listed = true;
+        }
+        jobReady.notify_all();
+    }
+
+    void work(WorkerResult& result) {
+        while (true) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                jobReady.wait(lock, [this] { return !jobs.empty() || listed; });
+                if (jobs.empty())
+                    return;
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            std::filesystem::path info = job.dir / "info.json";
+            if (std::filesystem::exists(info)) {
+                SongMetadata song;
+                song.LoadSong(info, strings);
+                song.LoadChartInfo();
+                result.songs.emplace_back(job.order, std::move(song));
+            } else {
+                result.badSongCounts[job.folder]++;
+            }
+            ScanFoldersDone++;
+        }
+    }
+};
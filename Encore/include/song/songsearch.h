@@ -0,0 +1,290 @@
+#pragma once
+#include "song.h"
+#include "sortkey.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <future>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Finds songs by any part of their title, artist, album, genre or charters,
+// fast enough to run on every key press. Each song's fields are folded with
+// SortKey and broken into grams: every three bytes, plus the first one and
+// two bytes of every word along with which field it starts. A gram maps to
+// the sorted list of songs that have it, so a query only looks at songs that
+// have every gram of every word in it. Songs are numbered the same as
+// SongList::songs.
+class SongSearch
+{
+public:
+    enum Field {
+        FieldTitle,
+        FieldArtist,
+        FieldAlbum,
+        FieldGenre,
+        FieldCharter,
+        FieldCount
+    };
+
+    // indexes songs on a background thread; anything else waits for it
+    void Build(const std::vector<SongMetadata>& songs) {
+        std::vector<Document> documents;
+        documents.reserve(songs.size());
+        for (const SongMetadata& song : songs)
+            documents.push_back(DocumentOf(song));
+        building = std::async(std::launch::async, [](std::vector<Document> documents) {
+            Index index;
+            index.documents = std::move(documents);
+            std::vector<uint32_t> grams;
+            for (int song = 0; song < index.documents.size(); song++) {
+                GramsOf(index.documents[song], grams);
+                for (uint32_t gram : grams)
+                    index.postings[gram].push_back(song);
+            }
+            return index;
+        }, std::move(documents));
+    }
+
+    // reindexes song, or adds it if it is one past the last
+    void Set(int song, const SongMetadata& data) {
+        finishBuild();
+        if (song < index.documents.size())
+            unindex(song);
+        else
+            index.documents.emplace_back();
+        index.documents[song] = DocumentOf(data);
+        reindex(song);
+    }
+
+    // takes song out by moving the last song into its place, like the song
+    // list does
+    void RemoveSwap(int song) {
+        finishBuild();
+        int last = (int)index.documents.size() - 1;
+        unindex(song);
+        if (song != last) {
+            unindex(last);
+            index.documents[song] = std::move(index.documents[last]);
+            reindex(song);
+        }
+        index.documents.pop_back();
+    }
+
+    // songs that have every word of query somewhere, best first: a word
+    // ranks higher at the start of a field, then at the start of a word,
+    // and in the title over the artist, and so on down the fields
+    std::vector<int> Query(std::string_view query) {
+        finishBuild();
+        // words shorter than a gram can only match the start of a word
+        std::vector<std::string> shortTerms;
+        std::vector<std::string> longTerms;
+        std::string key = SortKey::Of(query, false);
+        for (size_t start = 0; start < key.size();) {
+            size_t end = std::min(key.find(' ', start), key.size());
+            if (end - start >= 3)
+                longTerms.push_back(key.substr(start, end - start));
+            else if (end > start)
+                shortTerms.push_back(key.substr(start, end - start));
+            start = end + 1;
+        }
+        if (shortTerms.empty() && longTerms.empty())
+            return {};
+
+        // word starts are indexed by field, so short words are scored
+        // straight from their postings, best place first
+        std::vector<int> scores(index.documents.size(), 0);
+        std::vector<int> matched(index.documents.size(), 0);
+        std::vector<int> candidates;
+        for (int term = 0; term < shortTerms.size(); term++) {
+            for (int place = 0; place < FieldCount * 2; place++) {
+                auto posting = index.postings.find(WordStartGram(shortTerms[term], 0, shortTerms[term].size(), place));
+                if (posting == index.postings.end())
+                    continue;
+                for (int song : posting->second) {
+                    // skip songs missing an earlier word, or already scored
+                    if (matched[song] != term)
+                        continue;
+                    matched[song] = term + 1;
+                    scores[song] += place / 2 * 3 + place % 2;
+                    if (term + 1 == shortTerms.size() && longTerms.empty())
+                        candidates.push_back(song);
+                }
+            }
+        }
+
+        bool first = true;
+        for (const std::string& term : longTerms) {
+            for (size_t i = 0; i + 3 <= term.size(); i++) {
+                auto posting = index.postings.find(Gram(term, i, 3));
+                if (posting == index.postings.end())
+                    return {};
+                if (first) {
+                    candidates = posting->second;
+                    first = false;
+                } else {
+                    std::vector<int> both;
+                    std::set_intersection(candidates.begin(), candidates.end(), posting->second.begin(),
+                                          posting->second.end(), std::back_inserter(both));
+                    candidates = std::move(both);
+                }
+                if (candidates.empty())
+                    return {};
+            }
+        }
+
+        // a long word's grams can come from different places, so check the
+        // word itself is there
+        int found = 0;
+        for (int song : candidates) {
+            if (matched[song] != shortTerms.size())
+                continue;
+            for (const std::string& term : longTerms) {
+                int termScore = Score(index.documents[song], term);
+                if (termScore < 0) {
+                    scores[song] = -1;
+                    break;
+                }
+                scores[song] += termScore;
+            }
+            if (scores[song] >= 0)
+                candidates[found++] = song;
+        }
+        candidates.resize(found);
+
+        // scores are small, so they're counted into buckets rather than sorted
+        std::vector<int> buckets((shortTerms.size() + longTerms.size()) * FieldCount * 3 + 1);
+        for (int song : candidates)
+            buckets[scores[song]]++;
+        int start = 0;
+        for (int& bucket : buckets) {
+            int count = bucket;
+            bucket = start;
+            start += count;
+        }
+        std::vector<int> songs(candidates.size());
+        for (int song : candidates)
+            songs[buckets[scores[song]]++] = song;
+        return songs;
+    }
+
+private:
+    // the fields one after another, each followed by a space, so a search
+    // word can't run from one into the next
+    struct Document {
+        std::string text;
+        std::array<uint32_t, FieldCount> ends;
+    };
+    struct Index {
+        std::vector<Document> documents;
+        std::unordered_map<uint32_t, std::vector<int>> postings;
+    };
+
+    Index index;
+    std::future<Index> building;
+
+    void finishBuild() {
+        if (building.valid())
+            index = building.get();
+    }
+
+    static Document DocumentOf(const SongMetadata& song) {
+        Document document;
+        auto add = [&document](int field, std::string_view text) {
+            document.text += SortKey::Of(text, false);
+            document.text += ' ';
+            document.ends[field] = document.text.size();
+        };
+        add(FieldTitle, song.title);
+        add(FieldArtist, song.artist);
+        add(FieldAlbum, song.album);
+        add(FieldGenre, song.genre);
+        document.ends[FieldCharter] = document.text.size();
+        for (std::string_view charters = song.charters; !charters.empty();) {
+            size_t end = std::min(charters.find('\n'), charters.size());
+            add(FieldCharter, charters.substr(0, end));
+            charters.remove_prefix(std::min(end + 1, charters.size()));
+        }
+        return document;
+    }
+
+    // the length goes in the top byte, so grams of different lengths differ
+    static uint32_t Gram(std::string_view text, size_t at, size_t length) {
+        uint32_t gram = (uint32_t)length << 24;
+        for (size_t i = 0; i < length; i++)
+            gram |= (uint32_t)(unsigned char)text[at + i] << (8 * (length - 1 - i));
+        return gram;
+    }
+
+    // the first one or two bytes of a word, and where it is: the field times
+    // two, plus one if it isn't the first word of the field
+    static uint32_t WordStartGram(std::string_view text, size_t at, size_t length, int place) {
+        return Gram(text, at, length) | (uint32_t)place << 16;
+    }
+
+    static void GramsOf(const Document& document, std::vector<uint32_t>& grams) {
+        grams.clear();
+        const std::string& text = document.text;
+        int field = 0;
+        for (size_t i = 0; i < text.size(); i++) {
+            while (i >= document.ends[field])
+                field++;
+            if (i + 3 <= text.size())
+                grams.push_back(Gram(text, i, 3));
+            if (text[i] != ' ' && (i == 0 || text[i - 1] == ' ')) {
+                size_t start = field == 0 ? 0 : document.ends[field - 1];
+                int place = field * 2 + (i == start ? 0 : 1);
+                grams.push_back(WordStartGram(text, i, 1, place));
+                grams.push_back(WordStartGram(text, i, 2, place));
+            }
+        }
+        std::sort(grams.begin(), grams.end());
+        grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+    }
+
+    // lower is better; -1 if the term isn't in any field
+    static int Score(const Document& document, std::string_view term) {
+        std::string_view text = document.text;
+        size_t at = text.find(term);
+        if (at == std::string_view::npos)
+            return -1;
+        int field = 0;
+        while (at >= document.ends[field])
+            field++;
+        size_t start = field == 0 ? 0 : document.ends[field - 1];
+        auto kind = [&](size_t at) { return at == start ? 0 : text[at - 1] == ' ' ? 1 : 2; };
+        int best = kind(at);
+        // later fields rank lower, so only the rest of this one can do better
+        std::string_view rest = text.substr(0, document.ends[field]);
+        for (at = rest.find(term, at + 1); best > 0 && at != std::string_view::npos; at = rest.find(term, at + 1))
+            best = std::min(best, kind(at));
+        return field * 3 + best;
+    }
+
+    void unindex(int song) {
+        std::vector<uint32_t> grams;
+        GramsOf(index.documents[song], grams);
+        for (uint32_t gram : grams) {
+            auto posting = index.postings.find(gram);
+            if (posting == index.postings.end())
+                continue;
+            auto it = std::lower_bound(posting->second.begin(), posting->second.end(), song);
+            if (it != posting->second.end() && *it == song)
+                posting->second.erase(it);
+            if (posting->second.empty())
+                index.postings.erase(posting);
+        }
+    }
+
+    void reindex(int song) {
+        std::vector<uint32_t> grams;
+        GramsOf(index.documents[song], grams);
+        for (uint32_t gram : grams) {
+            std::vector<int>& songs = index.postings[gram];
+            songs.insert(std::lower_bound(songs.begin(), songs.end(), song), song);
+        }
+    }
+};
@@ -0,0 +1,84 @@
+#pragma once
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+// Where the song list keeps the text of every song. Strings are copied one
+// after another into big chunks and never freed on their own; the whole lot
+// goes at once when the list that owns it does, like on a rescan. Artists,
+// albums, genres and charters repeat a lot across a library, so those are
+// interned and every song with the same one points at the same copy. Every
+// copy ends in a null, so it can go straight to raylib with data(). Safe to
+// add to from several threads, as the scanner's workers do.
+class SongStrings
+{
+public:
+    SongStrings() = default;
+    SongStrings(const SongStrings&) = delete;
+    SongStrings& operator=(const SongStrings&) = delete;
+
+    // a copy of text that lives as long as this does
+    std::string_view Add(std::string_view text) {
+        if (text.empty())
+            return "";
+        std::lock_guard<std::mutex> lock(mutex);
+        return copy(text);
+    }
+
+    // the same as Add, except text that was interned before comes back as
+    // the copy made then
+    std::string_view Intern(std::string_view text) {
+        if (text.empty())
+            return "";
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = interned.find(text);
+        if (it != interned.end())
+            return *it;
+        std::string_view added = copy(text);
+        interned.insert(added);
+        return added;
+    }
+
+    // bytes of text held, for the log
+    size_t Size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return size;
+    }
+
+private:
+    static constexpr size_t chunkSize = 256 * 1024;
+
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<char[]>> chunks;
+    char* next = nullptr;
+    size_t left = 0;
+    size_t size = 0;
+    std::unordered_set<std::string_view> interned;
+
+    std::string_view copy(std::string_view text) {
+        size_t length = text.size() + 1;
+        char* start;
+        if (length > chunkSize) {
+            // anything too long for a chunk gets one of its own
+            chunks.push_back(std::make_unique_for_overwrite<char[]>(length));
+            start = chunks.back().get();
+        } else {
+            if (length > left) {
+                chunks.push_back(std::make_unique_for_overwrite<char[]>(chunkSize));
+                next = chunks.back().get();
+                left = chunkSize;
+            }
+            start = next;
+            next += length;
+            left -= length;
+        }
+        memcpy(start, text.data(), text.size());
+        start[text.size()] = '\0';
+        size += length;
+        return std::string_view(start, text.size());
+    }
+};
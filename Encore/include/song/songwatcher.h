@@ -0,0 +1,101 @@
+#pragma once
+#include "song.h"
+#include "filestamp.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Songs that appeared, changed or went away in the song folders.
+struct SongListUpdate {
+	std::vector<SongMetadata> changedSongs;
+	// where changedSongs' text lives
+	std::shared_ptr<SongStrings> strings;
+	std::vector<std::string> removedSongDirs;
+
+	bool empty() const { return changedSongs.empty() && removedSongDirs.empty(); }
+};
+
+// Watches the song folders for songs being added, changed or removed, and
+// loads just those songs on a background thread. Uses inotify on Linux, and
+// falls back to polling the folder and info.json stamps elsewhere, or when
+// inotify runs out of watches. Polling only notices a changed MIDI along with
+// its info.json. Changes are journaled into the song cache and queued for the
+// song list to pick up with TakeUpdate.
+class SongWatcher
+{
+public:
+	static SongWatcher& getInstance() {
+		static SongWatcher instance;
+		return instance;
+	}
+
+	~SongWatcher() { Stop(); }
+
+	// songs are the ones already in the list
+	void Start(const std::vector<std::filesystem::path>& songsFolder, const std::vector<SongMetadata>& songs);
+	void Stop();
+	bool IsRunning() const { return running; }
+
+	// moves everything found since the last call into update; never blocks
+	bool TakeUpdate(SongListUpdate& update);
+
+private:
+	SongWatcher() = default;
+
+	// how long the folders have to be quiet before changes are loaded, so a
+	// song being copied in is picked up once, after its last file lands
+	static constexpr std::chrono::milliseconds settleTime{ 750 };
+	// load anyway after this long, for folders that never go quiet
+	static constexpr std::chrono::milliseconds maxDelay{ 5000 };
+	static constexpr std::chrono::milliseconds pollInterval{ 2000 };
+	// when polling, info.json files are checked on every nth folder poll
+	static constexpr int songPollEvery = 5;
+
+	std::thread thread;
+	std::atomic<bool> running = false;
+
+	std::mutex updateMutex;
+	SongListUpdate pending;
+
+	// only touched by the watcher thread once it is started
+	std::vector<std::filesystem::path> roots;
+	std::vector<FileStamp> rootStamps;
+	struct SongStamps {
+		FileStamp json;
+		FileStamp midi;
+	};
+	// song folder to the stamps of its info.json and MIDI
+	std::map<std::string, SongStamps> known;
+	// roots to list again, and roots that only need their stamp updated
+	// because the events already said which song folders changed
+	std::set<std::filesystem::path> dirtyRoots;
+	std::set<std::filesystem::path> touchedRoots;
+	std::set<std::filesystem::path> dirtySongs;
+	bool pollRoots = true;
+	bool pollSongs = true;
+	int notifyFd = -1;
+	// watch descriptor to the folder it watches
+	std::unordered_map<int, std::filesystem::path> watchDirs;
+	std::unordered_map<std::string, int> dirWatches;
+	std::set<int> rootWatches;
+
+	void run();
+	bool openNotify();
+	void closeNotify();
+	void watchRoot(const std::filesystem::path& root);
+	void watchSong(const std::filesystem::path& songDir);
+	void unwatchSong(const std::filesystem::path& songDir);
+	// waits up to timeout for events; true if any arrived
+	bool readNotify(std::chrono::milliseconds timeout);
+	void pollStamps(bool songsToo);
+	void process();
+	void publish(SongListUpdate& update);
+};
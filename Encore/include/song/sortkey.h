@@ -0,0 +1,112 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Keys that put song names in the order people expect when compared byte by
+// byte: case folded, with the accents taken off Latin letters, and for titles
+// and artists without a leading "the", "a" or "an". Greek and Cyrillic are
+// case folded; anything else is compared as it is.
+struct SortKey {
+    static std::string Of(std::string_view text, bool stripArticle) {
+        std::string key;
+        key.reserve(text.size());
+        size_t i = 0;
+        while (i < text.size()) {
+            size_t start = i;
+            uint32_t cp = Decode(text, i);
+            if (cp < 0x80) {
+                key += (char)(cp >= 'A' && cp <= 'Z' ? cp + ('a' - 'A') : cp);
+                continue;
+            }
+            if (i - start == 1) {
+                key += (char)cp; // not UTF-8, keep the byte
+                continue;
+            }
+            if (cp >= 0x300 && cp < 0x370)
+                continue; // combining accents, from decomposed text
+            char base = Base(cp);
+            if (base != 0) {
+                key += base;
+                continue;
+            }
+            if ((cp >= 0x391 && cp <= 0x3A9) || (cp >= 0x410 && cp <= 0x42F))
+                cp += 0x20;
+            else if (cp >= 0x400 && cp <= 0x40F)
+                cp += 0x50;
+            else {
+                key.append(text.substr(start, i - start));
+                continue;
+            }
+            Encode(cp, key);
+        }
+        if (stripArticle) {
+            for (std::string_view article : { "the ", "a ", "an " }) {
+                if (key.size() > article.size() && key.compare(0, article.size(), article) == 0) {
+                    key.erase(0, article.size());
+                    break;
+                }
+            }
+        }
+        return key;
+    }
+
+    // the first character of a key, upper cased if it's a Latin letter
+    static std::string Initial(std::string_view key) {
+        if (key.empty())
+            return "#";
+        size_t end = 0;
+        Decode(key, end);
+        std::string initial(key.substr(0, end));
+        if (initial.size() == 1 && initial[0] >= 'a' && initial[0] <= 'z')
+            initial[0] -= 'a' - 'A';
+        return initial;
+    }
+
+private:
+    // invalid bytes come back as themselves, one at a time
+    static uint32_t Decode(std::string_view text, size_t& i) {
+        unsigned char lead = text[i++];
+        int extra = lead >= 0xF0 ? 3 : lead >= 0xE0 ? 2 : lead >= 0xC0 ? 1 : 0;
+        if (extra == 0 || i + extra > text.size())
+            return lead;
+        uint32_t cp = lead & (0x3F >> extra);
+        for (int k = 0; k < extra; k++) {
+            unsigned char next = text[i + k];
+            if ((next & 0xC0) != 0x80)
+                return lead;
+            cp = cp << 6 | (next & 0x3F);
+        }
+        i += extra;
+        return cp;
+    }
+
+    static void Encode(uint32_t cp, std::string& out) {
+        if (cp < 0x800) {
+            out += (char)(0xC0 | cp >> 6);
+        } else {
+            out += (char)(0xE0 | cp >> 12);
+            out += (char)(0x80 | (cp >> 6 & 0x3F));
+        }
+        out += (char)(0x80 | (cp & 0x3F));
+    }
+
+    // the unaccented letter for Latin-1 and Latin Extended-A, or 0
+    static char Base(uint32_t cp) {
+        // U+00C0 to U+00FF; '*' are the multiplication and division signs
+        static constexpr std::string_view latin1 =
+            "aaaaaaaceeeeiiiidnooooo*ouuuuyts"
+            "aaaaaaaceeeeiiiidnooooo*ouuuuyty";
+        // U+0100 to U+017F
+        static constexpr std::string_view extendedA =
+            "aaaaaaccccccccddddeeeeeeeeeegggggggghhhhiiiiiiiiiiiijjkkklllllll"
+            "lllnnnnnnnnnoooooooorrrrrrssssssssttttttuuuuuuuuuuuuwwyyyzzzzzzs";
+        static_assert(latin1.size() == 64 && extendedA.size() == 128);
+        char base = 0;
+        if (cp >= 0xC0 && cp < 0x100)
+            base = latin1[cp - 0xC0];
+        else if (cp >= 0x100 && cp < 0x180)
+            base = extendedA[cp - 0x100];
+        return base == '*' ? 0 : base;
+    }
+};
@@ -10,6 +10,7 @@
 #endif
 
 #include "GLFW/glfw3native.h"
+#include <algorithm>
 #include <vector>
 #include <filesystem>
 #include <iostream>
@@ -23,15 +24,37 @@
     } \
 }
 
-bool AudioManager::Init() {
+namespace {
+    // data is 0 when the stream runs dry, and 1 when it starts again
+    void CALLBACK StreamStalled(HSYNC, DWORD, DWORD data, void* user) {
+        if (data == 0)
+            static_cast<std::atomic<int>*>(user)->fetch_add(1);
+    }
+}
+
+bool AudioManager::Init(bool lowLatency, int bufferMS) {
+    DWORD freq = 44100;
+    DWORD flags = 0;
+    if (lowLatency) {
+        // the device buffer is only read by BASS_Init. The stream buffers
+        // have to stay longer than the period they're topped up at
+        bufferMS = std::clamp(bufferMS, 10, 500);
+        BASS_SetConfig(BASS_CONFIG_DEV_BUFFER, bufferMS);
+        BASS_SetConfig(BASS_CONFIG_UPDATEPERIOD, std::max(bufferMS / 4, 5));
+        BASS_SetConfig(BASS_CONFIG_BUFFER, bufferMS * 2);
+        // most devices run at 48 kHz, so asking for it saves resampling
+        // in the driver
+        freq = 48000;
+        flags = BASS_DEVICE_FREQ;
+    }
 #ifdef WIN32
-    if (!BASS_Init(-1, 44100, 0, glfwGetWin32Window(glfwGetCurrentContext()), NULL)) {
+    if (!BASS_Init(-1, freq, flags, glfwGetWin32Window(glfwGetCurrentContext()), NULL)) {
         CHECK_BASS_ERROR();
     }
     BASS_PluginLoad("bassopus", 0);
     CHECK_BASS_ERROR();
 #else
-    if (!BASS_Init(-1, 44100, 0, 0, NULL)) {
+    if (!BASS_Init(-1, freq, flags, 0, NULL)) {
         CHECK_BASS_ERROR();
     }
 #ifdef __APPLE__
@@ -42,80 +65,100 @@ bool AudioManager::Init() {
     CHECK_BASS_ERROR();
 #endif
 
+    BASS_INFO info;
+    if (BASS_GetInfo(&info)) {
+        outputLatency = info.latency / 1000.0;
+        std::cout << "Audio output: " << info.freq << " Hz, " << info.latency << " ms latency, "
+                  << info.minbuf << " ms minimum buffer" << (lowLatency ? " (low latency)" : "") << std::endl;
+    }
+    // normal mode leaves the latency to the calibrated offsets, like before
+    if (lowLatency)
+        songClock.SetOutputLatency(outputLatency);
+
     return true;
 }
 
-void AudioManager::loadStreams(std::vector<std::pair<std::string, int>>& paths) {
-    int streams = 0;
-    for (auto& path : paths) {
-        HSTREAM streamHandle = BASS_StreamCreateFile(false, path.first.c_str(), 0, 0, 0);
-        if (streamHandle) {
-            loadedStreams.push_back({ streamHandle, path.second });
-            if (streams != 0) {
-                BASS_ChannelSetLink(loadedStreams[0].handle, loadedStreams[streams].handle);
-            }
-            streams++;
-        } else {
-            std::cerr << "Failed to load stream: " << path.first << std::endl;
-        }
-    }
+void AudioManager::loadStreams(std::vector<std::pair<std::string, int>>& paths, bool stemCache) {
+    underruns = 0;
+    std::vector<std::string> files;
+    for (auto& path : paths)
+        files.push_back(path.first);
+    std::vector<int> kept = mixer.Load(files, stemCache);
+    for (int stem = 0; stem < kept.size(); stem++)
+        loadedStreams.push_back({ mixer.StemHandle(stem), paths[kept[stem]].second });
+    if (mixer.Output())
+        BASS_ChannelSetSync(mixer.Output(), BASS_SYNC_STALL, 0, StreamStalled, &underruns);
+    songClock.Set(0, false);
+    songClock.ResetStats();
 }
 
 void AudioManager::unloadStreams() {
     if (!loadedStreams.empty()) {
-        for (auto& stream : loadedStreams) {
-            StopPlayback(stream.handle);
-            BASS_StreamFree(stream.handle);
-        }
+        StopPlayback();
+        mixer.Unload();
         loadedStreams = {};
         loadedStreams.clear();
     }
+    songClock.Set(0, false);
 }
 
 void AudioManager::pauseStreams() {
-    if (!loadedStreams.empty()) {
-        BASS_ChannelPause(loadedStreams[0].handle);
+    if (mixer.Output()) {
+        BASS_ChannelPause(mixer.Output());
+        songClock.Set(GetMusicTimePlayed(), false);
     }
 }
 
 void AudioManager::playStreams() {
-    if (!loadedStreams.empty()) {
-        BASS_ChannelPlay(loadedStreams[0].handle, false);
+    if (mixer.Output()) {
+        BASS_ChannelPlay(mixer.Output(), false);
+        songClock.Set(GetMusicTimePlayed(), true);
     }
 }
 
 void AudioManager::restartStreams() {
-    if (!loadedStreams.empty()) {
-        for (auto& stream : loadedStreams) {
-            BASS_ChannelSetPosition(stream.handle, 0, BASS_POS_BYTE);
-        }
-        BASS_ChannelPlay(loadedStreams[0].handle, true);
+    if (mixer.Output()) {
+        BASS_ChannelPause(mixer.Output());
+        mixer.Seek(0);
+        BASS_ChannelPlay(mixer.Output(), false);
+        songClock.Set(0, true);
     }
 }
 
 void AudioManager::unpauseStreams() {
-    if (!loadedStreams.empty()) {
-        for (auto& stream : loadedStreams) {
-            int rewindTimeBytes = BASS_ChannelSeconds2Bytes(stream.handle, 3.0);
-            int channelPositionBytes = BASS_ChannelGetPosition(stream.handle, BASS_POS_BYTE);
-
-            int position = channelPositionBytes <= rewindTimeBytes ? 0 : channelPositionBytes - rewindTimeBytes;
-
-            BASS_ChannelSetPosition(stream.handle, position, BASS_POS_BYTE);
-        }
-        BASS_ChannelPlay(loadedStreams[0].handle, false);
+    if (mixer.Output()) {
+        mixer.Seek(std::max(GetMusicTimePlayed() - 3.0, 0.0));
+        BASS_ChannelPlay(mixer.Output(), false);
+        songClock.Set(GetMusicTimePlayed(), true);
     }
 }
 
-double AudioManager::GetMusicTimePlayed(unsigned int handle) {
-    return BASS_ChannelBytes2Seconds(handle, BASS_ChannelGetPosition(handle, BASS_POS_BYTE));
+double AudioManager::GetMusicTimePlayed() {
+    return mixer.Position();
+}
+
+double AudioManager::GetMusicTimeLength() {
+    return mixer.Length();
 }
 
-double AudioManager::GetMusicTimeLength(unsigned int handle) {
-    return BASS_ChannelBytes2Seconds(handle, BASS_ChannelGetLength(handle, BASS_POS_BYTE));
+void AudioManager::UpdateSongClock() {
+    if (!mixer.Output() || !songClock.Update(SongClock::Clock::now()))
+        return;
+    // the reading could have been taken anywhere in the call, so it goes
+    // down as the middle of it
+    SongClock::Clock::time_point before = SongClock::Clock::now();
+    double position = GetMusicTimePlayed();
+    SongClock::Clock::time_point after = SongClock::Clock::now();
+    songClock.Sample(position, before + (after - before) / 2);
 }
 
 void AudioManager::SetAudioStreamVolume(unsigned int handle, float volume) {
+    for (int stem = 0; stem < loadedStreams.size(); stem++) {
+        if (loadedStreams[stem].handle == handle) {
+            mixer.SetGain(stem, volume);
+            return;
+        }
+    }
     BASS_ChannelSetAttribute(handle, BASS_ATTRIB_VOL, volume);
 }
 
@@ -123,12 +166,18 @@ void AudioManager::UpdateMusicStream(unsigned int handle) {
     BASS_ChannelUpdate(handle, 0);
 }
 
-void AudioManager::BeginPlayback(unsigned int handle) {
-    BASS_ChannelStart(handle);
+void AudioManager::BeginPlayback() {
+    if (!mixer.Output())
+        return;
+    BASS_ChannelStart(mixer.Output());
+    songClock.Set(GetMusicTimePlayed(), true);
 }
 
-void AudioManager::StopPlayback(unsigned int handle) {
-    BASS_ChannelStop(handle);
+void AudioManager::StopPlayback() {
+    if (!mixer.Output())
+        return;
+    BASS_ChannelStop(mixer.Output());
+    songClock.Set(GetMusicTimePlayed(), false);
 }
 
 void AudioManager::loadSample(const std::string& path, const std::string& name) {
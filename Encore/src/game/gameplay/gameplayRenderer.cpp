@@ -20,6 +20,8 @@ Units& gprU = Units::getInstance();
 
 
 void gameplayRenderer::RenderNotes(Player& player, Chart& curChart, double time, RenderTexture2D &notes_tex, float length) {
+	ChartNotes &notes = curChart.notes;
+	NoteStates &noteStates = curChart.noteStates;
 	float diffDistance = player.diff == 3 ? 2.0f : 1.5f;
 	float lineDistance = player.diff == 3 ? 1.5f : 1.0f;
 
@@ -28,6 +30,9 @@ void gameplayRenderer::RenderNotes(Player& player, Chart& curChart, double time,
 	BeginMode3D(camera3pVector[cameraSel]);
 	// glDisable(GL_CULL_FACE);
 	for (int lane = 0; lane < (player.diff == 3 ? 5 : 4); lane++) {
+		// each lane walks its notes in time order
+		PhraseCursor odCursor = curChart.phrases.cursor(PhraseOverdrive);
+		PhraseCursor soloCursor = curChart.phrases.cursor(PhraseSolo);
 		for (int i = curNoteIdx[lane]; i < curChart.notes_perlane[lane].size(); i++) {
 			Color NoteColor;
 			if (player.plastic) {
@@ -77,91 +82,86 @@ void gameplayRenderer::RenderNotes(Player& player, Chart& curChart, double time,
 			}
 
 			// Color NoteColor = gprMenu.hehe && player.diff == 3 ? (lane == 0 || lane == 4 ? SKYBLUE : (lane == 1 || lane == 3 ? PINK : WHITE)) : player.accentColor;
-			Note & curNote = curChart.notes[curChart.notes_perlane[lane][i]];
-			if (curNote.hit) {
-				player.totalOffset += curNote.HitOffset;
+			int curNote = curChart.notes_perlane[lane][i];
+			if (noteStates.is(curNote, NoteHit)) {
+				player.totalOffset += noteStates.hitOffset(curNote);
 			}
 			gprAssets.liftModel.materials[0].maps[MATERIAL_MAP_ALBEDO].color = NoteColor;
 
 			gprAssets.noteTopModel.materials[0].maps[MATERIAL_MAP_ALBEDO].color = NoteColor;
 			gprAssets.noteBottomModel.materials[0].maps[MATERIAL_MAP_ALBEDO].color = WHITE;
-			if (!curChart.Solos.empty()) {
-				if (curNote.time >= curChart.Solos[curSolo].start &&
-					curNote.time <= curChart.Solos[curSolo].end) {
-					if (curNote.hit) {
-						if (curNote.hit && !curNote.countedForSolo) {
-							curChart.Solos[curSolo].notesHit++;
-							curNote.countedForSolo = true;
-						}
+			int soloPhrase = soloCursor.at(notes.time[curNote], true);
+			if (soloPhrase != -1) {
+				if (noteStates.is(curNote, NoteHit)) {
+					if (noteStates.is(curNote, NoteHit) && !noteStates.is(curNote, NoteCountedForSolo)) {
+						curChart.Solos[soloPhrase].notesHit++;
+						noteStates.set(curNote, NoteCountedForSolo);
 					}
 				}
 			}
-			if (!curChart.odPhrases.empty()) {
-
-				if (curNote.time >= curChart.odPhrases[curODPhrase].start &&
-					curNote.time < curChart.odPhrases[curODPhrase].end &&
-					!curChart.odPhrases[curODPhrase].missed) {
-					if (curNote.hit) {
-						if (curNote.hit && !curNote.countedForODPhrase) {
-							curChart.odPhrases[curODPhrase].notesHit++;
-							curNote.countedForODPhrase = true;
+			int odPhrase = odCursor.at(notes.time[curNote]);
+			if (odPhrase != -1) {
+
+				if (!curChart.odPhrases[odPhrase].missed) {
+					if (noteStates.is(curNote, NoteHit)) {
+						if (noteStates.is(curNote, NoteHit) && !noteStates.is(curNote, NoteCountedForODPhrase)) {
+							curChart.odPhrases[odPhrase].notesHit++;
+							noteStates.set(curNote, NoteCountedForODPhrase);
 						}
 					}
-					curNote.renderAsOD = true;
+					noteStates.set(curNote, NoteRenderAsOD);
 
 				}
-				if (curChart.odPhrases[curODPhrase].missed) {
-					curNote.renderAsOD = false;
+				if (curChart.odPhrases[odPhrase].missed) {
+					noteStates.unset(curNote, NoteRenderAsOD);
 				}
-				if (curChart.odPhrases[curODPhrase].notesHit ==
-					curChart.odPhrases[curODPhrase].noteCount &&
-					!curChart.odPhrases[curODPhrase].added && player.overdriveFill < 1.0f) {
+				if (curChart.odPhrases[odPhrase].notesHit ==
+					curChart.odPhrases[odPhrase].noteCount &&
+					!curChart.odPhrases[odPhrase].added && player.overdriveFill < 1.0f) {
 					player.overdriveFill += 0.25f;
 					if (player.overdriveFill > 1.0f) player.overdriveFill = 1.0f;
 					if (player.overdrive) {
 						player.overdriveActiveFill = player.overdriveFill;
 						player.overdriveActiveTime = time;
 					}
-					curChart.odPhrases[curODPhrase].added = true;
+					curChart.odPhrases[odPhrase].added = true;
 				}
 			}
-			if (!curNote.hit && !curNote.accounted && curNote.time + goodBackend + player.InputOffset < time && !songEnded) {
-				curNote.miss = true;
+			if (!noteStates.is(curNote, NoteHit) && !noteStates.is(curNote, NoteAccounted) && notes.time[curNote] + goodBackend + player.InputOffset < time && !songEnded) {
+				noteStates.set(curNote, NoteMiss);
 				player.MissNote();
-				if (!curChart.odPhrases.empty() && !curChart.odPhrases[curODPhrase].missed &&
-					curNote.time >= curChart.odPhrases[curODPhrase].start &&
-					curNote.time < curChart.odPhrases[curODPhrase].end)
-					curChart.odPhrases[curODPhrase].missed = true;
+				if (odPhrase != -1 && !curChart.odPhrases[odPhrase].missed)
+					curChart.odPhrases[odPhrase].missed = true;
 				player.combo = 0;
-				curNote.accounted = true;
+				noteStates.set(curNote, NoteAccounted);
 			} else if (bot) {
-				if (!curNote.hit && !curNote.accounted && curNote.time < time &&
+				if (!noteStates.is(curNote, NoteHit) && !noteStates.is(curNote, NoteAccounted) && notes.time[curNote] < time &&
 					curNoteInt < curChart.notes.size() && !songEnded) {
-					curNote.hit = true;
-					if (curNote.len > 0) curNote.held = true;
-					curNote.accounted = true;
+					noteStates.set(curNote, NoteHit);
+					if (notes.len[curNote] > 0) noteStates.set(curNote, NoteHeld);
+					noteStates.set(curNote, NoteAccounted);
 					player.combo++;
-					curNote.accounted = true;
-					curNote.hitTime = time;
+					noteStates.set(curNote, NoteAccounted);
+					noteStates.hitTime(curNote) = time;
 				}
 			}
 
-			double relTime = ((curNote.time - time)) *
+			double relTime = ((notes.time[curNote] - time)) *
 							 gprSettings.trackSpeedOptions[gprSettings.trackSpeed] * (11.5f / length);
-			double relEnd = (((curNote.time + curNote.len) - time)) *
+			double relEnd = (((notes.time[curNote] + notes.len[curNote]) - time)) *
 							gprSettings.trackSpeedOptions[gprSettings.trackSpeed] * (11.5f / length);
 			float notePosX = diffDistance - (1.0f *
 											 (float) (gprSettings.mirrorMode ? (player.diff == 3 ? 4 : 3) -
-																			   curNote.lane
-																			 : curNote.lane));
+																			   notes.lane[curNote]
+																			 : notes.lane[curNote]));
 			if (relTime > 1.5) {
 				break;
 			}
 			if (relEnd > 1.5) relEnd = 1.5;
-			if (curNote.lift && !curNote.hit && !curNote.miss) {
+			if (notes.is(curNote, NoteLift) && !noteStates.is(curNote, NoteHit) && !noteStates.is(curNote, NoteMiss)) {
 				// lifts						//  distance between notes
 				//									(furthest left - lane distance)
-				if (curNote.renderAsOD)                    //  1.6f	0.8
+				if (noteStates.is(curNote, NoteRenderAsOD))                    //  1.6f	0.8
 					DrawModel(gprAssets.liftModelOD, Vector3{notePosX, 0, player.smasherPos +
 																		  (length *
 																		   (float) relTime)}, 1.1f, WHITE);
@@ -173,14 +173,14 @@ void gameplayRenderer::RenderNotes(Player& player, Chart& curChart, double time,
 				// regular
 			} else {
 				// sustains
-				if ((curNote.len) > 0) {
-					if (curNote.hit && curNote.held) {
-						if (curNote.heldTime <
-							(curNote.len * gprSettings.trackSpeedOptions[gprSettings.trackSpeed])) {
-							curNote.heldTime = 0.0 - relTime;
+				if ((notes.len[curNote]) > 0) {
+					if (noteStates.is(curNote, NoteHit) && noteStates.is(curNote, NoteHeld)) {
+						if (noteStates.heldTime(curNote) <
+							(notes.len[curNote] * gprSettings.trackSpeedOptions[gprSettings.trackSpeed])) {
+							noteStates.heldTime(curNote) = 0.0 - relTime;
 							if (!bot) {
-								player.sustainScoreBuffer[curNote.lane] =
-										(float) (curNote.heldTime / curNote.len) * (12 * curNote.beatsLen) *
+								player.sustainScoreBuffer[notes.lane[curNote]] =
+										(float) (noteStates.heldTime(curNote) / notes.len[curNote]) * (12 * notes.beatsLen[curNote]) *
 										player.multiplier(player.instrument);
 							}
 							if (relTime < 0.0) relTime = 0.0;
@@ -188,17 +188,17 @@ void gameplayRenderer::RenderNotes(Player& player, Chart& curChart, double time,
 						if (relEnd <= 0.0) {
 							if (relTime < 0.0) relTime = relEnd;
 							if (!bot) {
-								player.score += player.sustainScoreBuffer[curNote.lane];
-								player.sustainScoreBuffer[curNote.lane] = 0;
+								player.score += player.sustainScoreBuffer[notes.lane[curNote]];
+								player.sustainScoreBuffer[notes.lane[curNote]] = 0;
 							}
-							curNote.held = false;
+							noteStates.unset(curNote, NoteHeld);
 						}
-					} else if (curNote.hit && !curNote.held) {
-						relTime = relTime + curNote.heldTime;
+					} else if (noteStates.is(curNote, NoteHit) && !noteStates.is(curNote, NoteHeld)) {
+						relTime = relTime + noteStates.heldTime(curNote);
 					}
 
 					/*Color SustainColor = Color{ 69,69,69,255 };
-					if (curNote.held) {
+					if (noteStates.is(curNote, NoteHeld)) {
 						if (od) {
 							Color SustainColor = Color{ 217, 183, 82 ,255 };
 						}
@@ -217,24 +217,24 @@ void gameplayRenderer::RenderNotes(Player& player, Chart& curChart, double time,
 					gprAssets.sustainMatHeld.maps[MATERIAL_MAP_DIFFUSE].color = ColorBrightness(NoteColor, 0.5f);
 
 
-					if (curNote.held && !curNote.renderAsOD) {
+					if (noteStates.is(curNote, NoteHeld) && !noteStates.is(curNote, NoteRenderAsOD)) {
 						DrawMesh(sustainPlane, gprAssets.sustainMatHeld, sustainMatrix);
 						DrawCube(Vector3{notePosX, 0.1, player.smasherPos}, 0.4f, 0.2f, 0.4f,
 								 player.accentColor);
 						//DrawCylinderEx(Vector3{ notePosX, 0.05f, player.smasherPos + (highwayLength * (float)relTime) }, Vector3{ notePosX,0.05f, player.smasherPos + (highwayLength * (float)relEnd) }, 0.1f, 0.1f, 15, player.accentColor);
 					}
-					if (curNote.renderAsOD && curNote.held) {
+					if (noteStates.is(curNote, NoteRenderAsOD) && noteStates.is(curNote, NoteHeld)) {
 						DrawMesh(sustainPlane, gprAssets.sustainMatHeldOD, sustainMatrix);
 						DrawCube(Vector3{notePosX, 0.1, player.smasherPos}, 0.4f, 0.2f, 0.4f, WHITE);
 						//DrawCylinderEx(Vector3{ notePosX, 0.05f, player.smasherPos + (highwayLength * (float)relTime) }, Vector3{ notePosX,0.05f, player.smasherPos + (highwayLength * (float)relEnd) }, 0.1f, 0.1f, 15, Color{ 255, 255, 255 ,255 });
 					}
-					if (!curNote.held && curNote.hit || curNote.miss) {
+					if (!noteStates.is(curNote, NoteHeld) && noteStates.is(curNote, NoteHit) || noteStates.is(curNote, NoteMiss)) {
 
 						DrawMesh(sustainPlane, gprAssets.sustainMatMiss, sustainMatrix);
 						//DrawCylinderEx(Vector3{ notePosX, 0.05f, player.smasherPos + (highwayLength * (float)relTime) }, Vector3{ notePosX,0.05f, player.smasherPos + (highwayLength * (float)relEnd) }, 0.1f, 0.1f, 15, Color{ 69,69,69,255 });
 					}
-					if (!curNote.hit && !curNote.accounted && !curNote.miss) {
-						if (curNote.renderAsOD) {
+					if (!noteStates.is(curNote, NoteHit) && !noteStates.is(curNote, NoteAccounted) && !noteStates.is(curNote, NoteMiss)) {
+						if (noteStates.is(curNote, NoteRenderAsOD)) {
 							DrawMesh(sustainPlane, gprAssets.sustainMatOD, sustainMatrix);
 							//DrawCylinderEx(Vector3{ notePosX, 0.05f, player.smasherPos + (highwayLength * (float)relTime) }, Vector3{ notePosX,0.05f, player.smasherPos + (highwayLength * (float)relEnd) }, 0.1f, 0.1f, 15, Color{ 200, 200, 200 ,255 });
 						} else {
@@ -248,13 +248,13 @@ void gameplayRenderer::RenderNotes(Player& player, Chart& curChart, double time,
 					}
 					EndBlendMode();
 
-					// DrawLine3D(Vector3{ diffDistance - (1.0f * curNote.lane),0.05f,smasherPos + (12.5f * (float)relTime) }, Vector3{ diffDistance - (1.0f * curNote.lane),0.05f,smasherPos + (12.5f * (float)relEnd) }, Color{ 172,82,217,255 });
+					// DrawLine3D(Vector3{ diffDistance - (1.0f * notes.lane[curNote]),0.05f,smasherPos + (12.5f * (float)relTime) }, Vector3{ diffDistance - (1.0f * notes.lane[curNote]),0.05f,smasherPos + (12.5f * (float)relEnd) }, Color{ 172,82,217,255 });
 				}
 				// regular notes
-				if (((curNote.len) > 0 && (curNote.held || !curNote.hit)) ||
-					((curNote.len) == 0 && !curNote.hit)) {
-					if (curNote.renderAsOD) {
-						if ((!curNote.held && !curNote.miss) && !curNote.hit) {
+				if (((notes.len[curNote]) > 0 && (noteStates.is(curNote, NoteHeld) || !noteStates.is(curNote, NoteHit))) ||
+					((notes.len[curNote]) == 0 && !noteStates.is(curNote, NoteHit))) {
+					if (noteStates.is(curNote, NoteRenderAsOD)) {
+						if ((!noteStates.is(curNote, NoteHeld) && !noteStates.is(curNote, NoteMiss)) && !noteStates.is(curNote, NoteHit)) {
 							DrawModel(gprAssets.noteTopModelOD, Vector3{notePosX, 0, player.smasherPos +
 																					 (length *
 																					  (float) relTime)}, 1.1f,
@@ -266,7 +266,7 @@ void gameplayRenderer::RenderNotes(Player& player, Chart& curChart, double time,
 						}
 
 					} else {
-						if ((!curNote.held && !curNote.miss) && !curNote.hit) {
+						if ((!noteStates.is(curNote, NoteHeld) && !noteStates.is(curNote, NoteMiss)) && !noteStates.is(curNote, NoteHit)) {
 							DrawModel(gprAssets.noteTopModel, Vector3{notePosX, 0, player.smasherPos +
 																				   (length *
 																					(float) relTime)}, 1.1f,
@@ -282,10 +282,10 @@ void gameplayRenderer::RenderNotes(Player& player, Chart& curChart, double time,
 				}
 				gprAssets.expertHighway.materials[0].maps[MATERIAL_MAP_ALBEDO].color = player.accentColor;
 			}
-			if (curNote.miss) {
+			if (noteStates.is(curNote, NoteMiss)) {
 
 
-				if (curNote.lift) {
+				if (notes.is(curNote, NoteLift)) {
 					DrawModel(gprAssets.liftModel,
 							  Vector3{notePosX, 0, player.smasherPos + (length * (float) relTime)},
 							  1.0f, RED);
@@ -299,8 +299,8 @@ void gameplayRenderer::RenderNotes(Player& player, Chart& curChart, double time,
 				}
 
 
-				if (gprAudioManager.GetMusicTimePlayed(gprAudioManager.loadedStreams[0].handle) <
-					curNote.time + 0.4 && gprSettings.missHighwayColor) {
+				if (time <
+					notes.time[curNote] + 0.4 && gprSettings.missHighwayColor) {
 					gprAssets.expertHighway.materials[0].maps[MATERIAL_MAP_ALBEDO].color = RED;
 				} else {
 					gprAssets.expertHighway.materials[0].maps[MATERIAL_MAP_ALBEDO].color = player.accentColor;
@@ -308,25 +308,25 @@ void gameplayRenderer::RenderNotes(Player& player, Chart& curChart, double time,
 			}
 			double HitAnimDuration = 0.15f;
 			double PerfectHitAnimDuration = 1.0f;
-			if (curNote.hit && gprAudioManager.GetMusicTimePlayed(gprAudioManager.loadedStreams[0].handle) <
-							   (curNote.hitTime) + HitAnimDuration) {
+			if (noteStates.is(curNote, NoteHit) && time <
+							   (noteStates.hitTime(curNote)) + HitAnimDuration) {
 
-				double TimeSinceHit = gprAudioManager.GetMusicTimePlayed(gprAudioManager.loadedStreams[0].handle) - curNote.hitTime;
+				double TimeSinceHit = time - noteStates.hitTime(curNote);
 				unsigned char HitAlpha = Remap(getEasingFunction(EaseInBack)(TimeSinceHit/HitAnimDuration), 0, 1.0, 196, 0);
 
 				DrawCube(Vector3{notePosX, 0.125, player.smasherPos}, 1.0f, 0.25f, 0.5f,
-						 curNote.perfect ? Color{255, 215, 0, HitAlpha} : Color{255, 255, 255, HitAlpha});
-				// if (curNote.perfect) {
+						 noteStates.is(curNote, NotePerfect) ? Color{255, 215, 0, HitAlpha} : Color{255, 255, 255, HitAlpha});
+				// if (noteStates.is(curNote, NotePerfect)) {
 				// 	DrawCube(Vector3{3.3f, 0, player.smasherPos}, 1.0f, 0.01f,
 				// 			 0.5f, Color{255,161,0,HitAlpha});
 				// }
 
 
 			}
-			if (curNote.hit && gprAudioManager.GetMusicTimePlayed(gprAudioManager.loadedStreams[0].handle) <
-							(curNote.hitTime) + PerfectHitAnimDuration && curNote.perfect) {
+			if (noteStates.is(curNote, NoteHit) && time <
+							(noteStates.hitTime(curNote)) + PerfectHitAnimDuration && noteStates.is(curNote, NotePerfect)) {
 
-				double TimeSinceHit = gprAudioManager.GetMusicTimePlayed(gprAudioManager.loadedStreams[0].handle) - curNote.hitTime;
+				double TimeSinceHit = time - noteStates.hitTime(curNote);
 				unsigned char HitAlpha = Remap(getEasingFunction(EaseOutQuad)(TimeSinceHit/PerfectHitAnimDuration), 0, 1.0, 255, 0);
 				float HitPosLeft = Remap(getEasingFunction(EaseInOutBack)(TimeSinceHit/PerfectHitAnimDuration), 0, 1.0, 3.4, 3.0);
 
@@ -356,6 +356,8 @@ void gameplayRenderer::RenderNotes(Player& player, Chart& curChart, double time,
 }
 
 void gameplayRenderer::RenderClassicNotes(Player& player, Chart& curChart, double time, RenderTexture2D &notes_tex, float length) {
+	ChartNotes &notes = curChart.notes;
+	NoteStates &noteStates = curChart.noteStates;
 	float diffDistance = 2.0f;
 	float lineDistance = 1.5f;
 	BeginTextureMode(notes_tex);
@@ -363,82 +365,80 @@ void gameplayRenderer::RenderClassicNotes(Player& player, Chart& curChart, doubl
 	BeginMode3D(camera3pVector[cameraSel]);
 	// glDisable(GL_CULL_FACE);
 
+	PhraseCursor odCursor = curChart.phrases.cursor(PhraseOverdrive);
+	PhraseCursor soloCursor = curChart.phrases.cursor(PhraseSolo);
+	for (int curNote = 0; curNote < notes.size(); curNote++) {
 
-	for (auto & curNote : curChart.notes) {
-
-		if (!curChart.Solos.empty()) {
-			if (curNote.time >= curChart.Solos[curSolo].start &&
-				curNote.time < curChart.Solos[curSolo].end) {
-				if (curNote.hit) {
-					if (curNote.hit && !curNote.countedForSolo) {
-						curChart.Solos[curSolo].notesHit++;
-						curNote.countedForSolo = true;
-					}
+		int soloPhrase = soloCursor.at(notes.time[curNote]);
+		if (soloPhrase != -1) {
+			if (noteStates.is(curNote, NoteHit)) {
+				if (noteStates.is(curNote, NoteHit) && !noteStates.is(curNote, NoteCountedForSolo)) {
+					curChart.Solos[soloPhrase].notesHit++;
+					noteStates.set(curNote, NoteCountedForSolo);
 				}
 			}
 		}
-		if (!curChart.odPhrases.empty()) {
-
-			if (curNote.time >= curChart.odPhrases[curODPhrase].start &&
-				curNote.time < curChart.odPhrases[curODPhrase].end &&
-				!curChart.odPhrases[curODPhrase].missed) {
-				if (curNote.hit) {
-					if (curNote.hit && !curNote.countedForODPhrase) {
-						curChart.odPhrases[curODPhrase].notesHit++;
-						curNote.countedForODPhrase = true;
+		int odPhrase = odCursor.at(notes.time[curNote]);
+		if (odPhrase != -1) {
+
+			if (!curChart.odPhrases[odPhrase].missed) {
+				if (noteStates.is(curNote, NoteHit)) {
+					if (noteStates.is(curNote, NoteHit) && !noteStates.is(curNote, NoteCountedForODPhrase)) {
+						curChart.odPhrases[odPhrase].notesHit++;
+						noteStates.set(curNote, NoteCountedForODPhrase);
 					}
 				}
-				curNote.renderAsOD = true;
+				noteStates.set(curNote, NoteRenderAsOD);
 
 			}
-			if (curChart.odPhrases[curODPhrase].missed) {
-				curNote.renderAsOD = false;
+			if (curChart.odPhrases[odPhrase].missed) {
+				noteStates.unset(curNote, NoteRenderAsOD);
 			}
-			if (curChart.odPhrases[curODPhrase].notesHit ==
-				curChart.odPhrases[curODPhrase].noteCount &&
-				!curChart.odPhrases[curODPhrase].added && player.overdriveFill < 1.0f) {
+			if (curChart.odPhrases[odPhrase].notesHit ==
+				curChart.odPhrases[odPhrase].noteCount &&
+				!curChart.odPhrases[odPhrase].added && player.overdriveFill < 1.0f) {
 				player.overdriveFill += 0.25f;
 				if (player.overdriveFill > 1.0f) player.overdriveFill = 1.0f;
 				if (player.overdrive) {
 					player.overdriveActiveFill = player.overdriveFill;
 					player.overdriveActiveTime = time;
 				}
-				curChart.odPhrases[curODPhrase].added = true;
+				curChart.odPhrases[odPhrase].added = true;
 			}
 		}
-		if (!curNote.hit && !curNote.accounted && curNote.time + goodBackend + player.InputOffset < time &&
+		if (!noteStates.is(curNote, NoteHit) && !noteStates.is(curNote, NoteAccounted) && notes.time[curNote] + goodBackend + player.InputOffset < time &&
 			!songEnded && curNoteInt < curChart.notes.size() && !songEnded && !bot) {
 			TraceLog(LOG_INFO, TextFormat("Missed note at %f, note %01i", time, curNoteInt));
-			curNote.miss = true;
+			noteStates.set(curNote, NoteMiss);
 			FAS = false;
 			player.MissNote();
-			if (!curChart.odPhrases.empty() && !curChart.odPhrases[curODPhrase].missed &&
-				curNote.time >= curChart.odPhrases[curODPhrase].start &&
-				curNote.time < curChart.odPhrases[curODPhrase].end)
-				curChart.odPhrases[curODPhrase].missed = true;
+			if (odPhrase != -1 && !curChart.odPhrases[odPhrase].missed)
+				curChart.odPhrases[odPhrase].missed = true;
 			player.combo = 0;
-			curNote.accounted = true;
+			noteStates.set(curNote, NoteAccounted);
 			curNoteInt++;
 		} else if (bot) {
-			if (!curNote.hit && !curNote.accounted && curNote.time < time && curNoteInt < curChart.notes.size() && !songEnded) {
-				curNote.hit = true;
-				if (curNote.len > 0) curNote.held = true;
-				curNote.accounted = true;
+			if (!noteStates.is(curNote, NoteHit) && !noteStates.is(curNote, NoteAccounted) && notes.time[curNote] < time && curNoteInt < curChart.notes.size() && !songEnded) {
+				noteStates.set(curNote, NoteHit);
+				if (notes.len[curNote] > 0) noteStates.set(curNote, NoteHeld);
+				noteStates.set(curNote, NoteAccounted);
 				player.combo++;
-				curNote.accounted = true;
-				curNote.hitTime = time;
+				noteStates.set(curNote, NoteAccounted);
+				noteStates.hitTime(curNote) = time;
 				curNoteInt++;
 			}
 		}
 
-		double relTime = ((curNote.time - time)) *
+		double relTime = ((notes.time[curNote] - time)) *
 						 gprSettings.trackSpeedOptions[gprSettings.trackSpeed] * (11.5f / length);
-		double relEnd = (((curNote.time + curNote.len) - time)) *
+		double relEnd = (((notes.time[curNote] + notes.len[curNote]) - time)) *
 						gprSettings.trackSpeedOptions[gprSettings.trackSpeed] * (11.5f / length);
 
-		float hopoScale = curNote.phopo ? 0.75f : 1.1f;
+		float hopoScale = notes.is(curNote, NoteHopo) ? 0.75f : 1.1f;
 
-		for (int lane: curNote.pLanes) {
+		for (int lane = 0; lane < 5; lane++) {
+			if (!(notes.mask[curNote] & (1 << lane)))
+				continue;
 
 			int noteLane = gprSettings.mirrorMode ? 4 - lane : lane;
 
@@ -472,8 +472,8 @@ void gameplayRenderer::RenderClassicNotes(Player& player, Chart& curChart, doubl
 				break;
 			}
 			if (relEnd > 1.5) relEnd = 1.5;
-			if ((curNote.phopo || curNote.pTap) && !curNote.hit && !curNote.miss) {
-				if (curNote.renderAsOD) {
+			if ((notes.is(curNote, NoteHopo) || notes.is(curNote, NoteTap)) && !noteStates.is(curNote, NoteHit) && !noteStates.is(curNote, NoteMiss)) {
+				if (noteStates.is(curNote, NoteRenderAsOD)) {
 					gprAssets.noteTopModelHP.materials[0].maps[MATERIAL_MAP_ALBEDO].color = GOLD;
 					gprAssets.noteBottomModelHP.materials[0].maps[MATERIAL_MAP_ALBEDO].color = WHITE;
 					DrawModel(gprAssets.noteTopModelHP, Vector3{notePosX, 0, player.smasherPos +
@@ -485,8 +485,8 @@ void gameplayRenderer::RenderClassicNotes(Player& player, Chart& curChart, doubl
 																				 (float) relTime)}, 1.1f,
 							  WHITE);
 				} else {
-					gprAssets.noteTopModelHP.materials[0].maps[MATERIAL_MAP_ALBEDO].color = curNote.pTap ? BLACK : NoteColor;
-					gprAssets.noteBottomModelHP.materials[0].maps[MATERIAL_MAP_ALBEDO].color = curNote.pTap ? NoteColor : WHITE;
+					gprAssets.noteTopModelHP.materials[0].maps[MATERIAL_MAP_ALBEDO].color = notes.is(curNote, NoteTap) ? BLACK : NoteColor;
+					gprAssets.noteBottomModelHP.materials[0].maps[MATERIAL_MAP_ALBEDO].color = notes.is(curNote, NoteTap) ? NoteColor : WHITE;
 					DrawModel(gprAssets.noteTopModelHP, Vector3{notePosX, 0, player.smasherPos +
 																			 (length *
 																			  (float) relTime)}, 1.1f,
@@ -496,7 +496,7 @@ void gameplayRenderer::RenderClassicNotes(Player& player, Chart& curChart, doubl
 																				 (float) relTime)}, 1.1f,
 							  WHITE);
 				}
-			} else if (curNote.miss && (curNote.phopo || curNote.pTap)) {
+			} else if (noteStates.is(curNote, NoteMiss) && (notes.is(curNote, NoteHopo) || notes.is(curNote, NoteTap))) {
 				gprAssets.noteTopModelHP.materials[0].maps[MATERIAL_MAP_ALBEDO].color = RED;
 				gprAssets.noteBottomModelHP.materials[0].maps[MATERIAL_MAP_ALBEDO].color = RED;
 				DrawModel(gprAssets.noteTopModelHP, Vector3{notePosX, 0, player.smasherPos +
@@ -508,7 +508,7 @@ void gameplayRenderer::RenderClassicNotes(Player& player, Chart& curChart, doubl
 																			 (float) relTime)}, 1.1f,
 						  WHITE);
 			}
-			if ((curNote.len) > 0) {
+			if ((notes.len[curNote]) > 0) {
 				int pressedMask = 0b000000;
 
 				for (int pressedButtons = 0; pressedButtons < heldFrets.size(); pressedButtons++) {
@@ -516,36 +516,36 @@ void gameplayRenderer::RenderClassicNotes(Player& player, Chart& curChart, doubl
 						pressedMask += curChart.PlasticFrets[pressedButtons];
 				}
 
-				Note &lastNote = curChart.notes[curNoteInt == 0 ? 0 : curNoteInt - 1];
-				bool chordMatch = (extendedSustainActive ? pressedMask >= curNote.mask : pressedMask == curNote.mask);
-				bool singleMatch = (extendedSustainActive ? pressedMask >= curNote.mask : pressedMask >= curNote.mask && pressedMask < (curNote.mask * 2));
-				bool noteMatch = (curNote.chord ? chordMatch : singleMatch);
+				int lastNote = curNoteInt == 0 ? 0 : curNoteInt - 1;
+				bool chordMatch = (extendedSustainActive ? pressedMask >= notes.mask[curNote] : pressedMask == notes.mask[curNote]);
+				bool singleMatch = (extendedSustainActive ? pressedMask >= notes.mask[curNote] : pressedMask >= notes.mask[curNote] && pressedMask < (notes.mask[curNote] * 2));
+				bool noteMatch = (notes.is(curNote, NoteChord) ? chordMatch : singleMatch);
 
-				if (curNote.extendedSustain)
+				if (notes.is(curNote, NoteExtendedSustain))
 					TraceLog(LOG_INFO, "extended sustain lol");
 
-				if ((!noteMatch && curNote.held) && curNote.time + curNote.len + 0.1 > time) {
-					curNote.held = false;
-					if (curNote.extendedSustain == true)
+				if ((!noteMatch && noteStates.is(curNote, NoteHeld)) && notes.time[curNote] + notes.len[curNote] + 0.1 > time) {
+					noteStates.unset(curNote, NoteHeld);
+					if (notes.is(curNote, NoteExtendedSustain))
 						extendedSustainActive = false;
 				}
 
-				if ((curNote.hit && curNote.held) && curNote.time + curNote.len + 0.1 > time) {
-					if (curNote.heldTime < (curNote.len * gprSettings.trackSpeedOptions[gprSettings.trackSpeed])) {
-						curNote.heldTime = 0.0 - relTime;
+				if ((noteStates.is(curNote, NoteHit) && noteStates.is(curNote, NoteHeld)) && notes.time[curNote] + notes.len[curNote] + 0.1 > time) {
+					if (noteStates.heldTime(curNote) < (notes.len[curNote] * gprSettings.trackSpeedOptions[gprSettings.trackSpeed])) {
+						noteStates.heldTime(curNote) = 0.0 - relTime;
 						player.score +=
-						        (float) (curNote.heldTime / curNote.len) * (12 * curNote.beatsLen) *
+						        (float) (noteStates.heldTime(curNote) / notes.len[curNote]) * (12 * notes.beatsLen[curNote]) *
 						        player.multiplier(player.instrument);
 						if (relTime < 0.0) relTime = 0.0;
 					}
 					if (relEnd <= 0.0) {
 						if (relTime < 0.0) relTime = relEnd;
-						curNote.held = false;
-						if (curNote.extendedSustain == true)
+						noteStates.unset(curNote, NoteHeld);
+						if (notes.is(curNote, NoteExtendedSustain))
 							extendedSustainActive = false;
 					}
-				} else if (curNote.hit && !curNote.held) {
-					relTime = relTime + curNote.heldTime;
+				} else if (noteStates.is(curNote, NoteHit) && !noteStates.is(curNote, NoteHeld)) {
+					relTime = relTime + noteStates.heldTime(curNote);
 				}
 				float sustainLen =
 						(length * (float) relEnd) - (length * (float) relTime);
@@ -560,24 +560,24 @@ void gameplayRenderer::RenderClassicNotes(Player& player, Chart& curChart, doubl
 				gprAssets.sustainMatHeld.maps[MATERIAL_MAP_DIFFUSE].color = ColorBrightness(NoteColor, 0.5f);
 
 
-				if (curNote.held && !curNote.renderAsOD) {
+				if (noteStates.is(curNote, NoteHeld) && !noteStates.is(curNote, NoteRenderAsOD)) {
 					DrawMesh(sustainPlane, gprAssets.sustainMatHeld, sustainMatrix);
 					DrawCube(Vector3{notePosX, 0.1, player.smasherPos}, 0.4f, 0.2f, 0.4f,
 							 player.accentColor);
 					//DrawCylinderEx(Vector3{ notePosX, 0.05f, player.smasherPos + (highwayLength * (float)relTime) }, Vector3{ notePosX,0.05f, player.smasherPos + (highwayLength * (float)relEnd) }, 0.1f, 0.1f, 15, player.accentColor);
 				}
-				if (curNote.renderAsOD && curNote.held) {
+				if (noteStates.is(curNote, NoteRenderAsOD) && noteStates.is(curNote, NoteHeld)) {
 					DrawMesh(sustainPlane, gprAssets.sustainMatHeldOD, sustainMatrix);
 					DrawCube(Vector3{notePosX, 0.1, player.smasherPos}, 0.4f, 0.2f, 0.4f, WHITE);
 					//DrawCylinderEx(Vector3{ notePosX, 0.05f, player.smasherPos + (highwayLength * (float)relTime) }, Vector3{ notePosX,0.05f, player.smasherPos + (highwayLength * (float)relEnd) }, 0.1f, 0.1f, 15, Color{ 255, 255, 255 ,255 });
 				}
-				if (!curNote.held && curNote.hit || curNote.miss) {
+				if (!noteStates.is(curNote, NoteHeld) && noteStates.is(curNote, NoteHit) || noteStates.is(curNote, NoteMiss)) {
 
 					DrawMesh(sustainPlane, gprAssets.sustainMatMiss, sustainMatrix);
 					//DrawCylinderEx(Vector3{ notePosX, 0.05f, player.smasherPos + (highwayLength * (float)relTime) }, Vector3{ notePosX,0.05f, player.smasherPos + (highwayLength * (float)relEnd) }, 0.1f, 0.1f, 15, Color{ 69,69,69,255 });
 				}
-				if (!curNote.hit && !curNote.accounted && !curNote.miss) {
-					if (curNote.renderAsOD) {
+				if (!noteStates.is(curNote, NoteHit) && !noteStates.is(curNote, NoteAccounted) && !noteStates.is(curNote, NoteMiss)) {
+					if (noteStates.is(curNote, NoteRenderAsOD)) {
 						DrawMesh(sustainPlane, gprAssets.sustainMatOD, sustainMatrix);
 						//DrawCylinderEx(Vector3{ notePosX, 0.05f, player.smasherPos + (highwayLength * (float)relTime) }, Vector3{ notePosX,0.05f, player.smasherPos + (highwayLength * (float)relEnd) }, 0.1f, 0.1f, 15, Color{ 200, 200, 200 ,255 });
 					} else {
@@ -591,10 +591,10 @@ void gameplayRenderer::RenderClassicNotes(Player& player, Chart& curChart, doubl
 				}
 				EndBlendMode();
 			}
-			if ((!curNote.phopo  && ((curNote.len) > 0 && (curNote.held || !curNote.hit)) ||
-				((curNote.len) == 0 && !curNote.hit) && !curNote.phopo && !curNote.pTap) && !curNote.miss) {
-				if (curNote.renderAsOD) {
-					if ((!curNote.held && !curNote.miss && !curNote.phopo) && !curNote.hit) {
+			if ((!notes.is(curNote, NoteHopo)  && ((notes.len[curNote]) > 0 && (noteStates.is(curNote, NoteHeld) || !noteStates.is(curNote, NoteHit))) ||
+				((notes.len[curNote]) == 0 && !noteStates.is(curNote, NoteHit)) && !notes.is(curNote, NoteHopo) && !notes.is(curNote, NoteTap)) && !noteStates.is(curNote, NoteMiss)) {
+				if (noteStates.is(curNote, NoteRenderAsOD)) {
+					if ((!noteStates.is(curNote, NoteHeld) && !noteStates.is(curNote, NoteMiss) && !notes.is(curNote, NoteHopo)) && !noteStates.is(curNote, NoteHit)) {
 						DrawModel(gprAssets.noteTopModelOD, Vector3{notePosX, 0, player.smasherPos +
 																				 (length *
 																				  (float) relTime)}, 1.1f,
@@ -606,7 +606,7 @@ void gameplayRenderer::RenderClassicNotes(Player& player, Chart& curChart, doubl
 					}
 
 				} else {
-					if ((!curNote.held && !curNote.miss && !curNote.pTap && !curNote.phopo) && !curNote.hit) {
+					if ((!noteStates.is(curNote, NoteHeld) && !noteStates.is(curNote, NoteMiss) && !notes.is(curNote, NoteTap) && !notes.is(curNote, NoteHopo)) && !noteStates.is(curNote, NoteHit)) {
 						DrawModel(gprAssets.noteTopModel, Vector3{notePosX, 0, player.smasherPos +
 																			   (length *
 																				(float) relTime)}, 1.1f,
@@ -618,7 +618,7 @@ void gameplayRenderer::RenderClassicNotes(Player& player, Chart& curChart, doubl
 					}
 				}
 
-			} else if ((!curNote.phopo && !curNote.pTap) && curNote.miss) {
+			} else if ((!notes.is(curNote, NoteHopo) && !notes.is(curNote, NoteTap)) && noteStates.is(curNote, NoteMiss)) {
 				gprAssets.noteTopModel.materials[0].maps[MATERIAL_MAP_ALBEDO].color = RED;
 				DrawModel(gprAssets.noteTopModel, Vector3{notePosX, 0, player.smasherPos +
 																			   (length *
@@ -630,8 +630,8 @@ void gameplayRenderer::RenderClassicNotes(Player& player, Chart& curChart, doubl
 						  RED);
 			}
 
-			if (curNote.miss && curNote.time + 0.5 < time) {
-				if (curNote.phopo) {
+			if (noteStates.is(curNote, NoteMiss) && notes.time[curNote] + 0.5 < time) {
+				if (notes.is(curNote, NoteHopo)) {
 					DrawModel(gprAssets.noteBottomModelHP,
 							  Vector3{notePosX, 0, player.smasherPos + (length * (float) relTime)},
 							  1.0f, RED);
@@ -648,8 +648,8 @@ void gameplayRenderer::RenderClassicNotes(Player& player, Chart& curChart, doubl
 				}
 
 
-				if (gprAudioManager.GetMusicTimePlayed(gprAudioManager.loadedStreams[0].handle) <
-					curNote.time + 0.4 && gprSettings.missHighwayColor) {
+				if (time <
+					notes.time[curNote] + 0.4 && gprSettings.missHighwayColor) {
 					gprAssets.expertHighway.materials[0].maps[MATERIAL_MAP_ALBEDO].color = RED;
 				} else {
 					gprAssets.expertHighway.materials[0].maps[MATERIAL_MAP_ALBEDO].color = player.accentColor;
@@ -657,25 +657,25 @@ void gameplayRenderer::RenderClassicNotes(Player& player, Chart& curChart, doubl
 			}
 			double HitAnimDuration = 0.15f;
 			double PerfectHitAnimDuration = 1.0f;
-			if (curNote.hit && gprAudioManager.GetMusicTimePlayed(gprAudioManager.loadedStreams[0].handle) <
-							   curNote.hitTime + HitAnimDuration) {
+			if (noteStates.is(curNote, NoteHit) && time <
+							   noteStates.hitTime(curNote) + HitAnimDuration) {
 
-				double TimeSinceHit = gprAudioManager.GetMusicTimePlayed(gprAudioManager.loadedStreams[0].handle) - curNote.hitTime;
+				double TimeSinceHit = time - noteStates.hitTime(curNote);
 				unsigned char HitAlpha = Remap(getEasingFunction(EaseInBack)(TimeSinceHit/HitAnimDuration), 0, 1.0, 196, 0);
 
 				DrawCube(Vector3{notePosX, 0.125, player.smasherPos}, 1.0f, 0.25f, 0.5f,
-						 curNote.perfect ? Color{255, 215, 0, HitAlpha} : Color{255, 255, 255, HitAlpha});
-				// if (curNote.perfect) {
+						 noteStates.is(curNote, NotePerfect) ? Color{255, 215, 0, HitAlpha} : Color{255, 255, 255, HitAlpha});
+				// if (noteStates.is(curNote, NotePerfect)) {
 				// 	DrawCube(Vector3{3.3f, 0, player.smasherPos}, 1.0f, 0.01f,
 				// 			 0.5f, Color{255,161,0,HitAlpha});
 				// }
 
 
 			}
-			if (curNote.hit && gprAudioManager.GetMusicTimePlayed(gprAudioManager.loadedStreams[0].handle) <
-							   curNote.hitTime + PerfectHitAnimDuration && curNote.perfect) {
+			if (noteStates.is(curNote, NoteHit) && time <
+							   noteStates.hitTime(curNote) + PerfectHitAnimDuration && noteStates.is(curNote, NotePerfect)) {
 
-				double TimeSinceHit = gprAudioManager.GetMusicTimePlayed(gprAudioManager.loadedStreams[0].handle) - curNote.hitTime;
+				double TimeSinceHit = time - noteStates.hitTime(curNote);
 				unsigned char HitAlpha = Remap(getEasingFunction(EaseOutQuad)(TimeSinceHit/PerfectHitAnimDuration), 0, 1.0, 255, 0);
 				float HitPosLeft = Remap(getEasingFunction(EaseInOutBack)(TimeSinceHit/PerfectHitAnimDuration), 0, 1.0, 3.4, 3.0);
 
@@ -788,9 +788,9 @@ void gameplayRenderer::LowerHighway() {
 	}
 };
 
-void gameplayRenderer::RenderGameplay(Player& player, double time, Song song, RenderTexture2D& highway_tex, RenderTexture2D& hud_tex, RenderTexture2D& notes_tex, RenderTexture2D& highwayStatus_tex, RenderTexture2D& smasher_tex) {
+void gameplayRenderer::RenderGameplay(Player& player, double time, SongSession& song, RenderTexture2D& highway_tex, RenderTexture2D& hud_tex, RenderTexture2D& notes_tex, RenderTexture2D& highwayStatus_tex, RenderTexture2D& smasher_tex) {
 
-	Chart& curChart = song.parts[player.instrument]->charts[player.diff];
+	Chart& curChart = song.parts[player.instrument].charts[player.diff];
 	float highwayLength = player.defaultHighwayLength * gprSettings.highwayLengthMult;
 
 	float multFill = (!player.overdrive ? (float)(player.multiplier(player.instrument) - 1) : ((float)(player.multiplier(player.instrument) / 2) - 1)) / (float)player.maxMultForMeter(player.instrument);
@@ -825,7 +825,7 @@ void gameplayRenderer::RenderGameplay(Player& player, double time, Song song, Re
 
 	RaiseHighway();
 	if (GetTime() >= startTime + animDuration && highwayInEndAnim) {
-		gprAudioManager.BeginPlayback(gprAudioManager.loadedStreams[0].handle);
+		gprAudioManager.BeginPlayback();
 		highwayInEndAnim = false;
 	}
 
@@ -845,7 +845,7 @@ void gameplayRenderer::RenderGameplay(Player& player, double time, Song song, Re
 	 */
 
 
-	double musicTime = gprAudioManager.GetMusicTimePlayed(gprAudioManager.loadedStreams[0].handle) - player.VideoOffset;
+	double musicTime = time - player.VideoOffset;
 	if (player.overdrive) {
 
 		// gprAssets.expertHighway.materials[0].maps[MATERIAL_MAP_ALBEDO].texture = gprAssets.highwayTextureOD;
@@ -875,15 +875,10 @@ void gameplayRenderer::RenderGameplay(Player& player, double time, Song song, Re
 			curBPM++;
 	}
 
-	if (!curChart.odPhrases.empty() && curODPhrase<curChart.odPhrases.size() - 1 && musicTime>curChart.odPhrases[curODPhrase].end && (curChart.odPhrases[curODPhrase].added ||curChart.odPhrases[curODPhrase].missed)) {
-		curODPhrase++;
-	}
-
-	if (!curChart.Solos.empty() && curSolo<curChart.Solos.size() - 1 && musicTime-2.5f>curChart.Solos[curSolo].end) {
-		curSolo++;
-	}
-
-	if (!curChart.Solos.empty() && time >= curChart.Solos[curSolo].start - 1 && time <= curChart.Solos[curSolo].end + 2.5) {
+	// the solo shown from a second before it starts until its result is done
+	std::pair<int, int> shownSolos = curChart.phrases.overlapping(PhraseSolo, time - 2.5, time + 1);
+	if (shownSolos.first < shownSolos.second) {
+		int curSolo = shownSolos.first;
 
 
 		int solopctnum = Remap(curChart.Solos[curSolo].notesHit, 0, curChart.Solos[curSolo].noteCount, 0, 100);
@@ -939,7 +934,7 @@ void gameplayRenderer::RenderGameplay(Player& player, double time, Song song, Re
 	if (!bot) RenderHud(player, hud_tex, highwayLength);
 }
 
-void gameplayRenderer::RenderExpertHighway(Player& player, Song song, double time, RenderTexture2D& highway_tex, RenderTexture2D& highwayStatus_tex, RenderTexture2D& smasher_tex)  {
+void gameplayRenderer::RenderExpertHighway(Player& player, SongSession& song, double time, RenderTexture2D& highway_tex, RenderTexture2D& highwayStatus_tex, RenderTexture2D& smasher_tex)  {
 	BeginTextureMode(highway_tex);
 	ClearBackground({0,0,0,0});
 	BeginMode3D(camera3pVector[cameraSel]);
@@ -971,17 +966,17 @@ void gameplayRenderer::RenderExpertHighway(Player& player, Song song, double tim
 
 	double OverdriveAnimDuration = 0.25f;
 
-	if (gprAudioManager.GetMusicTimePlayed(gprAudioManager.loadedStreams[0].handle) <= player.overdriveActiveTime + OverdriveAnimDuration) {
-		double TimeSinceOverdriveActivate = gprAudioManager.GetMusicTimePlayed(gprAudioManager.loadedStreams[0].handle) - player.overdriveActiveTime;
+	if (time <= player.overdriveActiveTime + OverdriveAnimDuration) {
+		double TimeSinceOverdriveActivate = time - player.overdriveActiveTime;
 		OverdriveAlpha = Remap(getEasingFunction(EaseOutQuint)(TimeSinceOverdriveActivate/OverdriveAnimDuration), 0, 1.0, 0, 255);
 	} else OverdriveAlpha = 255;
 
-	if (gprAudioManager.GetMusicTimePlayed(gprAudioManager.loadedStreams[0].handle) <= player.overdriveActivateTime + OverdriveAnimDuration && gprAudioManager.GetMusicTimePlayed(gprAudioManager.loadedStreams[0].handle) > 0.0) {
-		double TimeSinceOverdriveActivate = gprAudioManager.GetMusicTimePlayed(gprAudioManager.loadedStreams[0].handle) - player.overdriveActivateTime;
+	if (time <= player.overdriveActivateTime + OverdriveAnimDuration && time > 0.0) {
+		double TimeSinceOverdriveActivate = time - player.overdriveActivateTime;
 		OverdriveAlpha = Remap(getEasingFunction(EaseOutQuint)(TimeSinceOverdriveActivate/OverdriveAnimDuration), 0, 1.0, 255, 0);
 	} else if (!player.overdrive) OverdriveAlpha = 0;
 
-	if (player.overdrive || gprAudioManager.GetMusicTimePlayed(gprAudioManager.loadedStreams[0].handle) <= player.overdriveActivateTime + OverdriveAnimDuration) {DrawModel(gprAssets.odHighwayX, Vector3{0,0.001f,0},1,Color{255,255,255,OverdriveAlpha});}
+	if (player.overdrive || time <= player.overdriveActivateTime + OverdriveAnimDuration) {DrawModel(gprAssets.odHighwayX, Vector3{0,0.001f,0},1,Color{255,255,255,OverdriveAlpha});}
 	BeginBlendMode(BLEND_ALPHA_PREMULTIPLY);
 	DrawTriangle3D({lineDistance - 1.0f,0.003,0},
 				   {lineDistance - 1.0f,0.003,(highwayLength *1.5f) + player.smasherPos},
@@ -1031,11 +1026,11 @@ void gameplayRenderer::RenderExpertHighway(Player& player, Song song, double tim
 		DrawBeatlines(player, song, highwayLength, time);
 	}
 
-	if (!song.parts[player.instrument]->charts[player.diff].odPhrases.empty()) {
-		DrawOverdrive(player, song.parts[player.instrument]->charts[player.diff], highwayLength, time);
+	if (!song.parts[player.instrument].charts[player.diff].odPhrases.empty()) {
+		DrawOverdrive(player, song.parts[player.instrument].charts[player.diff], highwayLength, time);
 	}
-	if (!song.parts[player.instrument]->charts[player.diff].Solos.empty()) {
-		DrawSolo(player, song.parts[player.instrument]->charts[player.diff], highwayLength, time);
+	if (!song.parts[player.instrument].charts[player.diff].Solos.empty()) {
+		DrawSolo(player, song.parts[player.instrument].charts[player.diff], highwayLength, time);
 	}
 
 	float darkYPos = 0.015f;
@@ -1115,7 +1110,7 @@ void gameplayRenderer::RenderExpertHighway(Player& player, Song song, double tim
 
 }
 
-void gameplayRenderer::RenderEmhHighway(Player& player, Song song, double time, RenderTexture2D &highway_tex) {
+void gameplayRenderer::RenderEmhHighway(Player& player, SongSession& song, double time, RenderTexture2D &highway_tex) {
 	BeginTextureMode(highway_tex);
 	ClearBackground({0,0,0,0});
 	BeginMode3D(camera3pVector[cameraSel]);
@@ -1165,11 +1160,11 @@ void gameplayRenderer::RenderEmhHighway(Player& player, Song song, double time,
 	if (!song.beatLines.empty()) {
 		DrawBeatlines(player, song, highwayLength, time);
 	}
-	if (!song.parts[player.instrument]->charts[player.diff].Solos.empty()) {
-		DrawSolo(player, song.parts[player.instrument]->charts[player.diff], highwayLength, time);
+	if (!song.parts[player.instrument].charts[player.diff].Solos.empty()) {
+		DrawSolo(player, song.parts[player.instrument].charts[player.diff], highwayLength, time);
 	}
-	if (!song.parts[player.instrument]->charts[player.diff].odPhrases.empty()) {
-		DrawOverdrive(player, song.parts[player.instrument]->charts[player.diff], highwayLength, time);
+	if (!song.parts[player.instrument].charts[player.diff].odPhrases.empty()) {
+		DrawOverdrive(player, song.parts[player.instrument].charts[player.diff], highwayLength, time);
 	}
 
 	EndBlendMode();
@@ -1183,10 +1178,10 @@ void gameplayRenderer::RenderEmhHighway(Player& player, Song song, double time,
 
 }
 
-void gameplayRenderer::DrawBeatlines(Player& player, Song song, float length, double musicTime) {
+void gameplayRenderer::DrawBeatlines(Player& player, SongSession& song, float length, double musicTime) {
 	float diffDistance = player.diff == 3 || player.plastic ? 2.0f : 1.5f;
 	float lineDistance = player.diff == 3 || player.plastic ? 1.5f : 1.0f;
-	std::vector<std::pair<double, bool>> beatlines = song.beatLines;
+	const std::vector<std::pair<double, bool>>& beatlines = song.beatLines;
 
 	if (beatlines.size() >= 0) {
 		for (int i = curBeatLine; i < beatlines.size(); i++) {
@@ -1229,78 +1224,88 @@ void gameplayRenderer::DrawBeatlines(Player& player, Song song, float length, do
 }
 
 void gameplayRenderer::DrawOverdrive(Player& player,  Chart& curChart, float length, double musicTime) {
+	// every phrase between the back of the smasher and the end of the highway
+	float secondsPerLength = length / (11.5f * gprSettings.trackSpeedOptions[gprSettings.trackSpeed]);
+	std::pair<int, int> shown = curChart.phrases.overlapping(PhraseOverdrive, musicTime - secondsPerLength,
+															  musicTime + 1.5f * secondsPerLength);
+	for (int phrase = shown.first; phrase < shown.second; phrase++) {
+		float odStart = (float)((curChart.odPhrases[phrase].start - musicTime)) * gprSettings.trackSpeedOptions[gprSettings.trackSpeed] * (11.5f / length);
+		float odEnd = (float)((curChart.odPhrases[phrase].end - musicTime)) * gprSettings.trackSpeedOptions[gprSettings.trackSpeed] * (11.5f / length);
 
-	float odStart = (float)((curChart.odPhrases[curODPhrase].start - musicTime)) * gprSettings.trackSpeedOptions[gprSettings.trackSpeed] * (11.5f / length);
-	float odEnd = (float)((curChart.odPhrases[curODPhrase].end - musicTime)) * gprSettings.trackSpeedOptions[gprSettings.trackSpeed] * (11.5f / length);
-
-	// can be flipped. btw
+		// can be flipped. btw
 
-	// horrifying.
-	// main calc
-	bool Beginning = (float)(player.smasherPos + (length * odStart)) >= (length * 1.5f) + player.smasherPos;
-	bool Ending = (float)(player.smasherPos + (length * odEnd)) >= (length * 1.5f) + player.smasherPos;
+		// horrifying.
+		// main calc
+		bool Beginning = (float)(player.smasherPos + (length * odStart)) >= (length * 1.5f) + player.smasherPos;
+		bool Ending = (float)(player.smasherPos + (length * odEnd)) >= (length * 1.5f) + player.smasherPos;
 
-	float HighwayEnd = (length * 1.5f) + player.smasherPos;
+		float HighwayEnd = (length * 1.5f) + player.smasherPos;
 
-	// right calc
-	float RightSideX = player.diff == 3 || player.plastic ? 2.7f : 2.2f;
+		// right calc
+		float RightSideX = player.diff == 3 || player.plastic ? 2.7f : 2.2f;
 
-	Vector3 RightSideStart = {RightSideX ,0,Beginning ?  HighwayEnd : (float)(player.smasherPos + (length * odStart)) };
-	Vector3 RightSideEnd = { RightSideX,0, Ending ? HighwayEnd : (float)(player.smasherPos + (length * odEnd)) };
+		Vector3 RightSideStart = {RightSideX ,0,Beginning ?  HighwayEnd : (float)(player.smasherPos + (length * odStart)) };
+		Vector3 RightSideEnd = { RightSideX,0, Ending ? HighwayEnd : (float)(player.smasherPos + (length * odEnd)) };
 
-	// left calc
-	float LeftSideX = player.diff == 3 || player.plastic ? -2.7f : -2.2f;
+		// left calc
+		float LeftSideX = player.diff == 3 || player.plastic ? -2.7f : -2.2f;
 
-	Vector3 LeftSideStart = {LeftSideX ,0,Beginning ?  HighwayEnd : (float)(player.smasherPos + (length * odStart)) };
-	Vector3 LeftSideEnd = { LeftSideX,0, Ending ? HighwayEnd : (float)(player.smasherPos + (length * odEnd)) };
+		Vector3 LeftSideStart = {LeftSideX ,0,Beginning ?  HighwayEnd : (float)(player.smasherPos + (length * odStart)) };
+		Vector3 LeftSideEnd = { LeftSideX,0, Ending ? HighwayEnd : (float)(player.smasherPos + (length * odEnd)) };
 
-	// draw
-	DrawCylinderEx(RightSideStart, RightSideEnd, 0.07, 0.07, 10, RAYWHITE);
-	DrawCylinderEx(LeftSideStart, LeftSideEnd, 0.07, 0.07, 10, RAYWHITE);
+		// draw
+		DrawCylinderEx(RightSideStart, RightSideEnd, 0.07, 0.07, 10, RAYWHITE);
+		DrawCylinderEx(LeftSideStart, LeftSideEnd, 0.07, 0.07, 10, RAYWHITE);
+	}
 }
 
 void gameplayRenderer::DrawSolo(Player& player, Chart& curChart, float length, double musicTime) {
+	// every phrase between the back of the smasher and the end of the highway
+	float secondsPerLength = length / (11.5f * gprSettings.trackSpeedOptions[gprSettings.trackSpeed]);
+	std::pair<int, int> shown = curChart.phrases.overlapping(PhraseSolo, musicTime - secondsPerLength,
+															  musicTime + 1.5f * secondsPerLength);
+	for (int phrase = shown.first; phrase < shown.second; phrase++) {
+		float soloStart = (float)((curChart.Solos[phrase].start - musicTime)) * gprSettings.trackSpeedOptions[gprSettings.trackSpeed] * (11.5f / length);
+		float soloEnd = (float)((curChart.Solos[phrase].end - musicTime)) * gprSettings.trackSpeedOptions[gprSettings.trackSpeed] * (11.5f / length);
 
-	float soloStart = (float)((curChart.Solos[curSolo].start - musicTime)) * gprSettings.trackSpeedOptions[gprSettings.trackSpeed] * (11.5f / length);
-	float soloEnd = (float)((curChart.Solos[curSolo].end - musicTime)) * gprSettings.trackSpeedOptions[gprSettings.trackSpeed] * (11.5f / length);
 
 
+		// can be flipped. btw
 
-	// can be flipped. btw
+		// horrifying.
+		// main calc
+		bool Beginning = (float)(player.smasherPos + (length * soloStart)) >= (length * 1.5f) + player.smasherPos;
+		bool Ending = (float)(player.smasherPos + (length * soloEnd)) >= (length * 1.5f) + player.smasherPos;
+		float HighwayEnd = (length * 1.5f) + player.smasherPos;
 
-	// horrifying.
-	// main calc
-	bool Beginning = (float)(player.smasherPos + (length * soloStart)) >= (length * 1.5f) + player.smasherPos;
-	bool Ending = (float)(player.smasherPos + (length * soloEnd)) >= (length * 1.5f) + player.smasherPos;
-	float HighwayEnd = (length * 1.5f) + player.smasherPos;
+		float soloPlaneStart = Beginning ?  HighwayEnd : (float)(player.smasherPos + (length * soloStart));
+		float soloPlaneEnd = Ending ? HighwayEnd : (float)(player.smasherPos + (length * soloEnd));
 
-	float soloPlaneStart = Beginning ?  HighwayEnd : (float)(player.smasherPos + (length * soloStart));
-	float soloPlaneEnd = Ending ? HighwayEnd : (float)(player.smasherPos + (length * soloEnd));
+		//float soloLen = (length * (float) soloPlaneEnd) - (length * (float) soloPlaneStart);
+		// Matrix soloMatrix = MatrixMultiply(MatrixScale(1, 1, soloLen),
+		//                                   MatrixTranslate(0, 0.005f,
+	//                                                       (length *
+		//                                                    (float) soloStart) +
+		//                                                   (soloLen / 2.0f)));
+		//gprAssets.soloMat.maps[MATERIAL_MAP_DIFFUSE].color = SKYBLUE;
 
-	//float soloLen = (length * (float) soloPlaneEnd) - (length * (float) soloPlaneStart);
-	// Matrix soloMatrix = MatrixMultiply(MatrixScale(1, 1, soloLen),
-	//                                   MatrixTranslate(0, 0.005f,
-//                                                       (length *
-	//                                                    (float) soloStart) +
-	//                                                   (soloLen / 2.0f)));
-	//gprAssets.soloMat.maps[MATERIAL_MAP_DIFFUSE].color = SKYBLUE;
+		// DrawMesh(soloPlane, gprAssets.soloMat, soloMatrix);
 
-	// DrawMesh(soloPlane, gprAssets.soloMat, soloMatrix);
 
+		// right calc
+		float RightSideX = player.diff == 3 || player.plastic ? 2.7f : 2.2f;
 
-	// right calc
-	float RightSideX = player.diff == 3 || player.plastic ? 2.7f : 2.2f;
+		Vector3 RightSideStart = {RightSideX ,-0.0025,Beginning ?  HighwayEnd : (float)(player.smasherPos + (length * soloStart)) };
+		Vector3 RightSideEnd = { RightSideX,-0.0025, Ending ? HighwayEnd : (float)(player.smasherPos + (length * soloEnd)) };
 
-	Vector3 RightSideStart = {RightSideX ,-0.0025,Beginning ?  HighwayEnd : (float)(player.smasherPos + (length * soloStart)) };
-	Vector3 RightSideEnd = { RightSideX,-0.0025, Ending ? HighwayEnd : (float)(player.smasherPos + (length * soloEnd)) };
+		// left calc
+		float LeftSideX = player.diff == 3 || player.plastic ? -2.7f : -2.2f;
 
-	// left calc
-	float LeftSideX = player.diff == 3 || player.plastic ? -2.7f : -2.2f;
+		Vector3 LeftSideStart = {LeftSideX ,-0.0025,Beginning ?  HighwayEnd : (float)(player.smasherPos + (length * soloStart)) };
+		Vector3 LeftSideEnd = { LeftSideX,-0.0025, Ending ? HighwayEnd : (float)(player.smasherPos + (length * soloEnd)) };
 
-	Vector3 LeftSideStart = {LeftSideX ,-0.0025,Beginning ?  HighwayEnd : (float)(player.smasherPos + (length * soloStart)) };
-	Vector3 LeftSideEnd = { LeftSideX,-0.0025, Ending ? HighwayEnd : (float)(player.smasherPos + (length * soloEnd)) };
-
-	// draw
-	DrawCylinderEx(RightSideStart, RightSideEnd, 0.07, 0.07, 10, SKYBLUE);
-	DrawCylinderEx(LeftSideStart, LeftSideEnd, 0.07, 0.07, 10, SKYBLUE);
+		// draw
+		DrawCylinderEx(RightSideStart, RightSideEnd, 0.07, 0.07, 10, SKYBLUE);
+		DrawCylinderEx(LeftSideStart, LeftSideEnd, 0.07, 0.07, 10, SKYBLUE);
+	}
 }
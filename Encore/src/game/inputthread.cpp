@@ -0,0 +1,252 @@
+#include "game/inputthread.h"
+#include <iostream>
+
+#ifdef __linux__
+    #include <cstdio>
+    #include <ctime>
+    #include <fcntl.h>
+    #include <filesystem>
+    #include <linux/input.h>
+    #include <poll.h>
+    #include <sys/ioctl.h>
+    #include <unistd.h>
+#endif
+
+namespace {
+#ifdef __linux__
+    constexpr int longBits = 8 * sizeof(unsigned long);
+
+    bool HasBit(const unsigned long* bits, int bit) {
+        return bits[bit / longBits] >> (bit % longBits) & 1;
+    }
+
+    // keyboards, as opposed to mice, gamepads and power buttons, which send
+    // key events too
+    bool IsKeyboard(int fd) {
+        unsigned long keys[KEY_MAX / longBits + 1] = {};
+        if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keys)), keys) < 0)
+            return false;
+        for (int key : { KEY_A, KEY_Z, KEY_SPACE }) {
+            if (!HasBit(keys, key))
+                return false;
+        }
+        return true;
+    }
+
+    // pads the kernel lays out as a standard gamepad. Anything else, guitars
+    // that only show up as joysticks among them, needs GLFW's mappings
+    bool IsGamepad(int fd) {
+        unsigned long keys[KEY_MAX / longBits + 1] = {};
+        return ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keys)), keys) >= 0 && HasBit(keys, BTN_GAMEPAD);
+    }
+
+    // the standard layout's buttons and axes in GLFW's gamepad order
+    constexpr int gamepadButtons[15] = {
+        BTN_A, BTN_B, BTN_X, BTN_Y, BTN_TL, BTN_TR, BTN_SELECT, BTN_START, BTN_MODE, BTN_THUMBL, BTN_THUMBR,
+        BTN_DPAD_UP, BTN_DPAD_RIGHT, BTN_DPAD_DOWN, BTN_DPAD_LEFT
+    };
+    constexpr int gamepadAxes[6] = { ABS_X, ABS_Y, ABS_RX, ABS_RY, ABS_Z, ABS_RZ };
+    constexpr int dpadUp = 11, dpadRight = 12, dpadDown = 13, dpadLeft = 14;
+
+    template <size_t N>
+    int IndexOf(const int (&codes)[N], int code) {
+        for (int i = 0; i < N; i++) {
+            if (codes[i] == code)
+                return i;
+        }
+        return -1;
+    }
+
+    // the GUID GLFW gives the same device, so its own state for it can be
+    // told apart; empty for devices GLFW names by their name instead
+    std::string GamepadGuid(int fd) {
+        input_id id;
+        if (ioctl(fd, EVIOCGID, &id) < 0 || !id.vendor || !id.product || !id.version)
+            return {};
+        char guid[33];
+        snprintf(guid, sizeof(guid), "%02x%02x0000%02x%02x0000%02x%02x0000%02x%02x0000", id.bustype & 0xff,
+                 id.bustype >> 8, id.vendor & 0xff, id.vendor >> 8, id.product & 0xff, id.product >> 8,
+                 id.version & 0xff, id.version >> 8);
+        return guid;
+    }
+
+    // from -1 to 1 over the axis's range, as GLFW does it
+    float Normalize(int value, int min, int max) {
+        if (max == min)
+            return (float)value;
+        return (float)(value - min) / (max - min) * 2.0f - 1.0f;
+    }
+
+    void SetHat(InputThread::GamepadState& state, int code, int value) {
+        int negative = code == ABS_HAT0X ? dpadLeft : dpadUp;
+        int positive = code == ABS_HAT0X ? dpadRight : dpadDown;
+        state.buttons[negative] = value < 0;
+        state.buttons[positive] = value > 0;
+    }
+#endif
+}
+
+bool InputThread::Start() {
+    Stop();
+    Event stale;
+    while (events.Pop(stale)) {}
+    dropped = 0;
+#ifdef __linux__
+    int keyboards = 0;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator("/dev/input", error)) {
+        if (entry.path().filename().string().rfind("event", 0) != 0)
+            continue;
+        int fd = open(entry.path().c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0)
+            continue;
+        Device device;
+        device.fd = fd;
+        std::string guid;
+        if (IsGamepad(fd)) {
+            guid = GamepadGuid(fd);
+            device.gamepad = !guid.empty();
+        }
+        // have the kernel stamp events on CLOCK_MONOTONIC, which is what
+        // steady_clock reads
+        int clock = CLOCK_MONOTONIC;
+        if ((!device.gamepad && !IsKeyboard(fd)) || ioctl(fd, EVIOCSCLOCKID, &clock) < 0) {
+            close(fd);
+            continue;
+        }
+        if (device.gamepad) {
+            readGamepad(device);
+            gamepadGuids.insert(guid);
+        } else {
+            keyboards++;
+        }
+        devices.push_back(device);
+    }
+    if (devices.empty()) {
+        std::cout << "No keyboards or gamepads could be opened for input, using window events" << std::endl;
+        return false;
+    }
+    std::cout << "Reading input from " << keyboards << " keyboard(s) and " << devices.size() - keyboards
+              << " gamepad(s)" << std::endl;
+    running = true;
+    thread = std::thread(&InputThread::run, this);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void InputThread::Stop() {
+    running = false;
+    if (thread.joinable())
+        thread.join();
+#ifdef __linux__
+    for (const Device& device : devices)
+        close(device.fd);
+#endif
+    devices.clear();
+    gamepadGuids.clear();
+}
+
+void InputThread::run() {
+#ifdef __linux__
+    std::vector<pollfd> fds;
+    for (const Device& device : devices)
+        fds.push_back({ device.fd, POLLIN, 0 });
+    input_event buffer[64];
+    while (running) {
+        if (poll(fds.data(), fds.size(), (int)pollInterval.count()) <= 0)
+            continue;
+        for (int d = 0; d < fds.size(); d++) {
+            pollfd& polled = fds[d];
+            // unplugged; poll skips negative fds, and Stop still closes it
+            if (polled.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+                polled.fd = -1;
+                continue;
+            }
+            if (!(polled.revents & POLLIN))
+                continue;
+            Device& device = devices[d];
+            ssize_t got;
+            while ((got = read(device.fd, buffer, sizeof(buffer))) > 0) {
+                for (int i = 0; i < got / (ssize_t)sizeof(input_event); i++) {
+                    const input_event& input = buffer[i];
+                    Event event;
+                    event.time = SongClock::Clock::time_point(std::chrono::duration_cast<SongClock::Clock::duration>(
+                        std::chrono::seconds(input.input_event_sec) + std::chrono::microseconds(input.input_event_usec)));
+                    if (device.gamepad) {
+                        // a pad's changes come in a burst ended by a report,
+                        // and are queued together
+                        if (input.type == EV_SYN && input.code == SYN_DROPPED) {
+                            readGamepad(device);
+                        } else if (input.type == EV_SYN && input.code == SYN_REPORT && device.changed) {
+                            event.type = Event::Gamepad;
+                            event.gamepad = device.state;
+                            device.changed = false;
+                            if (!events.Push(event))
+                                dropped++;
+                        } else {
+                            updateGamepad(device, input.type, input.code, input.value);
+                        }
+                        continue;
+                    }
+                    // a value of 2 is a repeat
+                    if (input.type != EV_KEY || input.value > 1)
+                        continue;
+                    // X11 keycodes are evdev's plus 8
+                    event.scancode = input.code + 8;
+                    event.action = input.value;
+                    if (!events.Push(event))
+                        dropped++;
+                }
+            }
+        }
+    }
+#endif
+}
+
+void InputThread::updateGamepad(Device& device, int type, int code, int value) {
+#ifdef __linux__
+    if (type == EV_KEY) {
+        int button = IndexOf(gamepadButtons, code);
+        if (button < 0 || value > 1)
+            return;
+        device.state.buttons[button] = value;
+    } else if (type == EV_ABS) {
+        int axis = IndexOf(gamepadAxes, code);
+        if (axis >= 0)
+            device.state.axes[axis] = Normalize(value, device.axisMin[axis], device.axisMax[axis]);
+        else if (code == ABS_HAT0X || code == ABS_HAT0Y)
+            SetHat(device.state, code, value);
+        else
+            return;
+    } else {
+        return;
+    }
+    device.changed = true;
+#endif
+}
+
+void InputThread::readGamepad(Device& device) {
+#ifdef __linux__
+    unsigned long keys[KEY_MAX / longBits + 1] = {};
+    if (ioctl(device.fd, EVIOCGKEY(sizeof(keys)), keys) >= 0) {
+        for (int i = 0; i < 15; i++)
+            device.state.buttons[i] = HasBit(keys, gamepadButtons[i]);
+    }
+    for (int i = 0; i < 6; i++) {
+        input_absinfo info;
+        if (ioctl(device.fd, EVIOCGABS(gamepadAxes[i]), &info) < 0)
+            continue;
+        device.axisMin[i] = info.minimum;
+        device.axisMax[i] = info.maximum;
+        device.state.axes[i] = Normalize(info.value, info.minimum, info.maximum);
+    }
+    for (int code : { ABS_HAT0X, ABS_HAT0Y }) {
+        input_absinfo info;
+        if (ioctl(device.fd, EVIOCGABS(code), &info) >= 0 && info.value != 0)
+            SetHat(device.state, code, info.value);
+    }
+    device.changed = true;
+#endif
+}
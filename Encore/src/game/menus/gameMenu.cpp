@@ -55,7 +55,7 @@ void Menu::DrawBottomBottomOvershell() {
 }
 
 // should be reduced to just PlayerSongStats (instead of Player) eventually
-void Menu::renderPlayerResults(Player player, Song song) {
+void Menu::renderPlayerResults(Player& player, const SongSession& song) {
 
     float cardPos = u.LeftSide + (u.winpct(0.26f) * (float)player.playerNum);
 
@@ -154,7 +154,7 @@ void Menu::renderPlayerResults(Player player, Song song) {
     DrawTextEx(menuAss.rubikBold, TextFormat("%s %s", diffList[player.diff].c_str(), songPartsList[player.instrument].c_str()), {cardPos + u.winpct(0.11f) -
                                                                                                                                           (MeasureTextEx(menuAss.rubikBold, TextFormat("%s %s", diffList[player.diff].c_str(), songPartsList[player.instrument].c_str()), u.hinpct(0.03f),0).x/2), statsHeight+u.hinpct(0.20f)}, u.hinpct(0.03f),0,WHITE);
 
-    int MaxNotes = song.parts[player.instrument]->charts[player.diff].notes.size();
+    int MaxNotes = song.parts[player.instrument].charts[player.diff].notes.size();
     DrawTextEx(menuAss.rubik, TextFormat("%01i/%01i", player.perfectHit, player.notes), {statsRight - MeasureTextEx(menuAss.rubik, TextFormat("%01i/%01i", player.perfectHit, player.notes), u.hinpct(0.03f), 0).x, statsHeight}, u.hinpct(0.03f), 0, WHITE);
     DrawTextEx(menuAss.rubik, TextFormat("%01i/%01i", player.notesHit-player.perfectHit, player.notes), {statsRight - MeasureTextEx(menuAss.rubik, TextFormat("%01i/%01i", player.notesHit-player.perfectHit, player.notes), u.hinpct(0.03f), 0).x, statsHeight+u.hinpct(0.035f)}, u.hinpct(0.03f),0,WHITE);
     DrawTextEx(menuAss.rubik, TextFormat("%01i/%01i", player.notesMissed, player.notes), {statsRight - MeasureTextEx(menuAss.rubik, TextFormat("%01i/%01i", player.notesMissed, player.notes), u.hinpct(0.03f), 0).x, statsHeight+u.hinpct(0.07f)}, u.hinpct(0.03f),0,WHITE);
@@ -164,9 +164,9 @@ void Menu::renderPlayerResults(Player player, Song song) {
 };
 
 // todo: replace player with band stats
-void Menu::renderStars(Player player, float xPos, float yPos, float scale, bool left) {
-    int starsval = player.stars(player.songToBeJudged.parts[player.instrument]->charts[player.diff].baseScore,player.diff);
-    float starPercent = (float)player.score/(float)player.songToBeJudged.parts[player.instrument]->charts[player.diff].baseScore;
+void Menu::renderStars(Player& player, float xPos, float yPos, float scale, bool left) {
+    int starsval = player.stars(player.songToBeJudged->parts[player.instrument].charts[player.diff].baseScore,player.diff);
+    float starPercent = (float)player.score/(float)player.songToBeJudged->parts[player.instrument].charts[player.diff].baseScore;
 
     float starX = left ? 0 : scale*2.5f;
     for (int i = 0; i < 5; i++) {
@@ -224,7 +224,7 @@ void Menu::loadMenu(GLFWgamepadstatefun gamepadStateCallbackSetControls) {
                     SetRandomSeed(std::chrono::system_clock::now().time_since_epoch().count() * GetTime());
                     int my = GetRandomValue(0, (int) songListMenu.songs.size() - 1);
 
-                    ChosenSong = songListMenu.songs[my];
+                    ChosenSong = SongSession(songListMenu.songs[my]);
                     ChosenSong.LoadAlbumArt(ChosenSong.albumArtPath);
                     ChosenSongInt = my;
                     randomSongChosen = true;
@@ -235,7 +235,7 @@ void Menu::loadMenu(GLFWgamepadstatefun gamepadStateCallbackSetControls) {
                 }
 
                 AlbumArtBackground = ChosenSong.albumArtBlur;
-                TraceLog(LOG_INFO, ChosenSong.title.c_str());
+                TraceLog(LOG_INFO, ChosenSong.title.data());
                 songChosen = true;
             } else {
                 AlbumArtBackground = menuAss.highwayTexture;
@@ -251,7 +251,7 @@ void Menu::loadMenu(GLFWgamepadstatefun gamepadStateCallbackSetControls) {
                 menuAudioManager.SetAudioStreamVolume(stream.handle, settings.MainVolume * 0.15f);
 
             }
-            menuAudioManager.BeginPlayback(menuAudioManager.loadedStreams[0].handle);
+            menuAudioManager.BeginPlayback();
         }
         DrawAlbumArtBackground(AlbumArtBackground);
     }
@@ -260,10 +260,10 @@ void Menu::loadMenu(GLFWgamepadstatefun gamepadStateCallbackSetControls) {
     float SplashWidth = MeasureTextEx(menuAss.josefinSansItalic, result.c_str(), SplashFontSize, 0).x;
 
     float SongFontSize = u.hinpct(0.03f);
-    float TitleHeight = MeasureTextEx(menuAss.rubikBoldItalic, ChosenSong.title.c_str(), SongFontSize, 0).y;
-    float TitleWidth = MeasureTextEx(menuAss.rubikBoldItalic, ChosenSong.title.c_str(), SongFontSize, 0).x;
-    float ArtistHeight = MeasureTextEx(menuAss.rubikItalic, ChosenSong.artist.c_str(), SongFontSize, 0).y;
-    float ArtistWidth = MeasureTextEx(menuAss.rubikItalic, ChosenSong.artist.c_str(), SongFontSize, 0).x;
+    float TitleHeight = MeasureTextEx(menuAss.rubikBoldItalic, ChosenSong.title.data(), SongFontSize, 0).y;
+    float TitleWidth = MeasureTextEx(menuAss.rubikBoldItalic, ChosenSong.title.data(), SongFontSize, 0).x;
+    float ArtistHeight = MeasureTextEx(menuAss.rubikItalic, ChosenSong.artist.data(), SongFontSize, 0).y;
+    float ArtistWidth = MeasureTextEx(menuAss.rubikItalic, ChosenSong.artist.data(), SongFontSize, 0).x;
 
     Vector2 SongTitleBox = {u.RightSide - TitleWidth - u.winpct(0.01f),  u.hpct(0.2f) - u.hinpct(0.1f) - (TitleHeight*1.1f)};
     Vector2 SongArtistBox = {u.RightSide - ArtistWidth - u.winpct(0.01f),  u.hpct(0.2f) - u.hinpct(0.1f)};
@@ -308,18 +308,18 @@ void Menu::loadMenu(GLFWgamepadstatefun gamepadStateCallbackSetControls) {
             menuAudioManager.unloadStreams();
             streamsLoaded = false;
             streamsPaused = false;
-            for (Song &songi: songListMenu.songs) {
+            for (SongMetadata &songi: songListMenu.songs) {
                 songi.titleScrollTime = GetTime();
-                songi.titleTextWidth = menuAss.MeasureTextRubik(songi.title.c_str(), 24);
+                songi.titleTextWidth = menuAss.MeasureTextRubik(songi.title.data(), 24);
                 songi.artistScrollTime = GetTime();
-                songi.artistTextWidth = menuAss.MeasureTextRubik(songi.artist.c_str(), 20);
+                songi.artistTextWidth = menuAss.MeasureTextRubik(songi.artist.data(), 20);
             }
             Menu::SwitchScreen(SONG_SELECT);
         }
     } else {
         GuiSetStyle(BUTTON,BASE_COLOR_NORMAL, ColorToInt(Color{128,0,0,255}));
         GuiButton({u.wpct(0.02f), u.hpct(0.3f), u.winpct(0.2f), u.hinpct(0.08f)}, "Invalid song cache!");
-        songListMenu.ScanSongs(settings.songPaths); 
+        songListMenu.StartLoading(settings.songPaths, true);
         songsLoaded = false;
         DrawRectanglePro({((float) GetScreenWidth() / 2) - 125, ((float) GetScreenHeight() / 2) - 120, 250, 60},{0,0},0, Color{0,0,0,64});
         GuiSetStyle(BUTTON,BASE_COLOR_NORMAL, 0x181827FF);
@@ -360,16 +360,16 @@ void Menu::loadMenu(GLFWgamepadstatefun gamepadStateCallbackSetControls) {
     if (streamsLoaded) {
         SongTitleBox.x = SongTitleBox.x - u.hinpct(0.12f);
         SongArtistBox.x = SongArtistBox.x - u.hinpct(0.12f);
-        DrawTextEx(menuAss.rubikBoldItalic, ChosenSong.title.c_str(), SongTitleBox, SongFontSize, 0, WHITE);
-        DrawTextEx(menuAss.rubikItalic, ChosenSong.artist.c_str(), SongArtistBox, SongFontSize, 0, WHITE);
+        DrawTextEx(menuAss.rubikBoldItalic, ChosenSong.title.data(), SongTitleBox, SongFontSize, 0, WHITE);
+        DrawTextEx(menuAss.rubikItalic, ChosenSong.artist.data(), SongArtistBox, SongFontSize, 0, WHITE);
 
 
 
         for (auto& stream : menuAudioManager.loadedStreams) {
             menuAudioManager.SetAudioStreamVolume(stream.handle, settings.MainVolume * settings.MenuVolume);
         }
-        float played = menuAudioManager.GetMusicTimePlayed(menuAudioManager.loadedStreams[0].handle);
-        float length = menuAudioManager.GetMusicTimeLength(menuAudioManager.loadedStreams[0].handle);
+        float played = menuAudioManager.GetMusicTimePlayed();
+        float length = menuAudioManager.GetMusicTimeLength();
         DrawRectangle(0, u.hpct(0.2f) - u.hinpct(0.01f), Remap(played, 0, length, 0, GetScreenWidth()),
                       u.hinpct(0.005f), SKYBLUE);
 
@@ -402,8 +402,8 @@ void Menu::loadMenu(GLFWgamepadstatefun gamepadStateCallbackSetControls) {
         }
         GuiSetStyle(BUTTON, BORDER_WIDTH, 2);
     } else {
-        DrawTextEx(menuAss.rubikBoldItalic, ChosenSong.title.c_str(), SongTitleBox, SongFontSize, 0, WHITE);
-        DrawTextEx(menuAss.rubikItalic, ChosenSong.artist.c_str(), SongArtistBox, SongFontSize, 0, WHITE);
+        DrawTextEx(menuAss.rubikBoldItalic, ChosenSong.title.data(), SongTitleBox, SongFontSize, 0, WHITE);
+        DrawTextEx(menuAss.rubikItalic, ChosenSong.artist.data(), SongArtistBox, SongFontSize, 0, WHITE);
     }
 }
 
@@ -411,7 +411,7 @@ bool AlbumArtLoadingStuff = false;
 void Menu::showResults(Player &player) {
 
     for (int i = 0; i < 4; i++) {
-        renderPlayerResults(player, ChosenSong);
+        renderPlayerResults(player, *player.songToBeJudged);
     }
 
     DrawTopOvershell(0.2f);
@@ -420,15 +420,15 @@ void Menu::showResults(Player &player) {
 
     DrawTextEx(menuAss.josefinSansItalic, TextFormat("%s-%s",menuVersion.c_str() , menuCommitHash.c_str()), {u.wpct(0), u.hpct(0)}, u.hinpct(0.025f), 0, WHITE);
 
-    float songNamePos = (float)GetScreenWidth()/2 - MeasureTextEx(menuAss.redHatDisplayBlack,player.songToBeJudged.title.c_str(), u.hinpct(0.09f), 0).x/2;
+    float songNamePos = (float)GetScreenWidth()/2 - MeasureTextEx(menuAss.redHatDisplayBlack,player.songToBeJudged->title.data(), u.hinpct(0.09f), 0).x/2;
     float bigScorePos = (float)GetScreenWidth()/2 - u.winpct(0.04f) - MeasureTextEx(menuAss.redHatDisplayItalicLarge,scoreCommaFormatter(player.score).c_str(), u.hinpct(0.08f), 0).x;
     float bigStarPos = (float)GetScreenWidth()/2 + u.winpct(0.005f);
 
 
-    DrawTextEx(menuAss.redHatDisplayBlack, player.songToBeJudged.title.c_str(), {songNamePos,u.hpct(0.01f)},u.hinpct(0.09f),0,WHITE);
+    DrawTextEx(menuAss.redHatDisplayBlack, player.songToBeJudged->title.data(), {songNamePos,u.hpct(0.01f)},u.hinpct(0.09f),0,WHITE);
     DrawTextEx(menuAss.redHatDisplayItalicLarge, scoreCommaFormatter(player.score).c_str(), {bigScorePos,u.hpct(0.1f)},u.hinpct(0.08f),0, GetColor(0x00adffFF));
     renderStars(player, bigStarPos, u.hpct(0.1125f), u.hinpct(0.055f),true);
-    // assets.DrawTextRHDI(player.songToBeJudged.title.c_str(),songNamePos, 50, WHITE);
+    // assets.DrawTextRHDI(player.songToBeJudged->title.data(),songNamePos, 50, WHITE);
 }
 
 void Menu::SwitchScreen(Screens screen){
@@ -0,0 +1,112 @@
+#include "game/songclock.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    double Seconds(SongClock::Clock::duration duration) {
+        return std::chrono::duration<double>(duration).count();
+    }
+}
+
+double SongClock::At(Clock::time_point t) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return positionAt(t) - latency;
+}
+
+void SongClock::Set(double position, bool running) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Clock::time_point now = Clock::now();
+    anchor(position, now, 1);
+    this->running = running;
+    offsetCount = 0;
+    nextOffset = 0;
+    // sample straight away rather than waiting out the interval
+    lastSample = now - sampleInterval;
+    haveFrame = false;
+}
+
+bool SongClock::Running() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return running;
+}
+
+bool SongClock::Update(Clock::time_point t) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!running) {
+        haveFrame = false;
+        return false;
+    }
+    double time = positionAt(t);
+    if (haveFrame) {
+        double error = std::abs((time - lastFrameTime) - Seconds(t - lastFrame));
+        stats.frames++;
+        frameErrorSquares += error * error;
+        stats.frameErrorMax = std::max(stats.frameErrorMax, error);
+    }
+    lastFrame = t;
+    lastFrameTime = time;
+    haveFrame = true;
+    return t - lastSample >= sampleInterval;
+}
+
+void SongClock::Sample(double position, Clock::time_point t) {
+    std::lock_guard<std::mutex> lock(mutex);
+    lastSample = t;
+    if (!running)
+        return;
+    double current = positionAt(t);
+    double error = position - current;
+    stats.samples++;
+    sampleErrorSquares += error * error;
+    stats.sampleErrorMax = std::max(stats.sampleErrorMax, std::abs(error));
+
+    double offset = position - Seconds(t.time_since_epoch());
+    if (std::abs(error) > snapError) {
+        stats.snaps++;
+        anchor(position, t, 1);
+        offsets[0] = offset;
+        offsetCount = 1;
+        nextOffset = 1;
+        return;
+    }
+    offsets[nextOffset] = offset;
+    nextOffset = (nextOffset + 1) % windowSize;
+    offsetCount = std::min(offsetCount + 1, windowSize);
+    double latest = *std::max_element(offsets, offsets + offsetCount);
+    double steer = std::clamp((Seconds(t.time_since_epoch()) + latest - current) / steerTime, -maxSteer, maxSteer);
+    anchor(current, t, 1 + steer);
+}
+
+void SongClock::SetOutputLatency(double seconds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    latency = seconds;
+}
+
+SongClock::Stats SongClock::GetStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats result = stats;
+    if (stats.samples > 0)
+        result.sampleErrorRms = std::sqrt(sampleErrorSquares / stats.samples);
+    if (stats.frames > 0)
+        result.frameErrorRms = std::sqrt(frameErrorSquares / stats.frames);
+    return result;
+}
+
+void SongClock::ResetStats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    stats = Stats();
+    sampleErrorSquares = 0;
+    frameErrorSquares = 0;
+}
+
+double SongClock::positionAt(Clock::time_point t) const {
+    if (!running)
+        return anchorPosition;
+    return anchorPosition + Seconds(t - anchorTime) * rate;
+}
+
+void SongClock::anchor(double position, Clock::time_point t, double newRate) {
+    anchorPosition = position;
+    anchorTime = t;
+    rate = newRate;
+}
@@ -0,0 +1,260 @@
+#include "game/stemcache.h"
+#include "bass/bass.h"
+#include "picosha2.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <set>
+
+void StemCache::Configure(const std::filesystem::path& directory, uint64_t budgetBytes) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->directory = directory;
+        budget = budgetBytes;
+    }
+    evict({});
+}
+
+std::shared_ptr<const CachedStem> StemCache::Request(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = live.begin(); it != live.end();)
+        it = it->second.expired() ? live.erase(it) : std::next(it);
+    if (auto it = live.find(path); it != live.end()) {
+        std::shared_ptr<CachedStem> existing = it->second.lock();
+        if (existing && !existing->failed)
+            return existing;
+    }
+
+    auto stem = std::make_shared<CachedStem>();
+    stem->path = path;
+    live[path] = stem;
+    jobs.push_back(stem);
+    if (workers.empty()) {
+        stopping = false;
+        int count = std::clamp((int)std::thread::hardware_concurrency() / 2, 1, maxWorkers);
+        for (int i = 0; i < count; i++)
+            workers.emplace_back(&StemCache::work, this);
+    }
+    wake.notify_one();
+    return stem;
+}
+
+void StemCache::Stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        for (auto& stem : jobs)
+            stem->failed = true;
+        jobs.clear();
+    }
+    wake.notify_all();
+    decoded.notify_all();
+    for (std::thread& worker : workers) {
+        if (worker.joinable())
+            worker.join();
+    }
+    workers.clear();
+}
+
+void StemCache::work() {
+    while (true) {
+        std::shared_ptr<CachedStem> stem;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping)
+                return;
+            stem = jobs.front();
+            jobs.pop_front();
+        }
+        // the song was left before its turn came
+        if (stem.use_count() == 1) {
+            stem->failed = true;
+            continue;
+        }
+        if (fill(*stem))
+            stem->ready.store(true, std::memory_order_release);
+        else
+            stem->failed = true;
+    }
+}
+
+bool StemCache::fill(CachedStem& stem) {
+    std::filesystem::path cacheDirectory;
+    uint64_t cacheBudget;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        cacheDirectory = directory;
+        cacheBudget = budget;
+    }
+    if (cacheBudget == 0)
+        return false;
+
+    MappedFile source;
+    if (!source.Open(stem.path))
+        return false;
+    std::string hash = picosha2::hash256_hex_string(source.Data(), source.Data() + source.Size());
+    source.Close();
+
+    std::filesystem::path file = cacheDirectory / (hash + ".pcm");
+    std::error_code error;
+    bool cached;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        stem.hash = hash;
+        // stems with the same contents share one file; whoever gets there
+        // second waits for the first to decode it, and only decodes it
+        // itself if that failed
+        decoded.wait(lock, [&] { return stopping || !decoding.count(hash); });
+        if (stopping)
+            return false;
+        cached = std::filesystem::exists(file, error);
+        if (!cached)
+            decoding.insert(hash);
+    }
+    if (cached) {
+        // the write time is when it was last used, for eviction
+        std::filesystem::last_write_time(file, std::filesystem::file_time_type::clock::now(), error);
+    } else {
+        bool written = write(stem.path, file, cacheBudget);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            decoding.erase(hash);
+        }
+        decoded.notify_all();
+        if (!written)
+            return false;
+        evict(file);
+    }
+    if (!open(stem, file)) {
+        std::cerr << "Removing a broken cached stem: " << file.string() << std::endl;
+        std::filesystem::remove(file, error);
+        return false;
+    }
+    return true;
+}
+
+bool StemCache::write(const std::string& path, const std::filesystem::path& file, uint64_t budget) {
+    std::error_code error;
+    std::filesystem::create_directories(file.parent_path(), error);
+    // named for this write alone, so nothing else can write over it before
+    // it's renamed
+    std::filesystem::path part = file;
+    part += "." + std::to_string(parts++) + ".part";
+    if (!decode(path, part, budget)) {
+        std::filesystem::remove(part, error);
+        return false;
+    }
+    std::filesystem::rename(part, file, error);
+    if (error) {
+        std::filesystem::remove(part, error);
+        return false;
+    }
+    return true;
+}
+
+bool StemCache::decode(const std::string& path, const std::filesystem::path& to, uint64_t budget) {
+    HSTREAM decoder = BASS_StreamCreateFile(false, path.c_str(), 0, 0, BASS_STREAM_DECODE);
+    if (!decoder)
+        return false;
+    BASS_CHANNELINFO info;
+    BASS_ChannelGetInfo(decoder, &info);
+    QWORD length = BASS_ChannelGetLength(decoder, BASS_POS_BYTE);
+    if ((info.flags & (BASS_SAMPLE_8BITS | BASS_SAMPLE_FLOAT)) || info.chans == 0
+        || (length != (QWORD)-1 && length + sizeof(Header) > budget)) {
+        BASS_StreamFree(decoder);
+        return false;
+    }
+
+    std::ofstream out(to, std::ios::binary | std::ios::trunc);
+    Header header = { { 'E', 'P', 'C', 'M' }, version, info.freq, info.chans, 0 };
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    std::vector<char> buffer(1 << 16);
+    uint64_t bytes = 0;
+    while (!stopping && out) {
+        DWORD got = BASS_ChannelGetData(decoder, buffer.data(), (DWORD)buffer.size());
+        if (got == (DWORD)-1 || got == 0)
+            break;
+        out.write(buffer.data(), got);
+        bytes += got;
+    }
+    bool finished = !stopping && BASS_ChannelIsActive(decoder) != BASS_ACTIVE_PLAYING;
+    BASS_StreamFree(decoder);
+    if (!finished)
+        return false;
+
+    header.frames = bytes / (info.chans * sizeof(int16_t));
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.close();
+    if (!out)
+        return false;
+    std::cout << "Cached stem " << path << " (" << bytes / (1024 * 1024) << " MB)" << std::endl;
+    return true;
+}
+
+bool StemCache::open(CachedStem& stem, const std::filesystem::path& from) {
+    if (!stem.file.Open(from.string()))
+        return false;
+    Header header;
+    if (stem.file.Size() < sizeof(header)) {
+        stem.file.Close();
+        return false;
+    }
+    std::memcpy(&header, stem.file.Data(), sizeof(header));
+    if (std::memcmp(header.magic, "EPCM", 4) != 0 || header.version != version || header.channels == 0
+        || stem.file.Size() != sizeof(header) + header.frames * header.channels * sizeof(int16_t)) {
+        stem.file.Close();
+        return false;
+    }
+    stem.freq = header.freq;
+    stem.channels = (int)header.channels;
+    stem.frames = header.frames;
+    stem.samples = reinterpret_cast<const int16_t*>(stem.file.Data() + sizeof(header));
+    return true;
+}
+
+void StemCache::evict(const std::filesystem::path& keep) {
+    std::filesystem::path cacheDirectory;
+    uint64_t cacheBudget;
+    std::set<std::string> held;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        cacheDirectory = directory;
+        cacheBudget = budget;
+        for (auto& [path, weak] : live) {
+            if (std::shared_ptr<CachedStem> stem = weak.lock(); stem && !stem->hash.empty())
+                held.insert(stem->hash + ".pcm");
+        }
+    }
+    if (cacheDirectory.empty())
+        return;
+
+    struct Entry {
+        std::filesystem::file_time_type used;
+        uint64_t size;
+        std::filesystem::path path;
+    };
+    std::vector<Entry> files;
+    uint64_t total = 0;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(cacheDirectory, error)) {
+        if (entry.path().extension() != ".pcm")
+            continue;
+        Entry file = { entry.last_write_time(error), entry.file_size(error), entry.path() };
+        if (error)
+            continue;
+        files.push_back(file);
+        total += file.size;
+    }
+    std::sort(files.begin(), files.end(), [](const Entry& a, const Entry& b) { return a.used < b.used; });
+    for (const Entry& file : files) {
+        if (total <= cacheBudget)
+            break;
+        if (file.path == keep || held.count(file.path.filename().string()))
+            continue;
+        if (std::filesystem::remove(file.path, error))
+            total -= file.size;
+    }
+}
@@ -0,0 +1,290 @@
+#include "game/stemmixer.h"
+#include "bass/bass.h"
+#include <algorithm>
+#include <iostream>
+#include <map>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+    #include <emmintrin.h>
+    #define STEMMIXER_SSE
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+    #include <arm_neon.h>
+    #define STEMMIXER_NEON
+#endif
+
+namespace {
+    DWORD CALLBACK MixProc(HSTREAM, void* buffer, DWORD length, void* user) {
+        return static_cast<StemMixer*>(user)->Mix(static_cast<float*>(buffer), length);
+    }
+
+    // out += in * gain, for a stem with as many channels as the output, with
+    // the gain going up by step every frame
+    void MixFrames(float* out, const float* in, int frames, int channels, float gain, float step) {
+        int samples = frames * channels;
+        int i = 0;
+#if defined(STEMMIXER_SSE) || defined(STEMMIXER_NEON)
+        // four samples at a time, which is a whole number of frames for one,
+        // two or four channels
+        if (channels == 1 || channels == 2 || channels == 4) {
+            int framesPerVector = 4 / channels;
+            float lanes[4];
+            for (int lane = 0; lane < 4; lane++)
+                lanes[lane] = gain + step * (lane / channels);
+#if defined(STEMMIXER_SSE)
+            __m128 gains = _mm_loadu_ps(lanes);
+            __m128 steps = _mm_set1_ps(step * framesPerVector);
+            for (; i + 4 <= samples; i += 4) {
+                __m128 mixed = _mm_add_ps(_mm_loadu_ps(out + i), _mm_mul_ps(_mm_loadu_ps(in + i), gains));
+                _mm_storeu_ps(out + i, mixed);
+                gains = _mm_add_ps(gains, steps);
+            }
+#else
+            float32x4_t gains = vld1q_f32(lanes);
+            float32x4_t steps = vdupq_n_f32(step * framesPerVector);
+            for (; i + 4 <= samples; i += 4) {
+                vst1q_f32(out + i, vmlaq_f32(vld1q_f32(out + i), vld1q_f32(in + i), gains));
+                gains = vaddq_f32(gains, steps);
+            }
+#endif
+        }
+#endif
+        for (int frame = i / channels; frame < frames; frame++) {
+            float frameGain = gain + step * frame;
+            for (int channel = 0; channel < channels; channel++)
+                out[frame * channels + channel] += in[frame * channels + channel] * frameGain;
+        }
+    }
+
+    // the same for a stem with fewer channels, whose channels are repeated
+    // across the output's, so a mono stem goes into every one
+    void MixNarrowFrames(float* out, const float* in, int frames, int channels, int inChannels, float gain,
+                         float step) {
+        for (int frame = 0; frame < frames; frame++) {
+            float frameGain = gain + step * frame;
+            for (int channel = 0; channel < channels; channel++)
+                out[frame * channels + channel] += in[frame * inChannels + channel % inChannels] * frameGain;
+        }
+    }
+
+    void MixStemFrames(float* out, const float* in, int frames, int channels, int inChannels, float gain,
+                       float step) {
+        if (inChannels == channels)
+            MixFrames(out, in, frames, channels, gain, step);
+        else
+            MixNarrowFrames(out, in, frames, channels, inChannels, gain, step);
+    }
+}
+
+std::vector<int> StemMixer::Load(const std::vector<std::string>& paths, bool useCache) {
+    Unload();
+    std::vector<int> kept;
+    // every stem is opened before the output's format is settled on
+    std::map<unsigned int, int> rates;
+    for (int i = 0; i < paths.size(); i++) {
+        HSTREAM decoder = BASS_StreamCreateFile(false, paths[i].c_str(), 0, 0, BASS_STREAM_DECODE | BASS_SAMPLE_FLOAT);
+        if (!decoder) {
+            std::cerr << "Failed to load stream: " << paths[i] << std::endl;
+            continue;
+        }
+        BASS_CHANNELINFO info;
+        BASS_ChannelGetInfo(decoder, &info);
+        Stem stem;
+        stem.decoder = decoder;
+        stem.freq = info.freq;
+        stem.channels = info.chans;
+        if (useCache)
+            stem.cached = StemCache::getInstance().Request(paths[i]);
+        stems.push_back(stem);
+        length = std::max(length, BASS_ChannelBytes2Seconds(decoder, BASS_ChannelGetLength(decoder, BASS_POS_BYTE)));
+        channels = std::max(channels, (int)info.chans);
+        rates[info.freq]++;
+        kept.push_back(i);
+    }
+    if (stems.empty())
+        return kept;
+
+    // the fewest stems resampled, and the higher rate if it's a tie
+    freq = std::max_element(rates.begin(), rates.end(), [](const auto& a, const auto& b) {
+        return a.second < b.second || (a.second == b.second && a.first < b.first);
+    })->first;
+    for (Stem& stem : stems) {
+        if (stem.freq == freq)
+            continue;
+        std::cout << "Resampling a stem from " << stem.freq << " Hz to " << freq << " Hz" << std::endl;
+        // a block's worth, so the mix never allocates
+        stem.held.reserve(((size_t)(blockFrames * (double)stem.freq / freq) + 3) * stem.channels);
+    }
+    rampFrames = std::max(1, (int)(freq * rampTime));
+    scratch.assign(blockFrames * channels, 0.0f);
+    postedGains.assign(stems.size(), 0.0f);
+    start = 0;
+    output = BASS_StreamCreate(freq, channels, BASS_SAMPLE_FLOAT, MixProc, this);
+    if (!output) {
+        std::cerr << "Failed to create the mix stream, BASS error " << BASS_ErrorGetCode() << std::endl;
+        Unload();
+        return {};
+    }
+    return kept;
+}
+
+void StemMixer::Unload() {
+    if (output) {
+        BASS_StreamFree(output);
+        output = 0;
+    }
+    // let a mix that's already running finish before its stems go
+    std::lock_guard<std::mutex> lock(mixMutex);
+    for (Stem& stem : stems)
+        BASS_StreamFree(stem.decoder);
+    stems.clear();
+    postedGains.clear();
+    GainChange change;
+    while (gainChanges.Pop(change)) {}
+    length = 0;
+    start = 0;
+    freq = 0;
+    channels = 0;
+}
+
+void StemMixer::SetGain(int stem, float gain) {
+    if (stem < 0 || stem >= postedGains.size() || postedGains[stem] == gain)
+        return;
+    if (gainChanges.Push({ stem, gain }))
+        postedGains[stem] = gain;
+}
+
+void StemMixer::Seek(double seconds) {
+    {
+        std::lock_guard<std::mutex> lock(mixMutex);
+        for (Stem& stem : stems) {
+            double frame = seconds * stem.freq;
+            stem.frame = (uint64_t)frame;
+            stem.held.clear();
+            stem.heldPosition = frame - stem.frame;
+            if (stem.fromCache) {
+                stem.ended = stem.frame >= stem.cached->frames;
+                continue;
+            }
+            QWORD bytes = BASS_ChannelSeconds2Bytes(stem.decoder, seconds);
+            stem.ended = !BASS_ChannelSetPosition(stem.decoder, bytes, BASS_POS_BYTE);
+        }
+        start = seconds;
+    }
+    // throws away what's buffered, and starts the position again from 0
+    if (output)
+        BASS_ChannelSetPosition(output, 0, BASS_POS_BYTE);
+}
+
+double StemMixer::Position() const {
+    if (!output)
+        return 0;
+    return start + BASS_ChannelBytes2Seconds(output, BASS_ChannelGetPosition(output, BASS_POS_BYTE));
+}
+
+double StemMixer::Length() const {
+    return length;
+}
+
+unsigned int StemMixer::Mix(float* out, unsigned int size) {
+    std::lock_guard<std::mutex> lock(mixMutex);
+    GainChange change;
+    while (gainChanges.Pop(change)) {
+        Stem& stem = stems[change.stem];
+        // from wherever an earlier ramp got to
+        stem.step = (change.gain - stem.gain) / rampFrames;
+        stem.rampLeft = rampFrames;
+        stem.target = change.gain;
+    }
+
+    int frames = size / (sizeof(float) * channels);
+    std::fill(out, out + frames * channels, 0.0f);
+    int longest = 0;
+    bool allEnded = true;
+    for (Stem& stem : stems) {
+        if (!stem.fromCache && stem.cached && stem.cached->ready.load(std::memory_order_acquire)) {
+            // it carries on from the same frame, so the switch can't be heard
+            if (stem.cached->freq == stem.freq && stem.cached->channels == stem.channels)
+                stem.fromCache = true;
+            else
+                stem.cached.reset();
+        }
+        int done = 0;
+        while (done < frames && !stem.ended) {
+            int block = std::min(blockFrames, frames - done);
+            int gotFrames = read(stem, block);
+            float* to = out + done * channels;
+            int ramped = std::min(gotFrames, stem.rampLeft);
+            if (ramped > 0) {
+                MixStemFrames(to, scratch.data(), ramped, channels, stem.channels, stem.gain, stem.step);
+                stem.rampLeft -= ramped;
+                stem.gain = stem.rampLeft == 0 ? stem.target : stem.gain + stem.step * ramped;
+            }
+            // a silent stem still has to be decoded to keep its place
+            if (gotFrames > ramped && stem.gain != 0)
+                MixStemFrames(to + ramped * channels, scratch.data() + ramped * stem.channels, gotFrames - ramped,
+                              channels, stem.channels, stem.gain, 0);
+            done += gotFrames;
+            if (gotFrames < block) {
+                if (stem.fromCache || BASS_ChannelIsActive(stem.decoder) != BASS_ACTIVE_PLAYING)
+                    stem.ended = true;
+                break;
+            }
+        }
+        longest = std::max(longest, done);
+        allEnded = allEnded && stem.ended;
+    }
+    if (allEnded)
+        return longest * channels * sizeof(float) | BASS_STREAMPROC_END;
+    return frames * channels * sizeof(float);
+}
+
+int StemMixer::read(Stem& stem, int frames) {
+    if (stem.freq == freq)
+        return readSource(stem, scratch.data(), frames);
+
+    // linear interpolation between the frames either side of each output
+    // frame, which is plenty for stems that are only occasionally off-rate
+    double ratio = (double)stem.freq / freq;
+    int channels = stem.channels;
+    int have = (int)(stem.held.size() / channels);
+    int needed = (int)(stem.heldPosition + (frames - 1) * ratio) + 2;
+    if (have < needed) {
+        stem.held.resize(needed * channels);
+        have += readSource(stem, stem.held.data() + have * channels, needed - have);
+        stem.held.resize(have * channels);
+    }
+    int got = 0;
+    for (; got < frames; got++) {
+        double position = stem.heldPosition + got * ratio;
+        int before = (int)position;
+        if (before + 1 >= have)
+            break;
+        float t = (float)(position - before);
+        const float* a = stem.held.data() + before * channels;
+        const float* b = a + channels;
+        for (int channel = 0; channel < channels; channel++)
+            scratch[got * channels + channel] = a[channel] + (b[channel] - a[channel]) * t;
+    }
+    double next = stem.heldPosition + got * ratio;
+    int used = std::min((int)next, have);
+    stem.held.erase(stem.held.begin(), stem.held.begin() + used * channels);
+    stem.heldPosition = next - used;
+    return got;
+}
+
+int StemMixer::readSource(Stem& stem, float* to, int frames) {
+    if (stem.fromCache) {
+        const CachedStem& cached = *stem.cached;
+        int got = (int)std::min<uint64_t>(frames, cached.frames - std::min(stem.frame, cached.frames));
+        const int16_t* from = cached.samples + stem.frame * stem.channels;
+        for (int i = 0; i < got * stem.channels; i++)
+            to[i] = from[i] * (1.0f / 32768);
+        stem.frame += got;
+        return got;
+    }
+    DWORD bytes = frames * stem.channels * sizeof(float);
+    DWORD got = BASS_ChannelGetData(stem.decoder, to, bytes | BASS_DATA_FLOAT);
+    int gotFrames = got == (DWORD)-1 ? 0 : got / (stem.channels * sizeof(float));
+    stem.frame += gotFrames;
+    return gotFrames;
+}
@@ -12,12 +12,16 @@
 #include <filesystem>
 #include "song/song.h"
 #include "song/songlist.h"
+#include "song/songwatcher.h"
+#include "song/chartcache.h"
 #include "game/arguments.h"
 #include "game/utility.h"
 #include "game/player.h"
 #include "game/lerp.h"
 #include "game/keybinds.h"
 #include "game/settings.h"
+#include "game/stemcache.h"
+#include "game/inputthread.h"
 #include "raygui.h"
 #include <random>
 #include "GLFW/glfw3.h"
@@ -31,6 +35,7 @@
 
 #include <thread>
 #include <condition_variable>
+#include <unordered_map>
 
 Menu &menu = Menu::getInstance();
 Player player = Player::getInstance();
@@ -67,6 +72,8 @@ bool instSelected = false;
 
 int curNoteIndex = 0;
 int curPlayingSong = 0;
+// the song being played, made from its list entry when it is picked
+SongSession playingSong;
 int selLane = 0;
 bool selSong = false;
 int songSelectOffset = 0;
@@ -120,7 +127,8 @@ int axisDirection = -1;
 int controllerID = -1;
 
 int currentSortValue = 0;
-std::vector<std::string> sortTypes{"Title", "Artist", "Length"};
+std::vector<std::string> sortTypes{"Title", "Artist", "Length", "Album", "Year", "Genre", "Charter"};
+std::string songSearchQuery;
 
 static void DrawTextRubik(const char *text, float posX, float posY, float fontSize, Color color) {
 	DrawTextEx(assets.rubik, text, {posX, posY}, fontSize, 0, color);
@@ -159,7 +167,7 @@ bool FAS = false;
 int strummedNote = 0;
 int FASNote = 0;
 
-static void handleInputs(int lane, int action) {
+static void handleInputs(int lane, int action, double eventTime) {
 	if (player.paused) return;
 	if (lane == -2) return;
 	if (settingsMain.mirrorMode && lane != -1 && !player.plastic) {
@@ -168,8 +176,9 @@ static void handleInputs(int lane, int action) {
 	if (!streamsLoaded) {
 		return;
 	}
-	Chart &curChart = songList.songs[curPlayingSong].parts[player.instrument]->charts[player.diff];
-	float eventTime = audioManager.GetMusicTimePlayed(audioManager.loadedStreams[0].handle);
+	Chart &curChart = playingSong.parts[player.instrument].charts[player.diff];
+	ChartNotes &notes = curChart.notes;
+	NoteStates &noteStates = curChart.noteStates;
 	if (player.instrument != 4) {
 		if (action == GLFW_PRESS && (lane == -1) && player.overdriveFill > 0 && !player.overdrive) {
 			player.overdriveActiveTime = eventTime;
@@ -184,11 +193,11 @@ static void handleInputs(int lane, int action) {
 				if ((action == GLFW_PRESS && !overdriveHitAvailable) ||
 					(action == GLFW_RELEASE && !overdriveLiftAvailable))
 					return;
-				Note *curNote = &curChart.notes[0];
-				for (auto &note: curChart.notes) {
-					if (note.isGood(eventTime, player.InputOffset) &&
-						!note.hit) {
-						curNote = &note;
+				int curNote = 0;
+				for (int note = 0; note < notes.size(); note++) {
+					if (notes.isGood(note, eventTime, player.InputOffset) &&
+						!noteStates.is(note, NoteHit)) {
+						curNote = note;
 						break;
 					}
 				}
@@ -198,32 +207,31 @@ static void handleInputs(int lane, int action) {
 					overdriveHeld = false;
 				}
 				if (action == GLFW_PRESS && overdriveHitAvailable) {
-					if (curNote->isGood(eventTime, player.InputOffset) &&
-						!curNote->hit) {
+					if (notes.isGood(curNote, eventTime, player.InputOffset) &&
+						!noteStates.is(curNote, NoteHit)) {
 						for (int newlane = 0; newlane < 5; newlane++) {
-							int chordLane = curChart.findNoteIdx(curNote->time, newlane);
+							int chordLane = curChart.findNoteIdx(notes.time[curNote], newlane);
 							if (chordLane != -1) {
-								Note &chordNote = curChart.notes[chordLane];
-								if (!chordNote.accounted) {
-									chordNote.hit = true;
+								int chordNote = chordLane;
+								if (!noteStates.is(chordNote, NoteAccounted)) {
+									noteStates.set(chordNote, NoteHit);
 									overdriveLanesHit[newlane] = true;
-									chordNote.hitTime = eventTime;
+									noteStates.hitTime(chordNote) = eventTime;
 
-									if ((chordNote.len) > 0 && !chordNote.lift) {
-										chordNote.held = true;
+									if ((notes.len[chordNote]) > 0 && !notes.is(chordNote, NoteLift)) {
+										noteStates.set(chordNote, NoteHeld);
 									}
-									if (chordNote.isPerfect(
-										eventTime, player.InputOffset)) {
-										chordNote.perfect = true;
+									if (notes.isPerfect(chordNote, eventTime, player.InputOffset)) {
+										noteStates.set(chordNote, NotePerfect);
 									}
-									if (chordNote.perfect)
+									if (noteStates.is(chordNote, NotePerfect))
 										player.lastNotePerfect = true;
 									else player.lastNotePerfect = false;
-									chordNote.HitOffset =
-											chordNote.time - eventTime;
+									noteStates.hitOffset(chordNote) =
+											notes.time[chordNote] - eventTime;
 									player.HitNote(
-										chordNote.perfect, player.instrument);
-									chordNote.accounted = true;
+										noteStates.is(chordNote, NotePerfect), player.instrument);
+									noteStates.set(chordNote, NoteAccounted);
 								}
 							}
 						}
@@ -231,29 +239,28 @@ static void handleInputs(int lane, int action) {
 						overdriveLiftAvailable = true;
 					}
 				} else if (action == GLFW_RELEASE && overdriveLiftAvailable) {
-					if (curNote->isGood(eventTime, player.InputOffset) &&
-						!curNote->hit) {
+					if (notes.isGood(curNote, eventTime, player.InputOffset) &&
+						!noteStates.is(curNote, NoteHit)) {
 						for (int newlane = 0; newlane < 5; newlane++) {
 							if (overdriveLanesHit[newlane]) {
 								int chordLane = curChart.findNoteIdx(
-									curNote->time, newlane);
+									notes.time[curNote], newlane);
 								if (chordLane != -1) {
-									Note &chordNote = curChart.notes[chordLane];
-									if (chordNote.lift) {
-										chordNote.hit = true;
-										chordNote.HitOffset =
-												chordNote.time -
+									int chordNote = chordLane;
+									if (notes.is(chordNote, NoteLift)) {
+										noteStates.set(chordNote, NoteHit);
+										noteStates.hitOffset(chordNote) =
+												notes.time[chordNote] -
 												eventTime;
 										overdriveLanesHit[newlane] = false;
-										chordNote.hitTime = eventTime;
+										noteStates.hitTime(chordNote) = eventTime;
 
-										if (chordNote.isPerfect(
-											eventTime,
+										if (notes.isPerfect(chordNote, eventTime,
 											player.InputOffset)) {
-											chordNote.perfect = true;
+											noteStates.set(chordNote, NotePerfect);
 										}
-										chordNote.accounted = true;
-										if (chordNote.perfect)
+										noteStates.set(chordNote, NoteAccounted);
+										if (noteStates.is(chordNote, NotePerfect))
 											player.lastNotePerfect = true;
 										else player.lastNotePerfect = false;
 									}
@@ -263,19 +270,19 @@ static void handleInputs(int lane, int action) {
 						overdriveLiftAvailable = false;
 					}
 				}
-				if (action == GLFW_RELEASE && curNote->held && (curNote->len) > 0 &&
+				if (action == GLFW_RELEASE && noteStates.is(curNote, NoteHeld) && (notes.len[curNote]) > 0 &&
 					overdriveLiftAvailable) {
 					for (int newlane = 0; newlane < 5; newlane++) {
 						if (overdriveLanesHit[newlane]) {
-							int chordLane = curChart.findNoteIdx(curNote->time, newlane);
+							int chordLane = curChart.findNoteIdx(notes.time[curNote], newlane);
 							if (chordLane != -1) {
-								Note &chordNote = curChart.notes[chordLane];
-								if (chordNote.held && chordNote.len > 0) {
-									if (!((player.diff == 3 && settingsMain.keybinds5K[chordNote.lane])
-										|| (player.diff != 3 && settingsMain.keybinds4K[chordNote.lane]))) {
-										chordNote.held = false;
-										player.score += player.sustainScoreBuffer[chordNote.lane];
-										player.sustainScoreBuffer[chordNote.lane] = 0;
+								int chordNote = chordLane;
+								if (noteStates.is(chordNote, NoteHeld) && notes.len[chordNote] > 0) {
+									if (!((player.diff == 3 && settingsMain.keybinds5K[notes.lane[chordNote]])
+										|| (player.diff != 3 && settingsMain.keybinds4K[notes.lane[chordNote]]))) {
+										noteStates.unset(chordNote, NoteHeld);
+										player.score += player.sustainScoreBuffer[notes.lane[chordNote]];
+										player.sustainScoreBuffer[notes.lane[chordNote]] = 0;
 										player.mute = true;
 									}
 								}
@@ -285,65 +292,63 @@ static void handleInputs(int lane, int action) {
 				}
 			} else {
 				for (int i = gpr.curNoteIdx[lane]; i < curChart.notes_perlane[lane].size(); i++) {
-					Note &curNote = curChart.notes[curChart.notes_perlane[lane][i]];
+					int curNote = curChart.notes_perlane[lane][i];
 
 
-					if (lane != curNote.lane) continue;
+					if (lane != notes.lane[curNote]) continue;
 					if (!player.plastic) {
-						if ((curNote.lift && action == GLFW_RELEASE) || action == GLFW_PRESS) {
-							if (curNote.isGood(eventTime, player.InputOffset) &&
-								!curNote.hit) {
-								if (curNote.lift && action == GLFW_RELEASE) {
+						if ((notes.is(curNote, NoteLift) && action == GLFW_RELEASE) || action == GLFW_PRESS) {
+							if (notes.isGood(curNote, eventTime, player.InputOffset) &&
+								!noteStates.is(curNote, NoteHit)) {
+								if (notes.is(curNote, NoteLift) && action == GLFW_RELEASE) {
 									lastHitLifts[lane] = curChart.notes_perlane[
 										lane][i];
 								}
-								curNote.hit = true;
-								curNote.HitOffset = curNote.time - eventTime;
-								curNote.hitTime = eventTime;
-								if ((curNote.len) > 0 && !curNote.lift) {
-									curNote.held = true;
+								noteStates.set(curNote, NoteHit);
+								noteStates.hitOffset(curNote) = notes.time[curNote] - eventTime;
+								noteStates.hitTime(curNote) = eventTime;
+								if ((notes.len[curNote]) > 0 && !notes.is(curNote, NoteLift)) {
+									noteStates.set(curNote, NoteHeld);
 								}
-								if (curNote.isPerfect(eventTime, player.InputOffset)) {
-									curNote.perfect = true;
+								if (notes.isPerfect(curNote, eventTime, player.InputOffset)) {
+									noteStates.set(curNote, NotePerfect);
 								}
-								if (curNote.perfect) player.lastNotePerfect = true;
+								if (noteStates.is(curNote, NotePerfect)) player.lastNotePerfect = true;
 								else player.lastNotePerfect = false;
-								player.HitNote(curNote.perfect, player.instrument);
-								curNote.accounted = true;
+								player.HitNote(noteStates.is(curNote, NotePerfect), player.instrument);
+								noteStates.set(curNote, NoteAccounted);
 								break;
 							}
-							if (curNote.miss) player.lastNotePerfect = false;
+							if (noteStates.is(curNote, NoteMiss)) player.lastNotePerfect = false;
 						}
-						if ((!gpr.heldFrets[curNote.lane] && !gpr.heldFretsAlt[curNote.lane]) &&
-							curNote.held &&
-							(curNote.len) > 0) {
-							curNote.held = false;
-							player.score += player.sustainScoreBuffer[curNote.lane];
-							player.sustainScoreBuffer[curNote.lane] = 0;
+						if ((!gpr.heldFrets[notes.lane[curNote]] && !gpr.heldFretsAlt[notes.lane[curNote]]) &&
+							noteStates.is(curNote, NoteHeld) &&
+							(notes.len[curNote]) > 0) {
+							noteStates.unset(curNote, NoteHeld);
+							player.score += player.sustainScoreBuffer[notes.lane[curNote]];
+							player.sustainScoreBuffer[notes.lane[curNote]] = 0;
 							player.mute = true;
 							// SetAudioStreamVolume(audioManager.loadedStreams[instrument].stream, missVolume);
 						}
 
 						if (action == GLFW_PRESS &&
-							eventTime > songList.songs[curPlayingSong].music_start &&
-							!curNote.hit &&
-							!curNote.accounted &&
-							((curNote.time) - goodBackend) + player.InputOffset > eventTime &&
+							eventTime > playingSong.music_start &&
+							!noteStates.is(curNote, NoteHit) &&
+							!noteStates.is(curNote, NoteAccounted) &&
+							((notes.time[curNote]) - goodBackend) + player.InputOffset > eventTime &&
 							eventTime > overdriveHitTime + 0.05
 							&& !gpr.overhitFrets[lane]) {
 							if (lastHitLifts[lane] != -1) {
-								if (eventTime > curChart.notes[lastHitLifts[lane]].time
+								if (eventTime > notes.time[lastHitLifts[lane]]
 									- 0.1 &&
-									eventTime < curChart.notes[lastHitLifts[lane]].time +
+									eventTime < notes.time[lastHitLifts[lane]] +
 									0.1)
 									continue;
 							}
 							player.OverHit();
-							if (!curChart.odPhrases.empty() && eventTime >= curChart.
-								odPhrases[gpr.curODPhrase].start &&
-								eventTime < curChart.odPhrases[gpr.curODPhrase].end &&
-								!curChart.odPhrases[gpr.curODPhrase].missed)
-								curChart.odPhrases[gpr.curODPhrase].missed = true;
+							int odPhrase = curChart.phrases.find(PhraseOverdrive, eventTime);
+							if (odPhrase != -1 && !curChart.odPhrases[odPhrase].missed)
+								curChart.odPhrases[odPhrase].missed = true;
 							gpr.overhitFrets[lane] = true;
 						}
 					}
@@ -353,7 +358,7 @@ static void handleInputs(int lane, int action) {
 			if (gpr.curNoteInt >= curChart.notes.size())
 				gpr.curNoteInt = curChart.notes.size() - 1;
 			player.notes = gpr.curNoteInt;
-			Note &curNote = curChart.notes[gpr.curNoteInt];
+			int curNote = gpr.curNoteInt;
 			int pressedMask = 0b000000;
 
 			for (int pressedButtons = 0; pressedButtons < gpr.heldFrets.size(); pressedButtons++) {
@@ -362,44 +367,42 @@ static void handleInputs(int lane, int action) {
 			}
 
 			HeldMaskShow = pressedMask;
-			Note &lastNote = curChart.notes[gpr.curNoteInt == 0 ? 0 : gpr.curNoteInt - 1];
+			int lastNote = gpr.curNoteInt == 0 ? 0 : gpr.curNoteInt - 1;
 
-			// if (!lastNote.accounted && gpr.curNoteInt != 0) return;
+			// if (!noteStates.is(lastNote, NoteAccounted) && gpr.curNoteInt != 0) return;
 
 			bool firstNote = gpr.curNoteInt == 0;
 
 			if (lane == 8008135 && action == GLFW_PRESS && !gpr.FAS
-				// && (firstNote ? true : lastNote.time + 0.005 < eventTime)
+				// && (firstNote ? true : notes.time[lastNote] + 0.005 < eventTime)
 			) {
 				StrumNoFretTime = eventTime;
-				curNote.strumCount++;
-				if (curNote.isGood(eventTime, player.InputOffset) && !curNote.hit && !curNote.hitWithFAS
-					// && (firstNote ? true : lastNote.accounted)
+				noteStates.strumCount(curNote)++;
+				if (notes.isGood(curNote, eventTime, player.InputOffset) && !noteStates.is(curNote, NoteHit) && !noteStates.is(curNote, NoteHitWithFAS)
+					// && (firstNote ? true : noteStates.is(lastNote, NoteAccounted))
 				) {
 					// TraceLog(LOG_INFO, TextFormat("FAS Active at %f", eventTime));
 					gpr.FAS = true;
-					curNote.hitWithFAS = true;
+					noteStates.set(curNote, NoteHitWithFAS);
 					// if (gpr.curNoteInt < curChart.notes.size() - 1) {
 					//     curChart.notes[gpr.curNoteInt + 1].hitWithFAS = false;
 					//    curChart.notes[gpr.curNoteInt + 1].strumCount = 0;
 					// }
 					strummedNote = gpr.curNoteInt;
 				}
-				if ((!curNote.isGood(eventTime, player.InputOffset))
+				if ((!notes.isGood(curNote, eventTime, player.InputOffset))
 					&&
-					((lastNote.phopo && lastNote.hit && !firstNote) ? (eventTime > lastNote.hitTime + 0.1f) : (true))) {
+					((notes.is(lastNote, NoteHopo) && noteStates.is(lastNote, NoteHit) && !firstNote) ? (eventTime > noteStates.hitTime(lastNote) + 0.1f) : (true))) {
 					TraceLog(LOG_INFO, TextFormat("Overstrum at %f", eventTime));
 					gpr.overstrum = true;
 					gpr.FAS = false;
 					player.OverHit();
-					if (lastNote.held && !firstNote) {
-						lastNote.held = false;
+					if (noteStates.is(lastNote, NoteHeld) && !firstNote) {
+						noteStates.unset(lastNote, NoteHeld);
 					}
-					if (!curChart.odPhrases.empty() && !curChart.odPhrases[gpr.curODPhrase].missed
-						&&
-						curNote.time >= curChart.odPhrases[gpr.curODPhrase].start &&
-						curNote.time < curChart.odPhrases[gpr.curODPhrase].end)
-						curChart.odPhrases[gpr.curODPhrase].missed = true;
+					int odPhrase = curChart.phrases.find(PhraseOverdrive, notes.time[curNote]);
+					if (odPhrase != -1 && !curChart.odPhrases[odPhrase].missed)
+						curChart.odPhrases[odPhrase].missed = true;
 				}
 			} else if (lane == 8008135 && action == GLFW_RELEASE) {
 				gpr.downStrum = false;
@@ -412,25 +415,25 @@ static void handleInputs(int lane, int action) {
 			}
 
 
-			bool chordMatch = (gpr.extendedSustainActive ? pressedMask >= curNote.mask : pressedMask == curNote.mask);
-			bool singleMatch = (gpr.extendedSustainActive ? pressedMask >= curNote.mask : pressedMask >= curNote.mask && pressedMask < (curNote.mask * 2));
-			bool noteMatch = (curNote.chord ? chordMatch : singleMatch);
+			bool chordMatch = (gpr.extendedSustainActive ? pressedMask >= notes.mask[curNote] : pressedMask == notes.mask[curNote]);
+			bool singleMatch = (gpr.extendedSustainActive ? pressedMask >= notes.mask[curNote] : pressedMask >= notes.mask[curNote] && pressedMask < (notes.mask[curNote] * 2));
+			bool noteMatch = (notes.is(curNote, NoteChord) ? chordMatch : singleMatch);
 
-			if (curNote.hitWithFAS) {
-				if (noteMatch && !curNote.hit) {
+			if (noteStates.is(curNote, NoteHitWithFAS)) {
+				if (noteMatch && !noteStates.is(curNote, NoteHit)) {
 					TraceLog(LOG_INFO, TextFormat("Note hit at %f as a STRUM", eventTime));
 					gpr.FAS = false;
-					curNote.hit = true;
-					curNote.HitOffset = curNote.time - eventTime;
-					curNote.hitTime = eventTime;
-					if (curNote.isPerfect(eventTime, player.InputOffset)) {
-						curNote.perfect = true;
+					noteStates.set(curNote, NoteHit);
+					noteStates.hitOffset(curNote) = notes.time[curNote] - eventTime;
+					noteStates.hitTime(curNote) = eventTime;
+					if (notes.isPerfect(curNote, eventTime, player.InputOffset)) {
+						noteStates.set(curNote, NotePerfect);
 					}
-					player.HitPlasticNote(curNote, player.instrument);
-					curNote.accounted = true;
-					if ((curNote.len) > 0) {
-						curNote.held = true;
-						if (curNote.extendedSustain == true)
+					player.HitPlasticNote(noteStates.is(curNote, NotePerfect), notes.chordSize[curNote], player.instrument);
+					noteStates.set(curNote, NoteAccounted);
+					if ((notes.len[curNote]) > 0) {
+						noteStates.set(curNote, NoteHeld);
+						if (notes.is(curNote, NoteExtendedSustain))
 							gpr.extendedSustainActive = true;
 					}
 					gpr.curNoteInt++;
@@ -439,25 +442,24 @@ static void handleInputs(int lane, int action) {
 			}
 
 
-			if ((noteMatch && curNote.phopo && (player.combo > 0 || gpr.curNoteInt == 0)) || (
-					curNote.pTap && noteMatch)) {
-				if (curNote.isGood(eventTime, player.InputOffset) && !curNote.hit && !curNote.
-					accounted) {
+			if ((noteMatch && notes.is(curNote, NoteHopo) && (player.combo > 0 || gpr.curNoteInt == 0)) || (
+					notes.is(curNote, NoteTap) && noteMatch)) {
+				if (notes.isGood(curNote, eventTime, player.InputOffset) && !noteStates.is(curNote, NoteHit) && !noteStates.is(curNote, NoteAccounted)) {
 					TraceLog(LOG_INFO, TextFormat("Note hit at %f as a HOPO", eventTime));
-					curNote.hit = true;
-					curNote.HitOffset = curNote.time - eventTime;
-					curNote.hitTime = eventTime;
+					noteStates.set(curNote, NoteHit);
+					noteStates.hitOffset(curNote) = notes.time[curNote] - eventTime;
+					noteStates.hitTime(curNote) = eventTime;
 
-					if ((curNote.len) > 0) {
-						curNote.held = true;
-						if (curNote.extendedSustain == true)
+					if ((notes.len[curNote]) > 0) {
+						noteStates.set(curNote, NoteHeld);
+						if (notes.is(curNote, NoteExtendedSustain))
 							gpr.extendedSustainActive = true;
 					}
-					if (curNote.isPerfect(eventTime, player.InputOffset)) {
-						curNote.perfect = true;
+					if (notes.isPerfect(curNote, eventTime, player.InputOffset)) {
+						noteStates.set(curNote, NotePerfect);
 					}
-					player.HitNote(curNote.perfect, player.instrument);
-					curNote.accounted = true;
+					player.HitNote(noteStates.is(curNote, NotePerfect), player.instrument);
+					noteStates.set(curNote, NoteAccounted);
 					gpr.curNoteInt++;
 					return;
 				}
@@ -467,7 +469,7 @@ static void handleInputs(int lane, int action) {
 }
 
 // what to check when a key changes states (what was the change? was it pressed? or released? what time? what window? were any modifiers pressed?)
-static void keyCallback(GLFWwindow *wind, int key, int scancode, int action, int mods) {
+static void handleKey(int key, int action, double eventTime) {
 	if (!streamsLoaded) {
 		return;
 	}
@@ -481,12 +483,12 @@ static void keyCallback(GLFWwindow *wind, int key, int scancode, int action, int
 			else {
 				audioManager.unpauseStreams();
 				for (int i = 0; i < (player.diff == 3 ? 5 : 4); i++) {
-					handleInputs(i, -1);
+					handleInputs(i, -1, eventTime);
 				}
 			}
 		} else if ((key == settingsMain.keybindOverdrive || key == settingsMain.keybindOverdriveAlt) && !gpr.
 					bot) {
-			handleInputs(-1, action);
+			handleInputs(-1, action, eventTime);
 		} else if (!gpr.bot) {
 			if (player.instrument != 4) {
 				if (player.diff == 3 || player.plastic) {
@@ -552,18 +554,110 @@ static void keyCallback(GLFWwindow *wind, int key, int scancode, int action, int
 				}
 
 				if (lane != -1 && lane != -2) {
-					handleInputs(lane, action);
+					handleInputs(lane, action, eventTime);
 				}
 			}
 		}
 	}
 }
 
+static void keyCallback(GLFWwindow *wind, int key, int scancode, int action, int mods) {
+	// the input thread has the keyboard while it's running
+	if (InputThread::getInstance().IsRunning())
+		return;
+	handleKey(key, action, audioManager.songClock.Now());
+}
+
+// the bound keys by scancode, for matching the input thread's events
+std::unordered_map<int, int> scancodeKeys;
+
+static void startInputThread() {
+	std::vector<int> keys = {
+		settingsMain.keybindOverdrive, settingsMain.keybindOverdriveAlt, settingsMain.keybindPause,
+		settingsMain.keybindStrumUp, settingsMain.keybindStrumDown
+	};
+	for (const std::vector<int> *binds: {
+			&settingsMain.keybinds5K, &settingsMain.keybinds5KAlt, &settingsMain.keybinds4K,
+			&settingsMain.keybinds4KAlt
+		})
+		keys.insert(keys.end(), binds->begin(), binds->end());
+	scancodeKeys.clear();
+	for (int key: keys) {
+		if (key > 0 && glfwGetKeyScancode(key) > 0)
+			scancodeKeys[glfwGetKeyScancode(key)] = key;
+	}
+	InputThread::getInstance().Start();
+}
+
+static void handleGamepad(const GLFWgamepadstate &state, double eventTime);
+
+// judges the keys and pads the input thread has seen, at the song time each
+// one happened; call once a frame, before anything is judged as missed
+static void handleQueuedInputs() {
+	InputThread::Event event;
+	while (InputThread::getInstance().Pop(event)) {
+		double eventTime = audioManager.songClock.At(event.time);
+		if (event.type == InputThread::Event::Gamepad) {
+			GLFWgamepadstate state;
+			std::copy(std::begin(event.gamepad.buttons), std::end(event.gamepad.buttons), state.buttons);
+			std::copy(std::begin(event.gamepad.axes), std::end(event.gamepad.axes), state.axes);
+			handleGamepad(state, eventTime);
+			continue;
+		}
+		// keyboards are read whether the window has focus or not
+		if (!IsWindowFocused())
+			continue;
+		auto key = scancodeKeys.find(event.scancode);
+		if (key != scancodeKeys.end())
+			handleKey(key->second, event.action, eventTime);
+	}
+}
+
+// swaps in the songs once they've loaded in the background
+static bool takeLoadedSongs() {
+	if (!songList.TakeLoaded())
+		return false;
+	for (SongMetadata &songi: songList.songs) {
+		songi.titleScrollTime = GetTime();
+		songi.titleTextWidth = assets.MeasureTextRubik(songi.title.data(), 24);
+		songi.artistScrollTime = GetTime();
+		songi.artistTextWidth = assets.MeasureTextRubik(songi.artist.data(), 20);
+	}
+	SongWatcher::getInstance().Start(settingsMain.songPaths, songList.songs);
+	menu.songsLoaded = true;
+	return true;
+}
+
+// how far the songs loading in the background have got, over whatever
+// screen is up
+static void drawSongLoadingProgress() {
+	if (!songList.Loading())
+		return;
+	Units &u = Units::getInstance();
+	int found = ScanFoldersFound;
+	int done = std::min((int) ScanFoldersDone, found);
+	std::string progress = found > 0 ? TextFormat("Loading songs... %i/%i folders", done, found) : "Loading songs...";
+	float fontSize = u.hinpct(0.03f);
+	float barWidth = u.winpct(0.2f);
+	Vector2 textPos = {u.RightSide - barWidth, u.hpct(0.75f)};
+	DrawTextEx(assets.rubikBold, progress.c_str(), textPos, fontSize, 0, WHITE);
+	float barTop = textPos.y + fontSize * 1.1f;
+	DrawRectangle(textPos.x, barTop, barWidth, u.hinpct(0.008f), Color{0, 0, 0, 128});
+	if (found > 0)
+		DrawRectangle(textPos.x, barTop, barWidth * done / found, u.hinpct(0.008f), player.accentColor);
+}
+
 static void gamepadStateCallback(int jid, GLFWgamepadstate state) {
+	// the input thread has the pads it could open while it's running
+	if (InputThread::getInstance().OwnsGamepad(glfwGetJoystickGUID(jid)))
+		return;
+	handleGamepad(state, audioManager.songClock.Now());
+}
+
+static void handleGamepad(const GLFWgamepadstate &state, double eventTime) {
 	if (!streamsLoaded) {
 		return;
 	}
-	double eventTime = audioManager.GetMusicTimePlayed(audioManager.loadedStreams[0].handle);
 	if (settingsMain.controllerPause >= 0) {
 		if (state.buttons[settingsMain.controllerPause] != buttonValues[settingsMain.controllerPause]) {
 			buttonValues[settingsMain.controllerPause] = state.buttons[settingsMain.controllerPause];
@@ -574,7 +668,7 @@ static void gamepadStateCallback(int jid, GLFWgamepadstate state) {
 				else {
 					audioManager.unpauseStreams();
 					for (int i = 0; i < (player.diff == 3 ? 5 : 4); i++) {
-						handleInputs(i, -1);
+						handleInputs(i, -1, eventTime);
 					}
 				}
 			}
@@ -593,7 +687,7 @@ static void gamepadStateCallback(int jid, GLFWgamepadstate state) {
 		if (state.buttons[settingsMain.controllerOverdrive] != buttonValues[settingsMain.controllerOverdrive]) {
 			buttonValues[settingsMain.controllerOverdrive] = state.buttons[settingsMain.
 				controllerOverdrive];
-			handleInputs(-1, state.buttons[settingsMain.controllerOverdrive]);
+			handleInputs(-1, state.buttons[settingsMain.controllerOverdrive], eventTime);
 		}
 	} else if (!gpr.bot) {
 		if (state.axes[-(settingsMain.controllerOverdrive + 1)] != axesValues[-(
@@ -602,9 +696,9 @@ static void gamepadStateCallback(int jid, GLFWgamepadstate state) {
 				settingsMain.controllerOverdrive + 1)];
 			if (state.axes[-(settingsMain.controllerOverdrive + 1)] == 1.0f * (float) settingsMain.
 				controllerOverdriveAxisDirection) {
-				handleInputs(-1, GLFW_PRESS);
+				handleInputs(-1, GLFW_PRESS, eventTime);
 			} else {
-				handleInputs(-1, GLFW_RELEASE);
+				handleInputs(-1, GLFW_RELEASE, eventTime);
 			}
 		}
 	}
@@ -621,7 +715,7 @@ static void gamepadStateCallback(int jid, GLFWgamepadstate state) {
 						gpr.heldFrets[i] = false;
 						gpr.overhitFrets[i] = false;
 					}
-					handleInputs(i, state.buttons[settingsMain.controller5K[i]]);
+					handleInputs(i, state.buttons[settingsMain.controller5K[i]], eventTime);
 					buttonValues[settingsMain.controller5K[i]] = state.buttons[settingsMain.
 						controller5K[i]];
 					lane = i;
@@ -632,11 +726,11 @@ static void gamepadStateCallback(int jid, GLFWgamepadstate state) {
 					if (state.axes[-(settingsMain.controller5K[i] + 1)] == 1.0f * (float)
 						settingsMain.controller5KAxisDirection[i]) {
 						gpr.heldFrets[i] = true;
-						handleInputs(i, GLFW_PRESS);
+						handleInputs(i, GLFW_PRESS, eventTime);
 					} else {
 						gpr.heldFrets[i] = false;
 						gpr.overhitFrets[i] = false;
-						handleInputs(i, GLFW_RELEASE);
+						handleInputs(i, GLFW_RELEASE, eventTime);
 					}
 					axesValues[-(settingsMain.controller5K[i] + 1)] = state.axes[-(
 						settingsMain.controller5K[i] + 1)];
@@ -647,18 +741,18 @@ static void gamepadStateCallback(int jid, GLFWgamepadstate state) {
 		if (state.buttons[GLFW_GAMEPAD_BUTTON_DPAD_UP] == GLFW_PRESS && player.plastic) {
 			gpr.upStrum = true;
 			gpr.overstrum = false;
-			handleInputs(8008135, GLFW_PRESS);
+			handleInputs(8008135, GLFW_PRESS, eventTime);
 		} else if (state.buttons[GLFW_GAMEPAD_BUTTON_DPAD_UP] == GLFW_RELEASE && player.plastic) {
 			gpr.upStrum = false;
-			handleInputs(8008135, GLFW_RELEASE);
+			handleInputs(8008135, GLFW_RELEASE, eventTime);
 		}
 		if (state.buttons[GLFW_GAMEPAD_BUTTON_DPAD_DOWN] == GLFW_PRESS && player.plastic) {
 			gpr.downStrum = true;
 			gpr.overstrum = false;
-			handleInputs(8008135, GLFW_PRESS);
+			handleInputs(8008135, GLFW_PRESS, eventTime);
 		} else if (state.buttons[GLFW_GAMEPAD_BUTTON_DPAD_DOWN] == GLFW_RELEASE && player.plastic) {
 			gpr.downStrum = false;
-			handleInputs(8008135, GLFW_RELEASE);
+			handleInputs(8008135, GLFW_RELEASE, eventTime);
 		}
 	} else if (!gpr.bot) {
 		for (int i = 0; i < 4; i++) {
@@ -671,7 +765,7 @@ static void gamepadStateCallback(int jid, GLFWgamepadstate state) {
 						gpr.heldFrets[i] = false;
 						gpr.overhitFrets[i] = false;
 					}
-					handleInputs(i, state.buttons[settingsMain.controller4K[i]]);
+					handleInputs(i, state.buttons[settingsMain.controller4K[i]], eventTime);
 					buttonValues[settingsMain.controller4K[i]] = state.buttons[settingsMain.
 						controller4K[i]];
 				}
@@ -681,11 +775,11 @@ static void gamepadStateCallback(int jid, GLFWgamepadstate state) {
 					if (state.axes[-(settingsMain.controller4K[i] + 1)] == 1.0f * (float)
 						settingsMain.controller4KAxisDirection[i]) {
 						gpr.heldFrets[i] = true;
-						handleInputs(i, GLFW_PRESS);
+						handleInputs(i, GLFW_PRESS, eventTime);
 					} else {
 						gpr.heldFrets[i] = false;
 						gpr.overhitFrets[i] = false;
-						handleInputs(i, GLFW_RELEASE);
+						handleInputs(i, GLFW_RELEASE, eventTime);
 					}
 					axesValues[-(settingsMain.controller4K[i] + 1)] = state.axes[-(
 						settingsMain.controller4K[i] + 1)];
@@ -762,7 +856,6 @@ enum JoybindCategories {
 
 Keybinds keybinds;
 
-Song song;
 
 bool firstInit = true;
 int loadedAssets;
@@ -770,62 +863,73 @@ bool albumArtLoaded = false;
 
 settingsOptionRenderer sor;
 
-Song selectedSong;
+SongSession selectedSong;
 
 bool ReloadGameplayTexture = true;
 bool songAlbumArtLoadedGameplay = false;
 
 void LoadCharts() {
+	SongSession& loadingSong = playingSong;
+	std::ifstream midiIn(std::filesystem::path(loadingSong.midiPath), std::ios::binary);
+	std::vector<smf::uchar> midiBytes((std::istreambuf_iterator<char>(midiIn)), std::istreambuf_iterator<char>());
+	midiIn.close();
+	std::string midiHash = picosha2::hash256_hex_string(midiBytes.begin(), midiBytes.end());
+	loadingSong.beatLines.clear();
+	if (ChartCache::Load(loadingSong, player.instrument, midiHash)) {
+		std::cout << "ENC: Loaded compiled charts for " << player.instrument << endl;
+		LoadingState = READY;
+		this_thread::sleep_for(chrono::seconds(1));
+		FinishedLoading = true;
+		return;
+	}
+
 	smf::MidiFile midiFile;
-	midiFile.read(songList.songs[curPlayingSong].midiPath.string());
+	// only the track directory is read up front; the tracks this song
+	// actually needs get decoded below
+	midiFile.setFilename(std::string(loadingSong.midiPath));
+	midiFile.readPacked(std::move(midiBytes), false);
+	midiFile.decodeTrack(0);
+	loadingSong.bpms.clear();
+	loadingSong.timesigs.clear();
+	loadingSong.getTiming(midiFile, midiFile.getTrackView(0));
 	for (int track = 0; track < midiFile.getTrackCount(); track++) {
-		std::string trackName;
-		for (int events = 0; events < midiFile[track].getSize(); events++) {
-			if (midiFile[track][events].isMeta()) {
-				if ((int) midiFile[track][events][1] == 3) {
-					for (int k = 3; k < midiFile[track][events].getSize(); k++) {
-						trackName += midiFile[track][events][k];
-					}
-					SongParts songPart = song.partFromString(trackName);
-					if (trackName == "BEAT") {
-						LoadingState = BEATLINES;
-						songList.songs[curPlayingSong].parseBeatLines(midiFile, track, midiFile[track]);
-					}
-					else {
-						if (songPart != SongParts::Invalid && songPart == player.instrument) {
-							for (int diff = 0; diff < songList.songs[curPlayingSong].parts[player.instrument]->charts.size(); diff++) {
-								Chart &chart = songList.songs[curPlayingSong].parts[player.instrument]->charts[diff];
-								if (chart.valid){
-
-									std::cout << trackName << " " << diff << endl;
-									LoadingState = NOTE_PARSING;
-									if (songPart == SongParts::PlasticBass
-										|| songPart == SongParts::PlasticGuitar) {
-										chart.plastic = true;
-										chart.parsePlasticNotes(midiFile, track, midiFile[track],
-																player.diff, (int) songPart);
-										} else {
-											chart.plastic = false;
-											chart.parseNotes(midiFile, track, midiFile[track],
-															player.diff, (int) songPart);
-										}
-
-									if (!chart.plastic) {
-										LoadingState = EXTRA_PROCESSING;
-										int noteIdx = 0;
-										for (Note &note: chart.notes) {
-											chart.notes_perlane[note.lane].push_back(noteIdx);
-											noteIdx++;
-										}
-									}
-								}
-							}
-						}
-					}
+		std::string trackName = midiFile.getTrackName(track);
+		SongParts songPart = SongMetadata::partFromString(trackName);
+		if (trackName == "EVENTS") {
+			midiFile.decodeTrack(track);
+			loadingSong.getStartEnd(midiFile, midiFile.getTrackView(track));
+		}
+		else if (trackName == "BEAT") {
+			LoadingState = BEATLINES;
+			midiFile.decodeTrack(track);
+			playingSong.parseBeatLines(midiFile, midiFile.getTrackView(track));
+		}
+		else if (songPart != SongParts::Invalid && songPart == player.instrument) {
+			// every valid difficulty comes out of the same walk over the track
+			std::vector<Chart*> validCharts;
+			for (Chart &chart: playingSong.parts[player.instrument].charts) {
+				if (chart.valid) {
+					std::cout << trackName << " " << chart.diff << endl;
+					validCharts.push_back(&chart);
+				}
+			}
+			LoadingState = NOTE_PARSING;
+			midiFile.decodeTrack(track);
+			bool plastic = songPart == SongParts::PlasticBass
+							|| songPart == SongParts::PlasticGuitar;
+			Chart::parseDifficulties(midiFile, midiFile.getTrackView(track), validCharts,
+									(int) songPart, plastic);
+
+			if (!plastic) {
+				LoadingState = EXTRA_PROCESSING;
+				for (Chart *chart: validCharts) {
+					for (int noteIdx = 0; noteIdx < chart->notes.size(); noteIdx++)
+						chart->notes_perlane[chart->notes.lane[noteIdx]].push_back(noteIdx);
 				}
 			}
 		}
 	}
+	ChartCache::Write(loadingSong, player.instrument, midiHash);
 	LoadingState = READY;
 	this_thread::sleep_for(chrono::seconds(1));
 	FinishedLoading = true;
@@ -936,7 +1040,8 @@ int main(int argc, char *argv[]) {
 	std::vector<std::string> diffList{"Easy", "Medium", "Hard", "Expert"};
 	TraceLog(LOG_INFO, "Target FPS: %d", targetFPS);
 
-	audioManager.Init();
+	audioManager.Init(settingsMain.lowLatencyAudio, settingsMain.audioBufferMS);
+	StemCache::getInstance().Configure("cache/stems", (uint64_t)settingsMain.stemCacheMB << 20);
 	SetExitKey(0);
 	audioManager.loadSample("Assets/combobreak.mp3", "miss");
 
@@ -1061,10 +1166,9 @@ int main(int argc, char *argv[]) {
 		switch (menu.currentScreen) {
 			case MENU: {
 				if (!menu.songsLoaded) {
-					if (std::filesystem::exists("songCache.encr")) {
-						songList = songList.LoadCache(settingsMain.songPaths);
-						menu.songsLoaded = true;
-					}
+					if (std::filesystem::exists("songCache.encr"))
+						songList.StartLoading(settingsMain.songPaths, false);
+					takeLoadedSongs();
 				}
 
 				menu.loadMenu(gamepadStateCallbackSetControls);
@@ -1242,6 +1346,10 @@ int main(int argc, char *argv[]) {
 					settingsMain.missHighwayColor = settingsMain.prevMissHighwayColor;
 					settingsMain.mirrorMode = settingsMain.prevMirrorMode;
 					settingsMain.fullscreen = settingsMain.fullscreenPrev;
+					settingsMain.lowLatencyAudio = settingsMain.prevLowLatencyAudio;
+					settingsMain.audioBufferMS = settingsMain.prevAudioBufferMS;
+					settingsMain.stemCache = settingsMain.prevStemCache;
+					settingsMain.stemCacheMB = settingsMain.prevStemCacheMB;
 
 					settingsMain.MainVolume = settingsMain.prevMainVolume;
 					settingsMain.PlayerVolume = settingsMain.prevPlayerVolume;
@@ -1304,6 +1412,12 @@ int main(int argc, char *argv[]) {
 					settingsMain.prevMissHighwayColor = settingsMain.missHighwayColor;
 					settingsMain.prevMirrorMode = settingsMain.mirrorMode;
 					settingsMain.fullscreenPrev = settingsMain.fullscreen;
+					settingsMain.prevLowLatencyAudio = settingsMain.lowLatencyAudio;
+					settingsMain.prevAudioBufferMS = settingsMain.audioBufferMS;
+					settingsMain.prevStemCache = settingsMain.stemCache;
+					if (settingsMain.stemCacheMB != settingsMain.prevStemCacheMB)
+						StemCache::getInstance().Configure("cache/stems", (uint64_t)settingsMain.stemCacheMB << 20);
+					settingsMain.prevStemCacheMB = settingsMain.stemCacheMB;
 
 					settingsMain.prevMainVolume = settingsMain.MainVolume;
 					settingsMain.prevPlayerVolume = settingsMain.PlayerVolume;
@@ -1448,7 +1562,7 @@ int main(int argc, char *argv[]) {
 										OptionLeft, scanTop, OptionWidth, EntryHeight
 									}, "Scan")) {
 							menu.songsLoaded = false;
-							songList.ScanSongs(settingsMain.songPaths);
+							songList.StartLoading(settingsMain.songPaths, true);
 						}
 
 
@@ -1532,6 +1646,42 @@ int main(int argc, char *argv[]) {
 							settingsMain.MenuVolume, 0, 1, 6,
 							"Menu Music Volume", 0.05f);
 
+						// output, applied on the next start
+						DrawRectangle(u.wpct(0.005f), underTabsHeight + (EntryHeight * 7),
+									OptionWidth * 2, EntryHeight,
+									Color{0, 0, 0, 128});
+						DrawTextEx(assets.rubikBoldItalic, "Output (Applies On Restart)", {
+										HeaderTextLeft, OvershellBottom + u.hinpct(0.055f) + (EntryHeight * 7)
+									},
+									u.hinpct(0.04f), 0, WHITE);
+
+						settingsMain.lowLatencyAudio = sor.toggleEntry(
+							settingsMain.lowLatencyAudio, 8, "Low Latency Audio");
+
+						DrawRectangle(u.wpct(0.005f), underTabsHeight + (EntryHeight * 9),
+									OptionWidth * 2, EntryHeight, Color{0, 0, 0, 64});
+						settingsMain.audioBufferMS = sor.sliderEntry(
+							settingsMain.audioBufferMS, 10, 100, 9,
+							"Audio Buffer (ms)", 5);
+
+						// stem cache, used from the next song on
+						DrawRectangle(u.wpct(0.005f), underTabsHeight + (EntryHeight * 10),
+									OptionWidth * 2, EntryHeight,
+									Color{0, 0, 0, 128});
+						DrawTextEx(assets.rubikBoldItalic, "Stem Cache", {
+										HeaderTextLeft, OvershellBottom + u.hinpct(0.055f) + (EntryHeight * 10)
+									},
+									u.hinpct(0.04f), 0, WHITE);
+
+						settingsMain.stemCache = sor.toggleEntry(
+							settingsMain.stemCache, 11, "Cache Decoded Stems");
+
+						DrawRectangle(u.wpct(0.005f), underTabsHeight + (EntryHeight * 12),
+									OptionWidth * 2, EntryHeight, Color{0, 0, 0, 64});
+						settingsMain.stemCacheMB = sor.sliderEntry(
+							settingsMain.stemCacheMB, 256, 8192, 12,
+							"Stem Cache Size (MB)", 256);
+
 						player.selInstVolume = settingsMain.MainVolume * settingsMain.PlayerVolume;
 						player.otherInstVolume = settingsMain.MainVolume * settingsMain.BandVolume;
 						player.sfxVolume = settingsMain.MainVolume * settingsMain.SFXVolume;
@@ -1985,8 +2135,66 @@ int main(int argc, char *argv[]) {
 			}
 			case SONG_SELECT: {
 				if (!menu.songsLoaded) {
-					songList = songList.LoadCache(settingsMain.songPaths);
-					menu.songsLoaded = true;
+					songList.StartLoading(settingsMain.songPaths, false);
+					// there's nothing to pick from until they're in
+					if (!takeLoadedSongs()) {
+						menu.DrawTopOvershell(0.15f);
+						menu.DrawBottomOvershell();
+						break;
+					}
+				}
+				SongListUpdate songUpdate;
+				if (SongWatcher::getInstance().TakeUpdate(songUpdate)) {
+					for (SongMetadata &songi: songUpdate.changedSongs) {
+						songi.titleScrollTime = GetTime();
+						songi.titleTextWidth = MeasureTextRubik(songi.title.data(), 24);
+						songi.artistScrollTime = GetTime();
+						songi.artistTextWidth = MeasureTextRubik(songi.artist.data(), 20);
+					}
+					std::string chosenDir;
+					if (menu.ChosenSongInt >= 0 && menu.ChosenSongInt < songList.songs.size())
+						chosenDir = songList.songs[menu.ChosenSongInt].songDir;
+					std::vector<int> moved = songList.ApplyUpdate(songUpdate, currentSortValue);
+					int lastSong = std::max(0, (int) songList.songs.size() - 1);
+					for (int *held: {&curPlayingSong, &menu.ChosenSongInt}) {
+						if (*held >= 0 && *held < moved.size() && moved[*held] >= 0)
+							*held = moved[*held];
+						else
+							*held = std::clamp(*held, 0, lastSong);
+					}
+					// the chosen song's details are a copy, so they're made
+					// again if it changed, or it's something else now that
+					// it's gone
+					bool chosenRemoved = !chosenDir.empty()
+										&& (songList.songs.empty()
+											|| songList.songs[menu.ChosenSongInt].songDir != chosenDir);
+					bool chosenChanged = std::any_of(
+						songUpdate.changedSongs.begin(), songUpdate.changedSongs.end(),
+						[&chosenDir](const SongMetadata &song) { return song.songDir == chosenDir; });
+					if (chosenRemoved)
+						selSong = false;
+					if (!songList.songs.empty() && (chosenRemoved || chosenChanged)) {
+						menu.ChosenSong = SongSession(songList.songs[menu.ChosenSongInt]);
+						albumArtLoaded = false;
+					}
+				}
+				// typing searches the list; backspace takes a character off
+				bool searchChanged = false;
+				for (int codepoint = GetCharPressed(); codepoint > 0; codepoint = GetCharPressed()) {
+					int codepointSize = 0;
+					const char *encoded = CodepointToUTF8(codepoint, &codepointSize);
+					songSearchQuery.append(encoded, codepointSize);
+					searchChanged = true;
+				}
+				if (IsKeyPressed(KEY_BACKSPACE) && !songSearchQuery.empty()) {
+					while (songSearchQuery.size() > 1 && (songSearchQuery.back() & 0xC0) == 0x80)
+						songSearchQuery.pop_back();
+					songSearchQuery.pop_back();
+					searchChanged = true;
+				}
+				if (searchChanged) {
+					int bestMatch = songList.Search(songSearchQuery);
+					songSelectOffset = bestMatch >= 0 ? songList.EntryIndex(bestMatch) - 5 : 1;
 				}
 				streamsLoaded = false;
 				midiLoaded = false;
@@ -1994,9 +2202,7 @@ int main(int argc, char *argv[]) {
 				gpr.songEnded = false;
 				player.overdrive = false;
 				gpr.curNoteIdx = {0, 0, 0, 0, 0};
-				gpr.curODPhrase = 0;
 				gpr.curNoteInt = 0;
-				gpr.curSolo = 0;
 				gpr.curBeatLine = 0;
 				gpr.curBPM = 0;
 
@@ -2012,7 +2218,7 @@ int main(int argc, char *argv[]) {
 				Vector2 mouseWheel = GetMouseWheelMoveV();
 				int lastIntChosen = (int) mouseWheel.y;
 				// set to specified height
-				if (songSelectOffset <= songList.listMenuEntries.size() && songSelectOffset >= 1 && songList.listMenuEntries
+				if (songSelectOffset <= songList.visibleEntries.size() && songSelectOffset >= 1 && songList.visibleEntries
 					.size() >= 10) {
 					songSelectOffset -= (int) mouseWheel.y;
 				}
@@ -2022,31 +2228,21 @@ int main(int argc, char *argv[]) {
 					songSelectOffset = 1;
 
 				// prevent going past bottom
-				if (songSelectOffset >= songList.listMenuEntries.size() - 10)
-					songSelectOffset = songList.listMenuEntries.size() - 10;
+				if (songSelectOffset >= (int) songList.visibleEntries.size() - 10)
+					songSelectOffset = std::max(1, (int) songList.visibleEntries.size() - 10);
 
 				if (!albumArtLoaded) {
 					selectedSong = menu.ChosenSong;
 					gpr.selectedSongInt = menu.ChosenSongInt;
 					selectedSong.LoadAlbumArt(selectedSong.albumArtPath);
+					menu.ChosenSong = selectedSong;
 					if (!selSong)
-						songSelectOffset = menu.ChosenSongInt - 5;
+						songSelectOffset = songList.EntryIndex(menu.ChosenSongInt) - 5;
 					albumArtLoaded = true;
-				} else {
-					menu.ChosenSong = selectedSong;
 				}
-				Song SongToDisplayInfo;
+				const SongSession &SongToDisplayInfo = selSong ? selectedSong : menu.ChosenSong;
 				BeginShaderMode(assets.bgShader);
-				if (selSong) {
-					SongToDisplayInfo = selectedSong;
-					selectedSong.LoadInfo(selectedSong.songInfoPath);
-					menu.DrawAlbumArtBackground(selectedSong.albumArtBlur);
-				} else {
-					Song art = menu.ChosenSong;
-					SongToDisplayInfo = menu.ChosenSong;
-					art.LoadInfo(art.songInfoPath);
-					menu.DrawAlbumArtBackground(art.albumArtBlur);
-				}
+				menu.DrawAlbumArtBackground(SongToDisplayInfo.albumArtBlur);
 				EndShaderMode();
 
 				float TopOvershell = u.hpct(0.15f);
@@ -2076,6 +2272,13 @@ int main(int argc, char *argv[]) {
 								u.LeftSide,
 								u.hinpct(0.165f)
 							}, u.hinpct(0.03f), 0, WHITE);
+				if (!songSearchQuery.empty()) {
+					DrawTextEx(assets.josefinSansItalic,
+								TextFormat("Search: %s", songSearchQuery.c_str()), {
+									u.LeftSide + u.winpct(0.2f),
+									u.hinpct(0.165f)
+								}, u.hinpct(0.03f), 0, WHITE);
+				}
 				DrawTextEx(assets.josefinSansItalic,
 							TextFormat("Songs loaded: %01i", songList.songs.size()), {
 								AlbumX - (AlbumOuter * 2) - MeasureTextEx(
@@ -2093,26 +2296,25 @@ int main(int argc, char *argv[]) {
 					DrawRectangle(0, ((songEntryHeight * 2) * j) + u.hinpct(0.208333f) + songEntryHeight, (u.RightSide - u.winpct(0.25f)), songEntryHeight,Color{0,0,0,64});
 				}
 
-				for (int i = songSelectOffset; i < songList.listMenuEntries.size() && i < songSelectOffset + 10; i++) {
-					if (songList.listMenuEntries.size() == i)
-						break;
-					if (songList.listMenuEntries[i].isHeader) {
+				for (int i = songSelectOffset; i < songList.visibleEntries.size() && i < songSelectOffset + 10; i++) {
+					SongList::ListMenuEntry &entry = songList.listMenuEntries[songList.visibleEntries[i]];
+					if (entry.isHeader) {
 						float songXPos = u.LeftSide + u.winpct(0.005f) - 2;
 						float songYPos = std::floor(
 							(u.hpct(0.266666f)) + (
 								(songEntryHeight) * ((i - songSelectOffset))));
 						DrawRectangle(0, songYPos, (u.RightSide - u.winpct(0.25f)), songEntryHeight, ColorBrightness(player.accentColor, -0.75f));
 
-						DrawTextEx(assets.rubikBold, songList.listMenuEntries[i].headerChar.c_str(),
+						DrawTextEx(assets.rubikBold, entry.headerChar.c_str(),
 										{
 											songXPos,
 											songYPos + u.hinpct(0.0125f)
 										}, u.hinpct(0.035f), 0, WHITE);
 					}
-					else if (!songList.listMenuEntries[i].hiddenEntry) {
-						Font &artistFont = songList.listMenuEntries[i].songListID == menu.ChosenSongInt ? assets.josefinSansItalic : assets.josefinSansItalic;
-						Song &songi = songList.songs[songList.listMenuEntries[i].songListID];
-						int songID = songList.listMenuEntries[i].songListID;
+					else if (!entry.hiddenEntry) {
+						Font &artistFont = entry.songListID == menu.ChosenSongInt ? assets.josefinSansItalic : assets.josefinSansItalic;
+						SongMetadata &songi = songList.songs[entry.songListID];
+						int songID = entry.songListID;
 						// float buttonX = ((float)GetScreenWidth()/2)-(((float)GetScreenWidth()*0.86f)/2);
 						//LerpState state = lerpCtrl.createLerp("SONGSELECT_LERP_" + std::to_string(i), EaseOutCirc, 0.4f);
 						float songXPos = u.LeftSide + u.winpct(0.005f) - 2;
@@ -2133,7 +2335,7 @@ int main(int argc, char *argv[]) {
 							selSong = true;
 							albumArtSelectedAndLoaded = false;
 							albumArtLoaded = false;
-							menu.ChosenSong = songList.songs[songID];
+							menu.ChosenSong = SongSession(songList.songs[songID]);
 							menu.ChosenSongInt = songID;
 									}
 						GuiSetStyle(BUTTON, BASE_COLOR_NORMAL, 0x181827FF);
@@ -2159,7 +2361,7 @@ int main(int argc, char *argv[]) {
 						}
 						auto LightText = Color{203, 203, 203, 255};
 						BeginScissorMode((int) songXPos + (songID == menu.ChosenSongInt ? 5 : 20), (int) songYPos, songTitleWidth, songEntryHeight);
-						DrawTextEx(assets.rubikBold, songi.title.c_str(),
+						DrawTextEx(assets.rubikBold, songi.title.data(),
 									{
 										songXPos + songi.titleXOffset + (songID == menu.ChosenSongInt ? 10 : 20),
 										songYPos + u.hinpct(0.0125f)
@@ -2181,7 +2383,7 @@ int main(int argc, char *argv[]) {
 						auto SelectedText = WHITE;
 						BeginScissorMode((int) songXPos + 30 + (int) songTitleWidth, (int) songYPos,
 										songArtistWidth, songEntryHeight);
-						DrawTextEx(artistFont, songi.artist.c_str(),
+						DrawTextEx(artistFont, songi.artist.data(),
 									{
 										songXPos + 30 + (float) songTitleWidth + songi.artistXOffset,
 										songYPos + u.hinpct(0.02f)
@@ -2199,34 +2401,8 @@ int main(int argc, char *argv[]) {
 				DrawRectangle(AlbumX - AlbumInner, AlbumY, AlbumHeight, AlbumHeight, BLACK);
 
 				// TODO: replace this with actual sorting/category hiding
-				if (songSelectOffset > 0 ) {
-					std::string SongTitleForCharThingyThatsTemporary = songList.listMenuEntries[songSelectOffset].headerChar;
-					switch (currentSortValue) {
-						case 0: {
-							if (songList.listMenuEntries[songSelectOffset].isHeader) {
-								SongTitleForCharThingyThatsTemporary = songList.songs[songList.listMenuEntries[songSelectOffset-1].songListID].title[0];
-							} else {
-								SongTitleForCharThingyThatsTemporary = songList.songs[songList.listMenuEntries[songSelectOffset].songListID].title[0];
-							}
-							break;
-						}
-						case 1: {
-							if (songList.listMenuEntries[songSelectOffset].isHeader) {
-								SongTitleForCharThingyThatsTemporary = songList.songs[songList.listMenuEntries[songSelectOffset-1].songListID].artist[0];
-							} else {
-								SongTitleForCharThingyThatsTemporary = songList.songs[songList.listMenuEntries[songSelectOffset].songListID].artist[0];
-							}
-							break;
-						}
-						case 2: {
-							if (songList.listMenuEntries[songSelectOffset].isHeader) {
-								SongTitleForCharThingyThatsTemporary = std::to_string(songList.songs[songList.listMenuEntries[songSelectOffset-1].songListID].length);
-							} else {
-								SongTitleForCharThingyThatsTemporary = std::to_string(songList.songs[songList.listMenuEntries[songSelectOffset].songListID].length);
-							}
-							break;
-						}
-					}
+				if (songSelectOffset > 0 && songSelectOffset < songList.visibleEntries.size()) {
+					std::string SongTitleForCharThingyThatsTemporary = songList.HeaderAt(songSelectOffset);
 
 					DrawTextEx(assets.rubikBold, SongTitleForCharThingyThatsTemporary.c_str(),
 									{
@@ -2248,7 +2424,7 @@ int main(int argc, char *argv[]) {
 									}, {0, 0}, 0,
 									WHITE);
 				} else {
-					Song art = menu.ChosenSong;
+					const SongSession &art = menu.ChosenSong;
 					DrawTexturePro(art.albumArt, Rectangle{
 										0, 0, (float) art.albumArt.width,
 										(float) art.albumArt.width
@@ -2268,7 +2444,7 @@ int main(int argc, char *argv[]) {
 
 				std::string AlbumArtText = SongToDisplayInfo.album.empty()
 												? "No Album Listed"
-												: SongToDisplayInfo.album;
+												: std::string(SongToDisplayInfo.album);
 
 				float AlbumTextHeight = MeasureTextEx(assets.rubikBold, AlbumArtText.c_str(),
 													u.hinpct(0.035f), 0).y;
@@ -2303,14 +2479,14 @@ int main(int argc, char *argv[]) {
 										assets.rubikBold, "OOOOO  ", DiffHeight, 0).x;
 
 				for (int i = 0; i < 7; i++) {
-					if (SongToDisplayInfo.parts[i]->diff != -1) {
+					if (SongToDisplayInfo.partDiffs[i] != -1) {
 						std::string DiffDot;
 						bool red = false;
-						if (SongToDisplayInfo.parts[i]->diff == 6) red = true;
+						if (SongToDisplayInfo.partDiffs[i] == 6) red = true;
 						for (int g = 0; g < 7; g++) {
-							if (g < SongToDisplayInfo.parts[i]->diff - 1)
+							if (g < SongToDisplayInfo.partDiffs[i] - 1)
 								DiffDot += "O";
-							if (g > SongToDisplayInfo.parts[i]->diff - 1) {
+							if (g > SongToDisplayInfo.partDiffs[i] - 1) {
 								DiffDot += " ";
 							}
 						}
@@ -2341,8 +2517,8 @@ int main(int argc, char *argv[]) {
 								u.hinpct(0.05f)
 							}, "Play Song")) {
 					curPlayingSong = menu.ChosenSongInt;
-					songList.songs[curPlayingSong].LoadSong(
-						songList.songs[curPlayingSong].songInfoPath);
+					playingSong = SongSession(songList.songs[curPlayingSong]);
+					playingSong.LoadAudio(playingSong.songInfoPath);
 					menu.SwitchScreen(READY_UP);
 					albumArtLoaded = false;
 				}
@@ -2354,21 +2530,20 @@ int main(int argc, char *argv[]) {
 								u.hinpct(0.05f)
 							}, "Sort")) {
 					currentSortValue++;
-					if (currentSortValue == 3) currentSortValue = 0;
-					if (selSong)
-						songList.sortList(currentSortValue, curPlayingSong);
-					else
-						songList.sortList(currentSortValue, menu.ChosenSongInt);
+					if (currentSortValue == SongList::SortTypeCount) currentSortValue = 0;
+					songList.sortList(currentSortValue);
 				}
 				if (GuiButton(Rectangle{
 								u.LeftSide + u.winpct(0.2f) - 1,
 								GetScreenHeight() - u.hpct(0.1475f), u.winpct(0.2f),
 								u.hinpct(0.05f)
 							}, "Back")) {
-					for (Song &songi: songList.songs) {
+					for (SongMetadata &songi: songList.songs) {
 						songi.titleXOffset = 0;
 						songi.artistXOffset = 0;
 					}
+					songSearchQuery.clear();
+					songList.Search(songSearchQuery);
 					albumArtLoaded = false;
 					menu.albumArtLoaded = false;
 					menu.songsLoaded = true;
@@ -2381,7 +2556,7 @@ int main(int argc, char *argv[]) {
 			}
 			case READY_UP: {
 				if (!albumArtLoaded) {
-					selectedSong = songList.songs[curPlayingSong];
+					selectedSong = playingSong;
 					selectedSong.LoadAlbumArt(selectedSong.albumArtPath);
 					albumArtLoaded = true;
 				}
@@ -2415,90 +2590,21 @@ int main(int argc, char *argv[]) {
 				float BottomOvershell = u.hpct(1) - u.hinpct(0.15f);
 				float TextPlacementTB = AlbumArtTop;
 				float TextPlacementLR = AlbumArtRight + AlbumArtLeft + 32;
-				DrawTextEx(assets.redHatDisplayBlack, songList.songs[curPlayingSong].title.c_str(),
+				DrawTextEx(assets.redHatDisplayBlack, playingSong.title.data(),
 							{TextPlacementLR, TextPlacementTB - 5}, u.hinpct(0.1f), 0, WHITE);
-				DrawTextEx(assets.rubikBoldItalic, selectedSong.artist.c_str(),
+				DrawTextEx(assets.rubikBoldItalic, selectedSong.artist.data(),
 							{TextPlacementLR, TextPlacementTB + u.hinpct(0.09f)}, u.hinpct(0.05f), 0,
 							LIGHTGRAY);
 				// todo: allow this to be run per player
-				// load midi
+				// which parts and difficulties there are came from the song
+				// cache, so the midi isn't read until the charts load
 				menu.DrawBottomOvershell();
 				menu.DrawBottomBottomOvershell();
 				if (!midiLoaded) {
-					if (!songList.songs[curPlayingSong].midiParsed) {
-						smf::MidiFile midiFile;
-						midiFile.read(songList.songs[curPlayingSong].midiPath.string());
-						songList.songs[curPlayingSong].getTiming(midiFile, 0, midiFile[0]);
-						for (int track = 0; track < midiFile.getTrackCount(); track++) {
-							std::string trackName;
-							for (int events = 0; events < midiFile[track].getSize(); events++) {
-								if (midiFile[track][events].isMeta()) {
-									if ((int) midiFile[track][events][1] == 3) {
-										for (int k = 3; k < midiFile[track][events].getSize(); k++) {
-											trackName += midiFile[track][events][k];
-										}
-										SongParts songPart = song.partFromString(trackName);
-										// if (trackName == "BEAT")
-										// 	songList.songs[curPlayingSong].parseBeatLines(midiFile, track, midiFile[track]);
-										if (trackName == "EVENTS") {
-										 	songList.songs[curPlayingSong].getStartEnd(midiFile, track, midiFile[track]);
-										}
-										else if (trackName != "BEAT") {
-											if (songPart != SongParts::Invalid &&
-												songPart != SongParts::PlasticDrums) {
-												for (int diff = 0; diff < 4; diff++) {
-
-													bool StopChecking = false;
-													std::cout << trackName << " " << diff << endl;
-													/*
-													if (songPart == SongParts::PlasticBass
-														 || songPart == SongParts::PlasticGuitar) {
-														newChart.plastic = true;
-														newChart.parsePlasticNotes(midiFile, i, midiFile[i],
-																	diff, (int)songPart);
-													} else {
-														newChart.plastic = false;
-														newChart.parseNotes(midiFile, i, midiFile[i],
-																	diff, (int)songPart);
-													}
-
-													if (!newChart.plastic) {
-														int noteIdx = 0;
-														for (Note &note : newChart.notes) {
-															newChart.notes_perlane[note.lane].push_back(noteIdx);
-															noteIdx++;
-														}
-													}
-													if (newChart.notes.size() > 0) {
-
-				*/
-													Chart newChart;
-													std::vector<std::vector<int>> pDiffNotes = { {60,64}, {72,76}, {84,88}, {96,100} };
-													for (int i = 0; i < midiFile[track].getSize(); i++) {
-														if (midiFile[track][i].isNoteOn() && !midiFile[track][i].isMeta() && (int)midiFile[track][i][1] >= pDiffNotes[diff][0] && (int)midiFile[track][i][1] <= pDiffNotes[diff][1] && !StopChecking) {
-															// songList.songs[curPlayingSong].parts[(int)songPart]->diff = diff;
-
-															newChart.valid = true;
-															newChart.diff = diff;
-															songList.songs[curPlayingSong].parts[(int)songPart] -> hasPart = true;
-
-															StopChecking = true;
-														}
-													}
-													songList.songs[curPlayingSong].parts[(int)songPart] -> charts.push_back(newChart);
-												}
-											}
-										}
-									}
-								}
-							}
-						}
-						songList.songs[curPlayingSong].midiParsed = true;
-					}
 					midiLoaded = true;
-					if (player.firstReadyUp || !songList.songs[curPlayingSong].parts[player.instrument]->hasPart) {
+					if (player.firstReadyUp || !playingSong.parts[player.instrument].hasPart) {
 						instSelection = true;
-					} else if (!songList.songs[curPlayingSong].parts[player.instrument]->charts[player.diff].valid) {
+					} else if (!playingSong.parts[player.instrument].charts[player.diff].valid) {
 						diffSelection = true;
 					} else if (!player.firstReadyUp) {
 						ReadyUpMenu = true;
@@ -2508,7 +2614,7 @@ int main(int argc, char *argv[]) {
 
 				else if (midiLoaded && instSelection) {
 					if (GuiButton({0, 0, 60, 60}, "<")) {
-						if (player.firstReadyUp || !songList.songs[curPlayingSong].parts[player.instrument]->hasPart) {
+						if (player.firstReadyUp || !playingSong.parts[player.instrument].hasPart) {
 							instSelection = false;
 							diffSelection = false;
 							instSelected = false;
@@ -2522,9 +2628,9 @@ int main(int argc, char *argv[]) {
 							ReadyUpMenu = true;
 						}
 					}
-					// DrawTextRHDI(TextFormat("%s - %s", songList.songs[curPlayingSong].title.c_str(), songList.songs[curPlayingSong].artist.c_str()), 70,7, WHITE);
+					// DrawTextRHDI(TextFormat("%s - %s", playingSong.title.data(), playingSong.artist.data()), 70,7, WHITE);
 					for (int i = 0; i < 7; i++) {
-						if (songList.songs[curPlayingSong].parts[i]->hasPart) {
+						if (playingSong.parts[i].hasPart) {
 							GuiSetStyle(BUTTON, BASE_COLOR_NORMAL, i == player.instrument && instSelected
 											? ColorToInt(ColorBrightness(player.accentColor, -0.25)) : 0x181827FF);
 							GuiSetStyle(BUTTON, TEXT_COLOR_NORMAL,
@@ -2552,7 +2658,7 @@ int main(int argc, char *argv[]) {
 							GuiSetStyle(BUTTON, TEXT_COLOR_NORMAL, 0xcbcbcbFF);
 							GuiSetStyle(BUTTON, TEXT_ALIGNMENT, TEXT_ALIGN_CENTER);
 							DrawTextRubik(
-								(std::to_string(songList.songs[curPlayingSong].parts[i]->diff + 1) + "/7").c_str(),
+								(std::to_string(playingSong.partDiffs[i] + 1) + "/7").c_str(),
 								u.LeftSide + u.winpct(0.165f), BottomOvershell - u.hinpct(0.04f) -
 								(u.hinpct(0.05f) * (float) i), u.hinpct(0.03f), WHITE);
 						} else {
@@ -2579,7 +2685,7 @@ int main(int argc, char *argv[]) {
 											u.LeftSide, BottomOvershell,
 											u.winpct(0.2f), u.hinpct(0.05f)
 										}, "Done")) {
-								if (player.firstReadyUp || songList.songs[curPlayingSong].parts[player.instrument]->charts[player.diff].notes.empty()) {
+								if (player.firstReadyUp || playingSong.parts[player.instrument].charts[player.diff].notes.empty()) {
 									instSelection = false;
 									diffSelection = true;
 								} else {
@@ -2597,10 +2703,10 @@ int main(int argc, char *argv[]) {
 				// load difficulty select
 				if (midiLoaded && diffSelection) {
 					for (int a = 0; a < 4; a++) {
-						if (songList.songs[curPlayingSong].parts[player.instrument]->charts[a].valid) {
+						if (playingSong.parts[player.instrument].charts[a].valid) {
 
 							GuiSetStyle(BUTTON, BASE_COLOR_NORMAL,
-										songList.songs[curPlayingSong].parts[player.instrument]->charts[a].diff == player.diff && diffSelected
+										playingSong.parts[player.instrument].charts[a].diff == player.diff && diffSelected
 											? ColorToInt(
 												ColorBrightness(
 													player.accentColor, -0.25))
@@ -2612,7 +2718,7 @@ int main(int argc, char *argv[]) {
 											u.winpct(0.2f), u.hinpct(0.05f)
 										}, diffList[a].c_str())) {
 								CurrentChart = a;
-								player.diff = songList.songs[curPlayingSong].parts[player.instrument]->charts[a].diff;
+								player.diff = playingSong.parts[player.instrument].charts[a].diff;
 								diffSelected = true;
 							}
 						} else {
@@ -2650,8 +2756,8 @@ int main(int argc, char *argv[]) {
 							GuiSetStyle(BUTTON, BASE_COLOR_NORMAL, 0x181827FF);
 						}
 						if (GuiButton({0, 0, 60, 60}, "<")) {
-							if (player.firstReadyUp || !songList.songs[curPlayingSong].parts
-								[player.instrument]->hasPart) {
+							if (player.firstReadyUp || !playingSong.parts
+								[player.instrument].hasPart) {
 								instSelection = true;
 								diffSelection = false;
 								instSelected = false;
@@ -2710,6 +2816,7 @@ int main(int argc, char *argv[]) {
 						menu.SwitchScreen(CHART_LOADING_SCREEN);
 						glfwSetKeyCallback(glfwGetCurrentContext(), keyCallback);
 						glfwSetGamepadStateCallback(gamepadStateCallback);
+						startInputThread();
 						gpr.camera3pVector = {gpr.camera, gpr.camera3, gpr.camera2};
 					}
 					GuiSetStyle(BUTTON, BASE_COLOR_FOCUSED,
@@ -2731,7 +2838,9 @@ int main(int argc, char *argv[]) {
 			case GAMEPLAY: {
 				// IMAGE BACKGROUNDS??????
 				ClearBackground(BLACK);
-				player.songToBeJudged = songList.songs[curPlayingSong];
+				player.songToBeJudged = &playingSong;
+				audioManager.UpdateSongClock();
+				handleQueuedInputs();
 				if (IsWindowResized() || notes_tex.texture.width != GetScreenWidth()
 						|| notes_tex.texture.height != GetScreenHeight()) {
 					UnloadRenderTexture(notes_tex);
@@ -2775,11 +2884,11 @@ int main(int argc, char *argv[]) {
 				// DrawTextureEx(assets.songBackground, {0,0},0, (float)GetScreenHeight()/assets.songBackground.height,WHITE);
 
 				int starsval = player.stars(
-					songList.songs[curPlayingSong].parts[player.instrument]->charts[player.diff].
+					playingSong.parts[player.instrument].charts[player.diff].
 					baseScore, player.diff);
 				float starPercent =
-						(float) player.score / (float) player.songToBeJudged.parts[player.
-							instrument]->charts[player.diff].baseScore;
+						(float) player.score / (float) player.songToBeJudged->parts[player.
+							instrument].charts[player.diff].baseScore;
 				for (int i = 0; i < 5; i++) {
 					bool firstStar = (i == 0);
 					float starX = scorePos - u.hinpct(0.26) + (i * u.hinpct(0.05));
@@ -2846,9 +2955,21 @@ int main(int argc, char *argv[]) {
 								((player.combo == 0) && (!player.FC)) ? RED : WHITE);
 					DrawTextRubik(TextFormat("Strikes: %01i", player.playerOverhits), 5,
 								GetScreenHeight() - 40, 24, player.FC ? GOLD : WHITE);
+					DrawTextRubik(TextFormat("Audio Latency: %.0f ms, %01i underruns",
+											audioManager.outputLatency * 1000, audioManager.underruns.load()),
+								5, GetScreenHeight() - 70, 24,
+								audioManager.underruns > 0 ? RED : WHITE);
+					SongClock::Stats clockStats = audioManager.songClock.GetStats();
+					DrawTextRubik(TextFormat("Clock Jitter: %.2f ms (max %.2f)",
+											clockStats.frameErrorRms * 1000, clockStats.frameErrorMax * 1000),
+								5, GetScreenHeight() - 190, 24, WHITE);
+					DrawTextRubik(TextFormat("Audio Jitter: %.2f ms (max %.2f), %01i snaps",
+											clockStats.sampleErrorRms * 1000, clockStats.sampleErrorMax * 1000,
+											clockStats.snaps),
+								5, GetScreenHeight() - 160, 24, WHITE);
 				}
 				if (!streamsLoaded && !player.quit) {
-					audioManager.loadStreams(songList.songs[curPlayingSong].stemsPath);
+					audioManager.loadStreams(playingSong.stemsPath, settingsMain.stemCache);
 					streamsLoaded = true;
 					for (auto &stream: audioManager.loadedStreams) {
 						if ((player.plastic ? player.instrument - 4 : player.instrument) ==
@@ -2880,35 +3001,31 @@ int main(int argc, char *argv[]) {
 								stream.handle,
 								settingsMain.MainVolume * settingsMain.BandVolume);
 					}
-					float songPlayed = audioManager.GetMusicTimePlayed(
-						audioManager.loadedStreams[0].handle);
+					float songPlayed = audioManager.songClock.Now();
 					double songEnd =
-							audioManager.
-							GetMusicTimeLength(audioManager.loadedStreams[0].handle) <= (
-								songList.songs[curPlayingSong].end <= 0
+							audioManager.GetMusicTimeLength() <= (
+								playingSong.end <= 0
 									? 0
-									: songList.songs[curPlayingSong].end)
-								? audioManager.GetMusicTimeLength(
-									audioManager.loadedStreams[0].handle) - 0.01
-								: songList.songs[curPlayingSong].end - 0.01;
+									: playingSong.end)
+								? audioManager.GetMusicTimeLength() - 0.01
+								: playingSong.end - 0.01;
 					if (songEnd < songPlayed) {
 						glfwSetKeyCallback(glfwGetCurrentContext(), origKeyCallback);
 						glfwSetGamepadStateCallback(origGamepadCallback);
-						// notes = (int)songList.songs[curPlayingSong].parts[instrument]->charts[diff].notes.size();
+						InputThread::getInstance().Stop();
+						// notes = (int)playingSong.parts[instrument].charts[diff].notes.size();
 						player.overdrive = false;
 						player.overdriveFill = 0.0f;
 						player.overdriveActiveFill = 0.0f;
 						player.overdriveActiveTime = 0.0;
 						player.overdriveActivateTime = 0.0f;
-						gpr.curODPhrase = 0;
 						gpr.curNoteInt = 0;
-						gpr.curSolo = 0;
 						menu.ChosenSong.LoadAlbumArt(menu.ChosenSong.albumArtPath);
 						midiLoaded = false;
 						isPlaying = false;
 						gpr.highwayInAnimation = false;
 						gpr.songEnded = true;
-						songList.songs[curPlayingSong].parts[player.instrument]->charts[player.
+						playingSong.parts[player.instrument].charts[player.
 							diff].resetNotes();
 						gpr.LowerHighway();
 
@@ -2928,31 +3045,34 @@ int main(int argc, char *argv[]) {
 								accentColor;
 						menu.SwitchScreen(RESULTS);
 						TraceLog(LOG_INFO, TextFormat("Song ended at at %f", songPlayed));
+						SongClock::Stats clockStats = audioManager.songClock.GetStats();
+						TraceLog(LOG_INFO, TextFormat("Song clock: %.2f ms frame jitter, %.2f ms audio jitter, %01i snaps",
+													clockStats.frameErrorRms * 1000, clockStats.sampleErrorRms * 1000,
+													clockStats.snaps));
 					}
 				}
 
-				int songPlayed = audioManager.GetMusicTimePlayed(audioManager.loadedStreams[0].handle);
-				double songFloat = audioManager.
-						GetMusicTimePlayed(audioManager.loadedStreams[0].handle);
-				player.notes = (int) songList.songs[curPlayingSong].parts[player.instrument]->charts[
+				int songPlayed = audioManager.songClock.Now();
+				double songFloat = audioManager.songClock.Now();
+				player.notes = (int) playingSong.parts[player.instrument].charts[
 					player.diff].notes.size();
 				// gpr.cameraSel = 1;
 				// gpr.renderPos = 1920/4;
-				// gpr.RenderGameplay(player, songFloat, songList.songs[curPlayingSong], highway_tex, hud_tex, notes_tex, highwayStatus_tex, smasher_tex);
+				// gpr.RenderGameplay(player, songFloat, playingSong, highway_tex, hud_tex, notes_tex, highwayStatus_tex, smasher_tex);
 				// gpr.cameraSel = 2;
 				// gpr.renderPos = -1920/4;
-				// gpr.RenderGameplay(player, songFloat, songList.songs[curPlayingSong], highway_tex, hud_tex, notes_tex, highwayStatus_tex, smasher_tex);
+				// gpr.RenderGameplay(player, songFloat, playingSong, highway_tex, hud_tex, notes_tex, highwayStatus_tex, smasher_tex);
 				gpr.renderPos = 0;
 				gpr.cameraSel = 0;
-				gpr.RenderGameplay(player, songFloat, songList.songs[curPlayingSong], highway_tex,
+				gpr.RenderGameplay(player, songFloat, playingSong, highway_tex,
 									hud_tex, notes_tex, highwayStatus_tex, smasher_tex);
 
 
 				float SongNameWidth = MeasureTextEx(assets.rubikBoldItalic,
-													songList.songs[curPlayingSong].title.c_str(),
+													playingSong.title.data(),
 													u.hinpct(0.05f), 0).x;
 				float SongArtistWidth = MeasureTextEx(assets.rubikBoldItalic,
-													songList.songs[curPlayingSong].artist.c_str(),
+													playingSong.artist.data(),
 													u.hinpct(0.045f), 0).x;
 
 				double SongNameDuration = 0.75f;
@@ -2995,10 +3115,10 @@ int main(int argc, char *argv[]) {
 					DrawRectangleGradientH(0, u.hpct(0.14f), 1.25 * SongBackgroundWidth,
 											u.hinpct(0.115f), Color{0, 0, 0, 128},
 											Color{0, 0, 0, 0});
-					DrawTextEx(assets.rubikBoldItalic, songList.songs[curPlayingSong].title.c_str(),
+					DrawTextEx(assets.rubikBoldItalic, playingSong.title.data(),
 								{SongNamePosition, u.hpct(0.15f)}, u.hinpct(0.05f), 0,
 								Color{255, 255, 255, SongNameAlpha});
-					DrawTextEx(assets.rubikItalic, songList.songs[curPlayingSong].artist.c_str(),
+					DrawTextEx(assets.rubikItalic, playingSong.artist.data(),
 								{SongArtistPosition, u.hpct(0.20f)}, u.hinpct(0.045f), 0, Color{
 									200, 200, 200, SongArtistAlpha
 								});
@@ -3006,11 +3126,10 @@ int main(int argc, char *argv[]) {
 
 
 				int songLength;
-				if (songList.songs[curPlayingSong].end == 0)
-					songLength = static_cast<int>(audioManager.GetMusicTimeLength(
-						audioManager.loadedStreams[0].handle));
+				if (playingSong.end == 0)
+					songLength = static_cast<int>(audioManager.GetMusicTimeLength());
 				else
-					songLength = static_cast<int>(songList.songs[curPlayingSong].end);
+					songLength = static_cast<int>(playingSong.end);
 				int playedMinutes = songPlayed / 60;
 				int playedSeconds = songPlayed % 60;
 				int songMinutes = songLength / 60;
@@ -3029,8 +3148,7 @@ int main(int argc, char *argv[]) {
 				GuiSetStyle(DEFAULT, TEXT_ALIGNMENT, TEXT_ALIGN_CENTER);
 				GuiSetFont(assets.rubik);
 
-				float floatSongLength = audioManager.GetMusicTimePlayed(
-					audioManager.loadedStreams[0].handle);
+				float floatSongLength = audioManager.songClock.Now();
 
 				const char *textTime = TextFormat("%i:%02i / %i:%02i ", playedMinutes, playedSeconds,
 												songMinutes, songSeconds);
@@ -3062,29 +3180,8 @@ int main(int argc, char *argv[]) {
 
 					if (GuiButton({u.wpct(0.02f), u.hpct(0.39f), u.winpct(0.2f), u.hinpct(0.08f)},
 								"Restart")) {
-						for (Note &note: songList.songs[curPlayingSong].parts[player.instrument]
-							->charts[player.diff].notes) {
-							note.accounted = false;
-							note.hit = false;
-							note.miss = false;
-							note.held = false;
-							note.heldTime = 0;
-							note.hitTime = 0;
-							note.perfect = false;
-							note.countedForODPhrase = false;
-							note.hitWithFAS = false;
-							note.strumCount = 0;
-						}
-						for (odPhrase &phrase: songList.songs[curPlayingSong].parts[player.
-								instrument]->charts[player.diff].odPhrases) {
-							phrase.missed = false;
-							phrase.notesHit = 0;
-							phrase.added = false;
-						}
-						for (solo &solo: songList.songs[curPlayingSong].parts[player.instrument]
-							->charts[player.diff].Solos) {
-							solo.notesHit = 0;
-						}
+						playingSong.parts[player.instrument].charts[player.
+							diff].resetNotes();
 						gpr.songStartTime = GetTime();
 						player.overdrive = false;
 						player.overdriveFill = 0.0f;
@@ -3092,9 +3189,7 @@ int main(int argc, char *argv[]) {
 						player.overdriveActiveTime = 0.0;
 						player.overdriveActivateTime = 0.0f;
 						gpr.highwayInAnimation = false;
-						gpr.curODPhrase = 0;
 						gpr.curNoteInt = 0;
-						gpr.curSolo = 0;
 						gpr.curNoteIdx = {0, 0, 0, 0, 0};
 						gpr.curBeatLine = 0;
 						player.resetPlayerStats();
@@ -3123,8 +3218,9 @@ int main(int argc, char *argv[]) {
 								"Drop Out")) {
 						glfwSetKeyCallback(glfwGetCurrentContext(), origKeyCallback);
 						glfwSetGamepadStateCallback(origGamepadCallback);
-						// notes = songList.songs[curPlayingSong].parts[instrument]->charts[diff].notes.size();
-						// notes = songList.songs[curPlayingSong].parts[instrument]->charts[diff];
+						InputThread::getInstance().Stop();
+						// notes = playingSong.parts[instrument].charts[diff].notes.size();
+						// notes = playingSong.parts[instrument].charts[diff];
 						menu.SwitchScreen(RESULTS);
 						menu.ChosenSong.LoadAlbumArt(menu.ChosenSong.albumArtPath);
 						player.overdrive = false;
@@ -3133,8 +3229,6 @@ int main(int argc, char *argv[]) {
 						player.overdriveActiveTime = 0.0;
 						player.overdriveActivateTime = 0.0f;
 						gpr.curNoteInt = 0;
-						gpr.curODPhrase = 0;
-						gpr.curSolo = 0;
 						gpr.highwayInAnimation = false;
 						player.paused = false;
 						assets.expertHighway.materials[0].maps[MATERIAL_MAP_ALBEDO].texture =
@@ -3154,7 +3248,7 @@ int main(int argc, char *argv[]) {
 						midiLoaded = false;
 						isPlaying = false;
 						gpr.songEnded = true;
-						songList.songs[curPlayingSong].parts[player.instrument]->charts[player.
+						playingSong.parts[player.instrument].charts[player.
 							diff].resetNotes();
 						player.quit = true;
 						songAlbumArtLoadedGameplay = false;
@@ -3183,15 +3277,15 @@ int main(int argc, char *argv[]) {
 						songPartsList[player.instrument].c_str());
 
 					float TitleHeight = MeasureTextEx(
-						assets.rubikBoldItalic, menu.ChosenSong.title.c_str(), SongFontSize,
+						assets.rubikBoldItalic, menu.ChosenSong.title.data(), SongFontSize,
 						0).y;
 					float TitleWidth = MeasureTextEx(
-						assets.rubikBoldItalic, menu.ChosenSong.title.c_str(), SongFontSize,
+						assets.rubikBoldItalic, menu.ChosenSong.title.data(), SongFontSize,
 						0).x;
 					float ArtistHeight = MeasureTextEx(
-						assets.rubikItalic, menu.ChosenSong.artist.c_str(), SongFontSize, 0).y;
+						assets.rubikItalic, menu.ChosenSong.artist.data(), SongFontSize, 0).y;
 					float ArtistWidth = MeasureTextEx(
-						assets.rubikItalic, menu.ChosenSong.artist.c_str(), SongFontSize, 0).x;
+						assets.rubikItalic, menu.ChosenSong.artist.data(), SongFontSize, 0).x;
 					float InstDiffHeight = MeasureTextEx(
 						assets.rubikBold, instDiffText, SongFontSize, 0).y;
 					float InstDiffWidth = MeasureTextEx(
@@ -3210,9 +3304,9 @@ int main(int argc, char *argv[]) {
 						u.hpct(0.1f) + (ArtistHeight / 2) + (InstDiffHeight * 0.1f)
 					};
 
-					DrawTextEx(assets.rubikBoldItalic, menu.ChosenSong.title.c_str(), SongTitleBox,
+					DrawTextEx(assets.rubikBoldItalic, menu.ChosenSong.title.data(), SongTitleBox,
 								SongFontSize, 0, WHITE);
-					DrawTextEx(assets.rubikItalic, menu.ChosenSong.artist.c_str(), SongArtistBox,
+					DrawTextEx(assets.rubikItalic, menu.ChosenSong.artist.data(), SongArtistBox,
 								SongFontSize, 0, WHITE);
 					DrawTextEx(assets.rubikBold, instDiffText, SongInstDiffBox, SongFontSize, 0,
 								WHITE);
@@ -3298,12 +3392,12 @@ int main(int argc, char *argv[]) {
 			case CHART_LOADING_SCREEN: {
 				ClearBackground(BLACK);
 				if (StartLoading) {
-					songList.songs[curPlayingSong].LoadAlbumArt(songList.songs[curPlayingSong].albumArtPath);
+					playingSong.LoadAlbumArt(playingSong.albumArtPath);
 					std::thread ChartLoader(LoadCharts);
 					ChartLoader.detach();
 					StartLoading = false;
 				}
-				menu.DrawAlbumArtBackground(songList.songs[curPlayingSong].albumArtBlur);
+				menu.DrawAlbumArtBackground(playingSong.albumArtBlur);
 				menu.DrawTopOvershell(0.15f);
 				DrawTextEx(assets.redHatDisplayBlack, "LOADING...  ", {u.LeftSide, u.hpct(0.05f)},
 							u.hinpct(0.125f), 0,
@@ -3340,6 +3434,7 @@ int main(int argc, char *argv[]) {
 				break;
 			}
 		}
+		drawSongLoadingProgress();
 		EndDrawing();
 
 		//SwapScreenBuffer();
@@ -0,0 +1,364 @@
+//
+// Filename:      midifile/src/MidiEventView.cpp
+// Syntax:        C++11
+// vim:           ts=3 noexpandtab
+//
+// Description:   Read-only access to the events of a MidiFile track
+//                without a MidiEvent object per message.
+//
+
+
+#include "midifile/MidiEventView.h"
+
+namespace smf {
+
+//////////////////////////////
+//
+// MidiEventView::MidiEventView -- Constructor.  The bytes are not
+//     copied and must outlive the view.
+//
+
+MidiEventView::MidiEventView(int aTick, const uchar* bytes, int count) {
+	tick   = aTick;
+	m_data = bytes;
+	m_size = count;
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventView::operator[] -- return a byte of the message, laid
+//     out the same as in MidiMessage.
+//
+
+uchar MidiEventView::operator[](int index) const {
+	return m_data[index];
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventView::getSize -- number of bytes in the message.
+//
+
+int MidiEventView::getSize(void) const {
+	return m_size;
+}
+
+
+int MidiEventView::size(void) const {
+	return m_size;
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventView::data -- the message bytes.
+//
+
+const uchar* MidiEventView::data(void) const {
+	return m_data;
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventView::getP0 -- first byte of the message, or -1 if empty.
+//
+
+int MidiEventView::getP0(void) const {
+	return m_size < 1 ? -1 : m_data[0];
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventView::getP1 -- second byte of the message, or -1 if none.
+//
+
+int MidiEventView::getP1(void) const {
+	return m_size < 2 ? -1 : m_data[1];
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventView::getP2 -- third byte of the message, or -1 if none.
+//
+
+int MidiEventView::getP2(void) const {
+	return m_size < 3 ? -1 : m_data[2];
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventView::getMetaType -- the meta message type, or -1 if the
+//     message is not a meta message.
+//
+
+int MidiEventView::getMetaType(void) const {
+	if (!isMetaMessage()) {
+		return -1;
+	}
+	return m_data[1];
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventView::getMetaContent -- the data bytes of a meta message
+//     after its variable-length size.
+//
+
+std::string MidiEventView::getMetaContent(void) const {
+	std::string output;
+	if (!isMetaMessage()) {
+		return output;
+	}
+	int start = 3;
+	while ((start - 1 < m_size) && (start < 7) && (m_data[start-1] > 0x7f)) {
+		start++;
+	}
+	if (start < m_size) {
+		output.assign((const char*)m_data + start, m_size - start);
+	}
+	return output;
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventView::isNoteOn -- note-on message with a non-zero velocity.
+//
+
+bool MidiEventView::isNoteOn(void) const {
+	return (m_size == 3) && ((m_data[0] & 0xf0) == 0x90) && (m_data[2] != 0);
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventView::isNoteOff -- note-off message, or note-on with a zero
+//     velocity.
+//
+
+bool MidiEventView::isNoteOff(void) const {
+	if (m_size != 3) {
+		return false;
+	} else if ((m_data[0] & 0xf0) == 0x80) {
+		return true;
+	} else {
+		return ((m_data[0] & 0xf0) == 0x90) && (m_data[2] == 0x00);
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventView::isNote -- note-on or note-off message.
+//
+
+bool MidiEventView::isNote(void) const {
+	return isNoteOn() || isNoteOff();
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventView::isMeta -- true for a well-formed meta message.
+//
+
+bool MidiEventView::isMeta(void) const {
+	return (m_size >= 3) && (m_data[0] == 0xff);
+}
+
+
+bool MidiEventView::isMetaMessage(void) const {
+	return isMeta();
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventView::isTempo -- tempo meta message.
+//
+
+bool MidiEventView::isTempo(void) const {
+	return isMeta() && (m_data[1] == 0x51) && (m_size == 6);
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventView::isTrackName -- track name meta message.
+//
+
+bool MidiEventView::isTrackName(void) const {
+	return isMeta() && (m_data[1] == 0x03);
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventView::isTimeSignature -- time signature meta message.
+//
+
+bool MidiEventView::isTimeSignature(void) const {
+	return isMeta() && (m_data[1] == 0x58) && (m_size == 7);
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventView::isEndOfTrack -- end-of-track meta message.
+//
+
+bool MidiEventView::isEndOfTrack(void) const {
+	return getMetaType() == 0x2f;
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventView::getTempoMicroseconds -- microseconds per quarter note
+//     of a tempo message, or -1 if not a tempo message.
+//
+
+int MidiEventView::getTempoMicroseconds(void) const {
+	if (!isTempo()) {
+		return -1;
+	}
+	return (m_data[3] << 16) + (m_data[4] << 8) + m_data[5];
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventView::getTempoBPM -- quarter notes per minute of a tempo
+//     message, or -1 if not a tempo message.
+//
+
+double MidiEventView::getTempoBPM(void) const {
+	int microseconds = getTempoMicroseconds();
+	if (microseconds < 0) {
+		return -1.0;
+	}
+	return 60000000.0 / (double)microseconds;
+}
+
+
+
+//////////////////////////////
+//
+// MidiEventView::getTempoSPT -- seconds per tick of a tempo message,
+//     or -1 if not a tempo message.
+//
+
+double MidiEventView::getTempoSPT(int tpq) const {
+	int microseconds = getTempoMicroseconds();
+	if (microseconds < 0) {
+		return -1.0;
+	}
+	return (double)microseconds / 1000000.0 / tpq;
+}
+
+
+
+//////////////////////////////
+//
+// MidiTrackView::MidiTrackView -- Constructors for a packed track (the
+//     meta and sysex offsets point into buffer) or a MidiEventList.
+//
+
+MidiTrackView::MidiTrackView(const std::vector<PackedMidiEvent>* events,
+		const uchar* buffer) {
+	m_packed = events;
+	m_buffer = buffer;
+}
+
+
+MidiTrackView::MidiTrackView(const MidiEventList* list) {
+	m_list = list;
+}
+
+
+
+//////////////////////////////
+//
+// MidiTrackView::operator[] -- view of an event in the track.
+//
+
+MidiEventView MidiTrackView::operator[](int index) const {
+	if (m_packed) {
+		const PackedMidiEvent& event = (*m_packed)[index];
+		const uchar* bytes = event.offset < 0 ? event.data : m_buffer + event.offset;
+		return MidiEventView(event.tick, bytes, event.size);
+	}
+	const MidiEvent& event = (*m_list)[index];
+	return MidiEventView(event.tick, event.data(), (int)event.size());
+}
+
+
+MidiEventView MidiTrackView::getEvent(int index) const {
+	return (*this)[index];
+}
+
+
+
+//////////////////////////////
+//
+// MidiTrackView::back -- view of the last event in the track.
+//
+
+MidiEventView MidiTrackView::back(void) const {
+	return (*this)[getSize() - 1];
+}
+
+
+
+//////////////////////////////
+//
+// MidiTrackView::getSize -- number of events in the track.
+//
+
+int MidiTrackView::getSize(void) const {
+	if (m_packed) {
+		return (int)m_packed->size();
+	}
+	return m_list ? m_list->getSize() : 0;
+}
+
+
+int MidiTrackView::getEventCount(void) const {
+	return getSize();
+}
+
+
+int MidiTrackView::size(void) const {
+	return getSize();
+}
+
+
+} // end of namespace smf
+
+
+
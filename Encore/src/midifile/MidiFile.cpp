@@ -155,6 +155,10 @@ MidiFile& MidiFile::operator=(const MidiFile& other) {
 	m_readFileName        = other.m_readFileName;
 	m_timemapvalid        = other.m_timemapvalid;
 	m_timemap             = other.m_timemap;
+	m_tempotimemap        = other.m_tempotimemap;
+	m_packeddata          = other.m_packeddata;
+	m_packedtracks        = other.m_packedtracks;
+	m_trackdirectory      = other.m_trackdirectory;
 	m_rwstatus            = other.m_rwstatus;
 	if (other.m_linkedEventsQ) {
 		linkEventPairs();
@@ -175,6 +179,10 @@ MidiFile& MidiFile::operator=(MidiFile&& other) {
 	m_readFileName        = other.m_readFileName;
 	m_timemapvalid        = other.m_timemapvalid;
 	m_timemap             = other.m_timemap;
+	m_tempotimemap        = other.m_tempotimemap;
+	m_packeddata          = std::move(other.m_packeddata);
+	m_packedtracks        = std::move(other.m_packedtracks);
+	m_trackdirectory      = std::move(other.m_trackdirectory);
 	m_rwstatus            = other.m_rwstatus;
 	return *this;
 }
@@ -547,6 +555,422 @@ bool MidiFile::readSmf(std::istream& input) {
 
 
 
+//////////////////////////////
+//
+// MidiFile::readPacked -- Read a Standard MIDI File into packed tracks.
+//      The file is loaded with a single read and decoded from memory:
+//      channel messages are stored inline in PackedMidiEvent records and
+//      meta/sysex messages as offsets into the file data, so no MidiEvent
+//      is allocated.  The events can only be read with getTrackView(),
+//      and only the tempo-only time map is available.
+//
+//      If decodeTracks is false, only the track directory (where each
+//      track chunk starts and its name) is read, and tracks are decoded
+//      on request with decodeTrack().
+//
+
+bool MidiFile::readPacked(const std::string& filename, bool decodeTracks) {
+	std::ifstream input(filename.c_str(), std::ios::binary | std::ios::ate);
+	if (!input.is_open()) {
+		clear();
+		m_rwstatus = false;
+		return m_rwstatus;
+	}
+	std::streamsize length = input.tellg();
+	std::vector<uchar> data(length > 0 ? (size_t)length : 0);
+	input.seekg(0, std::ios::beg);
+	if (!data.empty() && !input.read((char*)data.data(), length)) {
+		clear();
+		m_rwstatus = false;
+		return m_rwstatus;
+	}
+	setFilename(filename);
+	return readPacked(std::move(data), decodeTracks);
+}
+
+
+bool MidiFile::readPacked(std::vector<uchar> data, bool decodeTracks) {
+	clear();
+	m_packeddata = std::move(data);
+	m_tempotimemap = true;
+	m_rwstatus = readPackedDirectory();
+	for (int i=0; m_rwstatus && decodeTracks && i<getTrackCount(); i++) {
+		m_rwstatus = decodeTrack(i);
+	}
+	if (!m_rwstatus) {
+		clear();
+	}
+	return m_rwstatus;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::isPacked -- true if the file was read with readPacked().
+//
+
+bool MidiFile::isPacked(void) const {
+	return !m_trackdirectory.empty();
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::decodeTrack -- decode the events of a packed track that was
+//     skipped by readPacked().  Returns true if the track is decoded.
+//
+
+bool MidiFile::decodeTrack(int aTrack) {
+	if ((aTrack < 0) || (aTrack >= (int)m_trackdirectory.size())) {
+		return false;
+	}
+	PackedTrackChunk& chunk = m_trackdirectory[aTrack];
+	if (chunk.decoded) {
+		return true;
+	}
+	std::vector<PackedMidiEvent>& list = m_packedtracks[aTrack];
+	int endposition;
+	if (!decodePackedTrack(chunk.offset, chunk.size, list, endposition)) {
+		std::cerr << "In file " << getFilename() << ": cannot decode track "
+		     << aTrack << std::endl;
+		list.clear();
+		return false;
+	}
+	chunk.decoded = true;
+
+	// tempo changes in the new track belong in the time map
+	MidiTrackView events = getTrackView(aTrack);
+	for (int i=0; i<events.size(); i++) {
+		if (events[i].isTempo()) {
+			m_timemapvalid = 0;
+			break;
+		}
+	}
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::isTrackDecoded -- true if the events of the track are
+//     available.  Always true for files not read with readPacked().
+//
+
+bool MidiFile::isTrackDecoded(int aTrack) const {
+	if (!isPacked()) {
+		return (aTrack >= 0) && (aTrack < getTrackCount());
+	}
+	if ((aTrack < 0) || (aTrack >= (int)m_trackdirectory.size())) {
+		return false;
+	}
+	return m_trackdirectory[aTrack].decoded;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::getTrackName -- name of a packed track, from its directory
+//     entry.  Empty if the track has no name at its start or the file
+//     was not read with readPacked().
+//
+
+std::string MidiFile::getTrackName(int aTrack) const {
+	if ((aTrack < 0) || (aTrack >= (int)m_trackdirectory.size())) {
+		return "";
+	}
+	return m_trackdirectory[aTrack].name;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::findTrack -- index of the first packed track with the given
+//     name, or -1 if there is none.
+//
+
+int MidiFile::findTrack(const std::string& name) const {
+	for (int i=0; i<(int)m_trackdirectory.size(); i++) {
+		if (m_trackdirectory[i].name == name) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::readPackedDirectory -- Read the header of m_packeddata and
+//     find where each track chunk starts, along with the track name if
+//     one is given at tick 0.  Each track is skipped by its chunk size;
+//     if the size does not lead to the next chunk (many MIDI files in
+//     the wild have wrong sizes), the track is decoded to find its end
+//     the way readSmf() does.
+//
+
+bool MidiFile::readPackedDirectory(void) {
+	const uchar* data = m_packeddata.data();
+	int size = (int)m_packeddata.size();
+	std::string filename = getFilename();
+
+	if (size < 14 || data[0] != 'M' || data[1] != 'T' || data[2] != 'h' || data[3] != 'd') {
+		std::cerr << "File " << filename << " is not a MIDI file" << std::endl;
+		return false;
+	}
+	ulong headersize = ((ulong)data[4] << 24) | (data[5] << 16) | (data[6] << 8) | data[7];
+	if (headersize != 6) {
+		std::cerr << "File " << filename
+		     << " is not a MIDI 1.0 Standard MIDI file." << std::endl;
+		std::cerr << "The header size is " << headersize << " bytes." << std::endl;
+		return false;
+	}
+	int type = (data[8] << 8) | data[9];
+	if (type > 1) {
+		std::cerr << "Error: cannot handle a type-" << type
+		     << " MIDI file" << std::endl;
+		return false;
+	}
+	int tracks = (data[10] << 8) | data[11];
+	if (type == 0 && tracks != 1) {
+		std::cerr << "Error: Type 0 MIDI file can only contain one track" << std::endl;
+		std::cerr << "Instead track count is: " << tracks << std::endl;
+		return false;
+	}
+
+	int division = (data[12] << 8) | data[13];
+	if (division >= 0x8000) {
+		int framespersecond = 255 - ((division >> 8) & 0x00ff) + 1;
+		int subframes       = division & 0x00ff;
+		m_ticksPerQuarterNote = framespersecond * subframes;
+	} else {
+		m_ticksPerQuarterNote = division;
+	}
+
+	// empty event lists so that the track count is right
+	for (int i=0; i<(int)m_events.size(); i++) {
+		delete m_events[i];
+	}
+	m_events.resize(tracks);
+	for (int i=0; i<tracks; i++) {
+		m_events[i] = new MidiEventList;
+	}
+	m_packedtracks.resize(tracks);
+	m_trackdirectory.resize(tracks);
+
+	auto isTrackChunk = [&](int position) {
+		return position + 8 <= size && data[position] == 'M' && data[position+1] == 'T' &&
+				data[position+2] == 'r' && data[position+3] == 'k';
+	};
+
+	int position = 14;
+	for (int i=0; i<tracks; i++) {
+		if (!isTrackChunk(position)) {
+			std::cerr << "In file " << filename << ": expecting MTrk for track "
+			     << i << std::endl;
+			return false;
+		}
+		PackedTrackChunk& chunk = m_trackdirectory[i];
+		chunk.size = (int)(((ulong)data[position+4] << 24) | (data[position+5] << 16) |
+				(data[position+6] << 8) | data[position+7]);
+		chunk.offset = position + 8;
+		chunk.decoded = false;
+		chunk.name.clear();
+
+		// the track name, if any, is among the messages at tick 0
+		int namepos = chunk.offset;
+		uchar runningCommand = 0;
+		int delta = 0;
+		PackedMidiEvent event;
+		while (readPackedVLV(data, size, namepos, delta) && (delta == 0) &&
+				readPackedEvent(data, size, namepos, runningCommand, event)) {
+			if (event.offset < 0 || data[event.offset] != 0xff) {
+				continue;
+			}
+			MidiEventView message(0, data + event.offset, event.size);
+			if (message.isTrackName()) {
+				chunk.name = message.getMetaContent();
+				break;
+			}
+			if (message.isEndOfTrack()) {
+				break;
+			}
+		}
+
+		int next = chunk.offset + chunk.size;
+		if ((chunk.size >= 0) && (next <= size) && ((next == size) || isTrackChunk(next))) {
+			position = next;
+		} else {
+			if (!decodePackedTrack(chunk.offset, -1, m_packedtracks[i], position)) {
+				std::cerr << "In file " << filename << ": cannot decode track "
+				     << i << std::endl;
+				return false;
+			}
+			chunk.decoded = true;
+		}
+	}
+
+	m_theTimeState = TIME_STATE_ABSOLUTE;
+	m_theTrackState = TRACK_STATE_SPLIT;
+	m_timemapvalid = 0;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::decodePackedTrack -- Decode the events of the track chunk
+//     whose data starts at offset, up to and including the end-of-track
+//     message.  The chunk size (if not negative) is only used to reserve
+//     space.  endposition is set to the byte after the track.
+//
+
+bool MidiFile::decodePackedTrack(int offset, int chunksize,
+		std::vector<PackedMidiEvent>& list, int& endposition) {
+	const uchar* data = m_packeddata.data();
+	int size = (int)m_packeddata.size();
+
+	list.clear();
+	// at least three bytes per event with running status
+	if (chunksize > 0 && chunksize < size) {
+		list.reserve(chunksize / 3);
+	}
+
+	int position = offset;
+	uchar runningCommand = 0;
+	int absticks = 0;
+	while (position < size) {
+		int delta;
+		if (!readPackedVLV(data, size, position, delta)) {
+			std::cerr << "Error: bad delta time." << std::endl;
+			return false;
+		}
+		absticks += delta;
+		PackedMidiEvent event;
+		if (!readPackedEvent(data, size, position, runningCommand, event)) {
+			return false;
+		}
+		event.tick = absticks;
+		list.push_back(event);
+
+		if ((event.offset >= 0) && (data[event.offset] == 0xff) &&
+				(data[event.offset+1] == 0x2f)) {
+			// end-of-track message
+			break;
+		}
+	}
+	endposition = position;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::readPackedEvent -- Read the MIDI message at position (after
+//     its delta time) into event, and move position past it.  The tick
+//     of the event is left for the caller.
+//
+
+bool MidiFile::readPackedEvent(const uchar* data, int size, int& position,
+		uchar& runningCommand, PackedMidiEvent& event) {
+	event.tick   = 0;
+	event.offset = -1;
+	event.size   = 0;
+	if (position >= size) {
+		std::cerr << "Error: unexpected end of file." << std::endl;
+		return false;
+	}
+
+	uchar byte = data[position];
+	if (byte < 0x80) {
+		if (runningCommand == 0) {
+			std::cerr << "Error: running command with no previous command" << std::endl;
+			return false;
+		}
+		if (runningCommand >= 0xf0) {
+			std::cerr << "Error: running status not permitted with meta and sysex"
+			     << " event." << std::endl;
+			return false;
+		}
+	} else {
+		runningCommand = byte;
+		position++;
+	}
+
+	if (runningCommand < 0xf0) {
+		int count = ((runningCommand & 0xf0) == 0xc0) ||
+				((runningCommand & 0xf0) == 0xd0) ? 1 : 2;
+		if (position + count > size) {
+			std::cerr << "Error: unexpected end of file." << std::endl;
+			return false;
+		}
+		event.data[0] = runningCommand;
+		for (int j=0; j<count; j++) {
+			if (data[position] > 0x7f) {
+				std::cerr << "MIDI data byte too large: " << (int)data[position] << std::endl;
+				return false;
+			}
+			event.data[j+1] = data[position++];
+		}
+		event.size = count + 1;
+		return true;
+	}
+
+	int start = position - 1;
+	if (runningCommand == 0xff) {
+		// meta message: stored like MidiMessage, with its type and
+		// length bytes
+		position++;
+	}
+	if ((runningCommand == 0xff) || (runningCommand == 0xf0) ||
+			(runningCommand == 0xf7)) {
+		// sysex messages keep their length bytes, unlike MidiMessage
+		int length;
+		if (position > size || !readPackedVLV(data, size, position, length) ||
+				(length > size - position)) {
+			std::cerr << "Error: unexpected end of file." << std::endl;
+			return false;
+		}
+		position += length;
+	}
+	event.offset = start;
+	event.size   = position - start;
+	return true;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::readPackedVLV -- Read a variable-length value of up to four
+//     bytes from data at position, and move position past it.  Returns
+//     false if it runs past the end of the data or is too long.
+//
+
+bool MidiFile::readPackedVLV(const uchar* data, int size, int& position, int& value) {
+	value = 0;
+	for (int i=0; i<4; i++) {
+		if (position >= size) {
+			return false;
+		}
+		uchar byte = data[position++];
+		value = (value << 7) | (byte & 0x7f);
+		if (byte < 0x80) {
+			return true;
+		}
+	}
+	return false;
+}
+
+
+
 //////////////////////////////
 //
 // MidiFile::write -- write a standard MIDI file to a file or an output
@@ -946,6 +1370,22 @@ void MidiFile::removeEmpties(void) {
 
 
 
+//////////////////////////////
+//
+// MidiFile::getTrackView -- read-only view of the events in a track,
+//     which works both for files read with readPacked() and for the
+//     regular MidiEventLists.
+//
+
+MidiTrackView MidiFile::getTrackView(int aTrack) const {
+	if (isPacked()) {
+		return MidiTrackView(&m_packedtracks[aTrack], m_packeddata.data());
+	}
+	return MidiTrackView(m_events[aTrack]);
+}
+
+
+
 //////////////////////////////
 //
 // MidiFile::markSequence -- Assign a sequence serial number to
@@ -1455,9 +1895,21 @@ double MidiFile::getFileDurationInSeconds(void) {
 	}
 	const MidiFile& mf = *this;
 	double output = 0.0;
-	for (int i=0; i<mf.getTrackCount(); i++) {
-		if (mf[i].back().seconds > output) {
-			output = mf[i].back().seconds;
+	if (m_tempotimemap) {
+		// event seconds are not filled in by the tempo-only time map
+		int lasttick = 0;
+		for (int i=0; i<mf.getTrackCount(); i++) {
+			MidiTrackView list = getTrackView(i);
+			if (list.size() > 0 && list.back().tick > lasttick) {
+				lasttick = list.back().tick;
+			}
+		}
+		output = getTimeInSeconds(lasttick);
+	} else {
+		for (int i=0; i<mf.getTrackCount(); i++) {
+			if (mf[i].back().seconds > output) {
+				output = mf[i].back().seconds;
+			}
 		}
 	}
 	if (revertToDelta) {
@@ -1481,6 +1933,30 @@ double MidiFile::getFileDurationInSeconds(void) {
 
 void MidiFile::doTimeAnalysis(void) {
 	buildTimeMap();
+	if (!m_tempotimemap || m_timemapvalid == 0) {
+		return;
+	}
+
+	// The tempo-only time map leaves the events alone, so stamp
+	// their times here, one sweep per track.
+	bool delta = isDeltaTicks();
+	for (int i=0; i<getTrackCount(); i++) {
+		MidiEventList& list = *m_events[i];
+		int curtick = 0;
+		int segment = 0;
+		for (int j=0; j<list.size(); j++) {
+			curtick = delta ? curtick + list[j].tick : list[j].tick;
+			if (curtick < m_timemap[segment].tick) {
+				segment = tempoSegmentAtTick(curtick);
+			}
+			while ((segment < (int)m_timemap.size()-1) &&
+					(m_timemap[segment+1].tick <= curtick)) {
+				segment++;
+			}
+			const _TickTime& entry = m_timemap[segment];
+			list[j].seconds = entry.seconds + (curtick - entry.tick) * entry.secondsPerTick;
+		}
+	}
 }
 
 
@@ -1492,7 +1968,7 @@ void MidiFile::doTimeAnalysis(void) {
 //
 
 double MidiFile::getTimeInSeconds(int aTrack, int anIndex) {
-	return getTimeInSeconds(getEvent(aTrack, anIndex).tick);
+	return getTimeInSeconds(getTrackView(aTrack)[anIndex].tick);
 }
 
 
@@ -1504,6 +1980,11 @@ double MidiFile::getTimeInSeconds(int tickvalue) {
 		}
 	}
 
+	if (m_tempotimemap) {
+		const _TickTime& entry = m_timemap[tempoSegmentAtTick(tickvalue)];
+		return entry.seconds + (tickvalue - entry.tick) * entry.secondsPerTick;
+	}
+
 	_TickTime key;
 	key.tick    = tickvalue;
 	key.seconds = -1;
@@ -1541,6 +2022,14 @@ double MidiFile::getAbsoluteTickTime(double starttime) {
 		}
 	}
 
+	if (m_tempotimemap) {
+		if (starttime < 0.0) {
+			return -1.0;
+		}
+		const _TickTime& entry = m_timemap[tempoSegmentAtSecond(starttime)];
+		return entry.tick + (starttime - entry.seconds) / entry.secondsPerTick;
+	}
+
 	_TickTime key;
 	key.tick    = -1;
 	key.seconds = starttime;
@@ -1562,6 +2051,81 @@ double MidiFile::getAbsoluteTickTime(double starttime) {
 
 
 
+//////////////////////////////
+//
+// MidiFile::getTimesInSeconds -- convert a list of tick values into
+//    seconds.  With the tempo-only time map, ticks in ascending order
+//    are converted in a single sweep through the tempo changes rather
+//    than by a search for each tick.
+//
+
+void MidiFile::getTimesInSeconds(const std::vector<int>& ticks,
+		std::vector<double>& seconds) {
+	seconds.resize(ticks.size());
+	if (!m_tempotimemap) {
+		for (int i=0; i<(int)ticks.size(); i++) {
+			seconds[i] = getTimeInSeconds(ticks[i]);
+		}
+		return;
+	}
+	if (m_timemapvalid == 0) {
+		buildTimeMap();
+		if (m_timemapvalid == 0) {
+			std::fill(seconds.begin(), seconds.end(), -1.0);
+			return;
+		}
+	}
+
+	int segment = 0;
+	for (int i=0; i<(int)ticks.size(); i++) {
+		if (ticks[i] < m_timemap[segment].tick) {
+			// out of order, so fall back to searching
+			segment = tempoSegmentAtTick(ticks[i]);
+		}
+		while ((segment < (int)m_timemap.size()-1) &&
+				(m_timemap[segment+1].tick <= ticks[i])) {
+			segment++;
+		}
+		const _TickTime& entry = m_timemap[segment];
+		seconds[i] = entry.seconds + (ticks[i] - entry.tick) * entry.secondsPerTick;
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::setTempoTimeMap -- build the time map only from the tempo
+//    changes in the file instead of from every event tick.  The tracks
+//    are not joined to build it, and tick/second conversions are a
+//    binary search over the tempo changes.  Event seconds are only
+//    filled in by doTimeAnalysis() in this mode.
+//
+
+void MidiFile::setTempoTimeMap(bool state) {
+	// packed tracks have no events to build the full map from
+	state = state || isPacked();
+	if (m_tempotimemap != state) {
+		m_tempotimemap = state;
+		m_timemapvalid = 0;
+		m_timemap.clear();
+	}
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::hasTempoTimeMap -- true if the time map is built from the
+//    tempo changes only.
+//
+
+bool MidiFile::hasTempoTimeMap(void) const {
+	return m_tempotimemap;
+}
+
+
+
 ///////////////////////////////////////////////////////////////////////////
 //
 // note-analysis functions --
@@ -2281,6 +2845,9 @@ void MidiFile::clear(void) {
 	}
 	m_events.resize(1);
 	m_events[0] = new MidiEventList;
+	m_packeddata.clear();
+	m_packedtracks.clear();
+	m_trackdirectory.clear();
 	m_timemapvalid=0;
 	m_timemap.clear();
 	m_theTrackState = TRACK_STATE_SPLIT;
@@ -2682,6 +3249,10 @@ double MidiFile::linearSecondInterpolationAtTick(int ticktime) {
 //
 
 void MidiFile::buildTimeMap(void) {
+	if (m_tempotimemap) {
+		buildTempoTimeMap();
+		return;
+	}
 
 	// convert the MIDI file to absolute time representation
 	// in single track mode (and undo if the MIDI file was not
@@ -2748,6 +3319,104 @@ void MidiFile::buildTimeMap(void) {
 
 
 
+//////////////////////////////
+//
+// MidiFile::buildTempoTimeMap -- build a time map with one entry for
+//      each tempo change in the file (and one at tick 0 for the default
+//      120 beats per minute).  The tracks are only read, so the event
+//      lists stay as they are.
+//
+
+void MidiFile::buildTempoTimeMap(void) {
+	// the conductor track holds the tempo changes of a type-1 file, so
+	// make sure it is decoded even if no one asked for it
+	if (isPacked()) {
+		decodeTrack(0);
+	}
+	int tpq = getTicksPerQuarterNote();
+	double defaultTempo = 120.0;
+
+	// (tick, seconds per tick) for every tempo message, in file order
+	std::vector<std::pair<int, double>> tempos;
+	bool delta = isDeltaTicks();
+	for (int i=0; i<getTrackCount(); i++) {
+		MidiTrackView list = getTrackView(i);
+		int curtick = 0;
+		for (int j=0; j<list.size(); j++) {
+			MidiEventView event = list[j];
+			curtick = delta ? curtick + event.tick : event.tick;
+			if (event.isTempo()) {
+				tempos.emplace_back(curtick, event.getTempoSPT(tpq));
+			}
+		}
+	}
+	// stable so that the later of two same-tick tempos wins, like
+	// the joined track in buildTimeMap
+	std::stable_sort(tempos.begin(), tempos.end(),
+		[](const std::pair<int, double>& a, const std::pair<int, double>& b) {
+			return a.first < b.first;
+		});
+
+	m_timemap.clear();
+	m_timemap.reserve(tempos.size() + 1);
+
+	_TickTime value;
+	value.tick = 0;
+	value.seconds = 0.0;
+	value.secondsPerTick = 60.0 / (defaultTempo * tpq);
+	m_timemap.push_back(value);
+
+	for (int i=0; i<(int)tempos.size(); i++) {
+		_TickTime& last = m_timemap.back();
+		if (tempos[i].first == last.tick) {
+			last.secondsPerTick = tempos[i].second;
+			continue;
+		}
+		value.tick = tempos[i].first;
+		value.seconds = last.seconds + (value.tick - last.tick) * last.secondsPerTick;
+		value.secondsPerTick = tempos[i].second;
+		m_timemap.push_back(value);
+	}
+
+	m_timemapvalid = 1;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::tempoSegmentAtTick -- index of the tempo-only time map
+//      entry in effect at the given tick.
+//
+
+int MidiFile::tempoSegmentAtTick(int ticktime) const {
+	auto it = std::upper_bound(m_timemap.begin(), m_timemap.end(), ticktime,
+		[](int tick, const _TickTime& entry) { return tick < entry.tick; });
+	if (it == m_timemap.begin()) {
+		return 0;
+	}
+	return (int)(it - m_timemap.begin()) - 1;
+}
+
+
+
+//////////////////////////////
+//
+// MidiFile::tempoSegmentAtSecond -- index of the tempo-only time map
+//      entry in effect at the given time in seconds.
+//
+
+int MidiFile::tempoSegmentAtSecond(double seconds) const {
+	auto it = std::upper_bound(m_timemap.begin(), m_timemap.end(), seconds,
+		[](double sec, const _TickTime& entry) { return sec < entry.seconds; });
+	if (it == m_timemap.begin()) {
+		return 0;
+	}
+	return (int)(it - m_timemap.begin()) - 1;
+}
+
+
+
 //////////////////////////////
 //
 // MidiFile::extractMidiData -- Extract MIDI data from input
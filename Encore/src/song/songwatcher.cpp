@@ -0,0 +1,378 @@
+#include "song/songwatcher.h"
+#include "song/songlist.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#ifdef __linux__
+	#include <poll.h>
+	#include <sys/inotify.h>
+	#include <unistd.h>
+#endif
+
+namespace {
+	// the prefix every song folder listed in root starts with
+	std::string songDirPrefix(const std::filesystem::path& root) {
+		return (root / "").string();
+	}
+
+	// info.json, or the MIDI, which can change without info.json changing
+	bool songFile(const char* name) {
+		std::string_view file(name);
+		return file == "info.json" || file.ends_with(".mid") || file.ends_with(".midi");
+	}
+
+	bool inRoot(const std::string& songDir, const std::string& prefix) {
+		return songDir.size() > prefix.size() && songDir.compare(0, prefix.size(), prefix) == 0
+			&& songDir.find_first_of("/\\", prefix.size()) == std::string::npos;
+	}
+}
+
+void SongWatcher::Start(const std::vector<std::filesystem::path>& songsFolder, const std::vector<SongMetadata>& songs) {
+	Stop();
+	roots = songsFolder;
+	rootStamps.clear();
+	for (const auto& root : roots)
+		rootStamps.push_back(FileStamp::Of(root));
+	known.clear();
+	for (const SongMetadata& song : songs)
+		known[std::string(song.songDir)] = { song.jsonStamp, song.chartInfo.midiStamp };
+	dirtyRoots.clear();
+	touchedRoots.clear();
+	dirtySongs.clear();
+	{
+		std::lock_guard<std::mutex> lock(updateMutex);
+		pending = SongListUpdate();
+	}
+	running = true;
+	thread = std::thread(&SongWatcher::run, this);
+}
+
+void SongWatcher::Stop() {
+	running = false;
+	if (thread.joinable())
+		thread.join();
+}
+
+bool SongWatcher::TakeUpdate(SongListUpdate& update) {
+	std::unique_lock<std::mutex> lock(updateMutex, std::try_to_lock);
+	if (!lock.owns_lock() || pending.empty())
+		return false;
+	update = std::move(pending);
+	pending = SongListUpdate();
+	return true;
+}
+
+void SongWatcher::run() {
+	// folders without an info.json yet aren't in the list, but need watching
+	// for when one shows up
+	for (const auto& root : roots) {
+		std::error_code error;
+		for (const auto& entry : std::filesystem::directory_iterator(root, error)) {
+			if (entry.is_directory(error) && !known.count(entry.path().string()))
+				known[entry.path().string()] = SongStamps();
+		}
+	}
+	pollRoots = true;
+	pollSongs = true;
+	if (openNotify()) {
+		pollRoots = false;
+		pollSongs = false;
+		for (const auto& root : roots)
+			watchRoot(root);
+		for (const auto& [songDir, stamp] : known)
+			watchSong(songDir);
+		if (pollSongs)
+			TraceLog(LOG_WARNING, "Out of folder watches, polling songs for changes");
+	}
+
+	using clock = std::chrono::steady_clock;
+	clock::time_point lastPoll = clock::now();
+	clock::time_point firstChange;
+	clock::time_point lastChange;
+	bool waiting = false;
+	int polls = 0;
+	while (running) {
+		bool changed = readNotify(std::chrono::milliseconds(250));
+		clock::time_point now = clock::now();
+		if ((pollRoots || pollSongs) && now - lastPoll >= pollInterval) {
+			size_t dirtyBefore = dirtyRoots.size() + dirtySongs.size();
+			pollStamps(pollSongs && ++polls % songPollEvery == 0);
+			changed |= dirtyRoots.size() + dirtySongs.size() != dirtyBefore;
+			lastPoll = now;
+		}
+		if (changed) {
+			if (!waiting)
+				firstChange = now;
+			lastChange = now;
+			waiting = true;
+		}
+		if (waiting && (now - lastChange >= settleTime || now - firstChange >= maxDelay)) {
+			process();
+			waiting = false;
+		}
+	}
+	closeNotify();
+}
+
+bool SongWatcher::openNotify() {
+#ifdef __linux__
+	notifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	return notifyFd >= 0;
+#else
+	return false;
+#endif
+}
+
+void SongWatcher::closeNotify() {
+#ifdef __linux__
+	if (notifyFd >= 0)
+		close(notifyFd);
+#endif
+	notifyFd = -1;
+	watchDirs.clear();
+	dirWatches.clear();
+	rootWatches.clear();
+}
+
+void SongWatcher::watchRoot(const std::filesystem::path& root) {
+#ifdef __linux__
+	int wd = inotify_add_watch(notifyFd, root.c_str(), IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO
+							   | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR);
+	if (wd < 0) {
+		pollRoots = true;
+		return;
+	}
+	watchDirs[wd] = root;
+	rootWatches.insert(wd);
+#endif
+}
+
+void SongWatcher::watchSong(const std::filesystem::path& songDir) {
+#ifdef __linux__
+	if (notifyFd < 0 || dirWatches.count(songDir.string()))
+		return;
+	int wd = inotify_add_watch(notifyFd, songDir.c_str(), IN_CLOSE_WRITE | IN_CREATE | IN_DELETE
+							   | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR);
+	if (wd < 0) {
+		if (errno == ENOSPC)
+			pollSongs = true;
+		return;
+	}
+	// a folder renamed from one already watched comes back with the same
+	// watch, which now belongs to the new name only
+	auto previous = watchDirs.find(wd);
+	if (previous != watchDirs.end() && previous->second != songDir)
+		dirWatches.erase(previous->second.string());
+	watchDirs[wd] = songDir;
+	dirWatches[songDir.string()] = wd;
+#endif
+}
+
+void SongWatcher::unwatchSong(const std::filesystem::path& songDir) {
+#ifdef __linux__
+	auto it = dirWatches.find(songDir.string());
+	if (it == dirWatches.end())
+		return;
+	// only if the watch is still this folder's, and hasn't gone to the
+	// name it was renamed to
+	auto watch = watchDirs.find(it->second);
+	if (watch != watchDirs.end() && watch->second == songDir) {
+		inotify_rm_watch(notifyFd, it->second);
+		watchDirs.erase(watch);
+	}
+	dirWatches.erase(it);
+#endif
+}
+
+bool SongWatcher::readNotify(std::chrono::milliseconds timeout) {
+#ifdef __linux__
+	if (notifyFd >= 0) {
+		pollfd fd{ notifyFd, POLLIN, 0 };
+		if (poll(&fd, 1, (int)timeout.count()) <= 0)
+			return false;
+		bool changed = false;
+		alignas(inotify_event) char buffer[16384];
+		while (true) {
+			ssize_t length = read(notifyFd, buffer, sizeof(buffer));
+			if (length <= 0)
+				break;
+			for (char* next = buffer; next < buffer + length;) {
+				const inotify_event* event = reinterpret_cast<const inotify_event*>(next);
+				next += sizeof(inotify_event) + event->len;
+				if (event->mask & IN_Q_OVERFLOW) {
+					// events were dropped, so look at everything
+					dirtyRoots.insert(roots.begin(), roots.end());
+					for (const auto& [songDir, stamp] : known)
+						dirtySongs.insert(songDir);
+					changed = true;
+					continue;
+				}
+				auto watch = watchDirs.find(event->wd);
+				if (watch == watchDirs.end())
+					continue;
+				std::filesystem::path dir = watch->second;
+				bool root = rootWatches.count(event->wd) > 0;
+				if (event->mask & IN_IGNORED) {
+					watchDirs.erase(watch);
+					if (root) {
+						rootWatches.erase(event->wd);
+						pollRoots = true;
+					} else {
+						dirWatches.erase(dir.string());
+						dirtySongs.insert(dir);
+					}
+					changed = true;
+				} else if (root) {
+					if (event->len > 0 && (event->mask & IN_ISDIR)) {
+						dirtySongs.insert(dir / event->name);
+						touchedRoots.insert(dir);
+					} else {
+						dirtyRoots.insert(dir);
+					}
+					changed = true;
+				} else if (event->len > 0 && songFile(event->name)) {
+					dirtySongs.insert(dir);
+					changed = true;
+				}
+			}
+		}
+		return changed;
+	}
+#endif
+	std::this_thread::sleep_for(timeout);
+	return false;
+}
+
+void SongWatcher::pollStamps(bool songsToo) {
+	if (pollRoots) {
+		for (int i = 0; i < roots.size(); i++) {
+			if (FileStamp::Of(roots[i]) != rootStamps[i])
+				dirtyRoots.insert(roots[i]);
+		}
+	}
+	if (songsToo) {
+		for (const auto& [songDir, stamps] : known) {
+			if (FileStamp::Of(std::filesystem::path(songDir) / "info.json") != stamps.json)
+				dirtySongs.insert(songDir);
+		}
+	}
+}
+
+void SongWatcher::process() {
+	std::vector<std::filesystem::path> restampedRoots;
+	std::vector<FileStamp> restamps;
+	for (int i = 0; i < roots.size(); i++) {
+		bool dirty = dirtyRoots.count(roots[i]) > 0;
+		if (!dirty && !touchedRoots.count(roots[i]))
+			continue;
+		// stamp before listing, so a song added while listing shows up next time
+		rootStamps[i] = FileStamp::Of(roots[i]);
+		restampedRoots.push_back(roots[i]);
+		restamps.push_back(rootStamps[i]);
+		if (!dirty)
+			continue;
+		std::error_code error;
+		if (std::filesystem::is_directory(roots[i], error)) {
+			for (const auto& entry : std::filesystem::directory_iterator(roots[i], error)) {
+				if (entry.is_directory(error) && !known.count(entry.path().string()))
+					dirtySongs.insert(entry.path());
+			}
+		}
+		std::string prefix = songDirPrefix(roots[i]);
+		for (const auto& [songDir, stamp] : known) {
+			if (inRoot(songDir, prefix) && !std::filesystem::exists(songDir, error))
+				dirtySongs.insert(songDir);
+		}
+	}
+	dirtyRoots.clear();
+	touchedRoots.clear();
+
+	SongListUpdate update;
+	// each update's text is its own, and goes once the list has taken it
+	update.strings = std::make_shared<SongStrings>();
+	for (const auto& songDir : dirtySongs) {
+		if (!running)
+			return;
+		std::string dir = songDir.string();
+		FileStamp stamp = FileStamp::Of(songDir / "info.json");
+		auto it = known.find(dir);
+		if (!stamp.valid()) {
+			// an empty stamp is a folder waiting for its info.json
+			if (it != known.end() && it->second.json.valid())
+				update.removedSongDirs.push_back(dir);
+			std::error_code error;
+			if (std::filesystem::is_directory(songDir, error)) {
+				known[dir] = SongStamps();
+				watchSong(songDir);
+			} else {
+				known.erase(dir);
+				unwatchSong(songDir);
+			}
+			continue;
+		}
+		SongMetadata song;
+		song.LoadSong(songDir / "info.json", *update.strings);
+		// the MIDI's path is in info.json, so it's only known after loading
+		FileStamp midiStamp = FileStamp::Of(std::filesystem::path(song.midiPath));
+		if (it != known.end() && it->second.json == stamp && it->second.midi == midiStamp)
+			continue;
+		song.LoadChartInfo();
+		known[dir] = { song.jsonStamp, song.chartInfo.midiStamp };
+		watchSong(songDir);
+		update.changedSongs.push_back(std::move(song));
+	}
+	dirtySongs.clear();
+
+	if (update.empty() && restampedRoots.empty())
+		return;
+	// roots still holding folders waiting for their info.json are journaled
+	// unstamped, so the next load lists them again
+	for (int i = 0; i < restampedRoots.size(); i++) {
+		std::string prefix = songDirPrefix(restampedRoots[i]);
+		int waiting = 0;
+		for (const auto& [songDir, stamps] : known) {
+			if (inRoot(songDir, prefix) && !stamps.json.valid())
+				waiting++;
+		}
+		restamps[i] = SongList::CachedFolderStamp(restamps[i], waiting);
+	}
+	std::vector<const SongMetadata*> changedSongs;
+	for (const SongMetadata& song : update.changedSongs)
+		changedSongs.push_back(&song);
+	SongList::JournalChanges(changedSongs, update.removedSongDirs, restampedRoots, restamps);
+	if (!update.empty()) {
+		// not TextFormat, whose buffers the main thread shares
+		char message[128];
+		snprintf(message, sizeof(message), "Song folders changed: %01i songs updated, %01i removed",
+				 (int)update.changedSongs.size(), (int)update.removedSongDirs.size());
+		TraceLog(LOG_INFO, "%s", message);
+		publish(update);
+	}
+}
+
+void SongWatcher::publish(SongListUpdate& update) {
+	std::lock_guard<std::mutex> lock(updateMutex);
+	// songs still waiting from an earlier update move into this one's text,
+	// so there's only the one arena to keep
+	if (pending.strings != update.strings) {
+		for (SongMetadata& song : pending.changedSongs)
+			song.InternInto(*update.strings);
+		pending.strings = update.strings;
+	}
+	for (const std::string& songDir : update.removedSongDirs) {
+		std::erase_if(pending.changedSongs, [&songDir](const SongMetadata& song) { return song.songDir == songDir; });
+		if (std::find(pending.removedSongDirs.begin(), pending.removedSongDirs.end(), songDir) == pending.removedSongDirs.end())
+			pending.removedSongDirs.push_back(songDir);
+	}
+	for (SongMetadata& song : update.changedSongs) {
+		std::erase(pending.removedSongDirs, song.songDir);
+		auto it = std::find_if(pending.changedSongs.begin(), pending.changedSongs.end(),
+							   [&song](const SongMetadata& other) { return other.songDir == song.songDir; });
+		if (it != pending.changedSongs.end())
+			*it = std::move(song);
+		else
+			pending.changedSongs.push_back(std::move(song));
+	}
+}